@@ -17,6 +17,18 @@ MCULFLAGS=-nostartfiles -Wl,-static -Bfirmware -Wl,-u,VectorTable -Wl,-T -Xlinke
 MCUPREPARE=$(OBJCOPY) $(OUT) -O binary $(BINDIR)/$(OUTBIN)
 # Advanced sizing flags
 SIZEFLAGS=
+# Memory sizes from firmware/STM32F10x.ld for the memory budget report
+RAMSIZE=65536
+FLASHSIZE=393216
+# Build profile: size builds everything with -Os, speed builds HOTMODULES with -O2 and the
+# rest with -Os, lto is speed plus link-time optimization. Run make clean after changing it.
+PROFILE?=speed
+PROFILES=size speed lto
+# Modules on the control loop path, built for speed outside the size profile
+HOTMODULES=containers fixed lift motors odometry opcontrol path pid power profile sensors \
+	tasks telemetry
+# Heap functions robot code must not call, checked before linking
+HEAPSYMBOLS=malloc|calloc|realloc|free|_malloc_r|_calloc_r|_realloc_r|_free_r|_Znwj|_Znaj
 # Uploads program using java
 UPLOAD=@java -jar firmware/uniflash.jar vex $(BINDIR)/$(OUTBIN)
 
@@ -32,14 +44,31 @@ OUTNAME=output.elf
 # Flags for programs
 AFLAGS:=$(MCUAFLAGS)
 ARFLAGS:=$(MCUCFLAGS)
-CCFLAGS:=-c -Wall $(MCUCFLAGS) -Os -ffunction-sections -fsigned-char -fomit-frame-pointer -fsingle-precision-constant
+CCFLAGS:=-c -Wall $(MCUCFLAGS) -ffunction-sections -fsigned-char -fomit-frame-pointer -fsingle-precision-constant
 CFLAGS:=$(CCFLAGS) -std=gnu99 -Werror=implicit-function-declaration
 CPPFLAGS:=$(CCFLAGS) -fno-exceptions -fno-rtti -felide-constructors
 LDFLAGS:=-Wall $(MCUCFLAGS) $(MCULFLAGS) -Wl,--gc-sections
 
+# Optimization for each profile; optflags gives the flags for one module
+ifeq ($(PROFILE),size)
+SPEEDMODULES:=
+else
+SPEEDMODULES:=$(HOTMODULES)
+endif
+# The LTO link gives no -O level of its own: each function keeps the one its module was
+# compiled with, so the speed modules are not rebuilt for size at the link
+ifeq ($(PROFILE),lto)
+LTOFLAGS:=-flto -ffat-lto-objects
+LDFLAGS+=-flto
+endif
+optflags=$(if $(filter $(1),$(SPEEDMODULES)),-O2,-Os) $(LTOFLAGS)
+
 # Tools used in program
 AR:=$(MCUPREFIX)ar
 AS:=$(MCUPREFIX)as
+NM:=$(MCUPREFIX)gcc-nm
 CC:=$(MCUPREFIX)gcc
 CPPCC:=$(MCUPREFIX)g++
 OBJCOPY:=$(MCUPREFIX)objcopy
+# Compiler for tools that run on the development machine
+HOSTCC?=cc
@@ -0,0 +1,78 @@
+/** @file approach.h
+ * @brief Ultrasonic approach to a game object
+ *
+ * Drives toward whatever the range sensors see until it is a set distance in front of the robot,
+ * slowing in proportion to the distance left so the robot does not bump the object away. With
+ * both sensors seeing it, the difference between them turns the robot square to the object on
+ * the way in. It runs as a command (command.h), so autonomous code can wait for it or do other
+ * work alongside.
+ */
+
+#ifndef APPROACH_H_
+#define APPROACH_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Drive command per centimeter of distance left
+ */
+#define APPROACH_KP FIXED(2.0)
+/**
+ * Drive command per centimeter of difference between the sensors
+ */
+#define APPROACH_TURN_KP FIXED(3.0)
+/**
+ * Fastest and slowest drive commands; below the slowest the drive stalls
+ */
+#define APPROACH_MAX_SPEED 80
+#define APPROACH_MIN_SPEED 20
+/**
+ * Largest distance error and sensor difference, in centimeters, counted as there
+ */
+#define APPROACH_TOLERANCE 2
+/**
+ * Time the robot must stay within tolerance to finish, in milliseconds
+ */
+#define APPROACH_SETTLE_TIME 150
+/**
+ * Time without a reading from either sensor before the approach gives up, in milliseconds
+ */
+#define APPROACH_LOST_TIME 500
+
+/**
+ * One approach; the command member must come first
+ */
+typedef struct {
+	Command command;
+	//Distance to stop at in centimeters
+	int distance;
+	//Time limit in milliseconds from the start, 0 for none
+	unsigned long timeout;
+	unsigned long startTime;
+	unsigned long lastSeen;
+	unsigned long settledSince;
+	//Set when the approach ends within tolerance
+	bool reached;
+} Approach;
+
+/**
+ * approachInit()
+ * Prepares an approach for commandSchedule().
+ *
+ * @param approach the approach, which must stay valid while it runs
+ * @param distance the distance to stop at in centimeters
+ * @param timeout the time limit in milliseconds, 0 for none
+ */
+void approachInit(Approach *approach, int distance, unsigned long timeout);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+/** @file arena.h
+ * @brief Static memory arena for buffers sized at startup
+ *
+ * Robot code never uses malloc(): the link fails if any module refers to it (see the Makefile).
+ * Buffers whose size is chosen at startup come from this arena instead, a fixed block of RAM
+ * handed out front to back and never freed. initialize() locks the arena once every module has
+ * set up, so nothing can allocate mid-match; allocations after that fail and are counted.
+ *
+ * The containers in containers.h take their storage from the arena and register here, so
+ * arenaReport() shows how full each one has ever been.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Arena size in bytes
+ */
+#define ARENA_BYTES 4096
+/**
+ * Most containers tracked for the report
+ */
+#define ARENA_TRACKED 16
+
+/**
+ * arenaAlloc()
+ * Takes a block from the arena, aligned for any type. Only call during initialize().
+ *
+ * @param bytes the block size
+ * @return the zeroed block, or NULL if the arena is full or locked
+ */
+void *arenaAlloc(unsigned int bytes);
+
+/**
+ * arenaLock()
+ * Refuses every later allocation. Called at the end of initialize().
+ */
+void arenaLock();
+
+/**
+ * arenaTrack()
+ * Adds a container to the report.
+ *
+ * @param name the container name; the pointer must stay valid
+ * @param capacity the most items it holds
+ * @param peak the most items it has held, kept up to date by the container
+ */
+void arenaTrack(const char *name, unsigned int capacity, const volatile unsigned int *peak);
+
+/**
+ * arenaReport()
+ * Writes the arena use, failed allocations and each container's high-water mark as one JSON
+ * object.
+ *
+ * @param stream the stream to write to, such as stdout
+ */
+void arenaReport(FILE *stream);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/** @file autotune.h
+ * @brief On-robot tuning of the lift and drive gains
+ *
+ * The lift is tuned by relay feedback: the lift motors switch between two commands around a
+ * height so the lift oscillates, and the oscillation's amplitude and period give PID gains by
+ * the Ziegler-Nichols rules. The command the relay settles around is the gravity feedforward.
+ *
+ * The drive is tuned by two open-loop steps, forward at a low command then back at a high one,
+ * whose steady speeds give the static friction and velocity feedforward gains. It needs about
+ * three feet of clear floor in front of the robot.
+ *
+ * Both run in the calling task until done and save the new gains to flash. Moving a joystick
+ * stick aborts them and keeps the old gains.
+ */
+
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * autotuneLift()
+ * Tunes the lift PID and gravity feedforward about 150 ticks above the current height.
+ *
+ * @return true if new gains were found and saved
+ */
+bool autotuneLift();
+
+/**
+ * autotuneDrive()
+ * Tunes the drive static friction and velocity feedforward.
+ *
+ * @return true if new gains were found and saved
+ */
+bool autotuneDrive();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+/** @file calibration.h
+ * @brief Robot calibration, stored in flash
+ *
+ * Every tuned value lives in one record: the controller gains, the joystick deadzone, the
+ * autonomous drive power, the motor port map, the gyro scale, the joystick mapping, the lift
+ * synchronization and the brownout thresholds. It is loaded once in initialize() and read
+ * through the calibration pointer, so code cannot change it by accident.
+ *
+ * Values are changed through the field table, from the LCD editor or the serial console, or by
+ * the auto-tuner (autotune.h). calibrationSave() writes the record to flash with a version and
+ * a CRC, so new values survive a power cycle without a rebuild. A damaged record is ignored and
+ * the defaults are used.
+ */
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Name of the calibration file in the PROS flash file system
+ */
+#define CALIBRATION_FILE "calib"
+/**
+ * Record layout version. Fields are only ever appended, so an older record still loads and the
+ * fields it lacks keep their defaults. A record from newer code is ignored.
+ */
+#define CALIBRATION_VERSION 5
+
+/**
+ * Gains for every tuned controller
+ */
+typedef struct {
+	//Lift position PID, in command per tick, per tick-second and per tick-per-second
+	Fixed liftKp;
+	Fixed liftKi;
+	Fixed liftKd;
+	//Command that holds the lift against gravity
+	Fixed liftKg;
+	//Drive feedforward: command to overcome static friction, and command per inch per second
+	Fixed driveKs;
+	Fixed driveKv;
+} Gains;
+
+/**
+ * Every tuned value on the robot
+ */
+typedef struct {
+	Gains gains;
+	//Joystick travel ignored around center
+	int deadzone;
+	//Drive command used by the autonomous move() and turn()
+	int drivePower;
+	//Cortex port driven for each motor, indexed by the motor constant minus one
+	unsigned char ports[MOTOR_PORTS];
+	//Gyro counts from analogReadCalibratedHR() per degree per second, negative if mounted
+	//upside down; since version 2
+	Fixed gyroScale;
+	//Joystick driving each mechanism, indexed by DriverMechanism: 1, 2 or DRIVER_EITHER;
+	//since version 3
+	int joysticks[DRIVER_MECHANISMS];
+	//Sensor on the right side of the lift (LiftSensor), the potentiometer's lift ticks per
+	//count, and the command per tick of twist between the sides; since version 4
+	int liftSensor;
+	Fixed liftPotScale;
+	Fixed liftSyncKp;
+	//Predicted battery millivolts below which the claw, lift and drive stages are shed, and the
+	//horizon in milliseconds the voltage is predicted over (power.h); since version 5
+	int brownoutClaw;
+	int brownoutLift;
+	int brownoutDrive;
+	int brownoutHorizon;
+} Calibration;
+
+/**
+ * The calibration in use
+ */
+extern const Calibration *const calibration;
+
+/**
+ * calibrationLoad()
+ * Loads the calibration from flash, keeping the defaults if none was saved or it is damaged.
+ * Call from initialize().
+ */
+void calibrationLoad();
+
+/**
+ * calibrationSave()
+ * Writes the calibration in use to flash.
+ *
+ * @return true if the record was written, false if it could not be or would not load, such as
+ * with two motors on one port
+ */
+bool calibrationSave();
+
+/**
+ * calibrationSetGains()
+ * Replaces the gains in use. Controllers pick them up the next time they start.
+ *
+ * @param gains the new gains
+ */
+void calibrationSetGains(const Gains *gains);
+
+/**
+ * calibrationFieldCount()
+ * @return the number of editable fields
+ */
+unsigned int calibrationFieldCount();
+
+/**
+ * calibrationFieldFind()
+ * @param name the field name, as printed by calibrationPrint()
+ * @return the field index, or -1 if there is no such field
+ */
+int calibrationFieldFind(const char *name);
+
+/**
+ * calibrationFieldSet()
+ * Changes a field from text, in the units calibrationPrint() shows. Values are limited to the
+ * field's range.
+ *
+ * @param index the field index
+ * @param text a decimal number; gains take up to four decimal places
+ * @return true if the text was a number
+ */
+bool calibrationFieldSet(unsigned int index, const char *text);
+
+/**
+ * calibrationPrint()
+ * Writes every field as one "name value" line.
+ *
+ * @param stream the stream to write to, such as stdout
+ */
+void calibrationPrint(FILE *stream);
+
+/**
+ * calibrationLcdEdit()
+ * Runs the LCD editor for one display period. The center button opens it and steps through the
+ * fields, left and right change the value shown. It closes after the last field or ten idle
+ * seconds, saving any change.
+ *
+ * @param lcdPort the port the LCD is on
+ * @return true while the editor is using the LCD
+ */
+bool calibrationLcdEdit(FILE *lcdPort);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
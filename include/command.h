@@ -0,0 +1,131 @@
+/** @file command.h
+ * @brief Non-blocking command scheduler
+ *
+ * A command is a small state machine run by the control task: it is started once, updated every
+ * control tick until it reports that it is done, and ended, either because it finished or
+ * because it was interrupted. Any task may schedule or cancel a command; the change takes
+ * effect at the next control tick, so a command never runs in two tasks at once.
+ *
+ * Each command names the mechanisms it drives. Scheduling a command interrupts every running
+ * command that shares one of them, so two commands never fight over a motor.
+ *
+ * Commands are not copied. A scheduled command must stay valid until it is done, so they should
+ * be static, not on the stack of a task the kernel may stop.
+ */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Mechanisms a command can require
+ */
+#define COMMAND_DRIVE 0x01
+#define COMMAND_LIFT 0x02
+#define COMMAND_CLAW 0x04
+/**
+ * Most commands running or waiting to start at once
+ */
+#define COMMAND_SLOTS 8
+
+/**
+ * Command states
+ */
+typedef enum {
+	COMMAND_IDLE,
+	COMMAND_PENDING,
+	COMMAND_RUNNING,
+	COMMAND_FINISHED,
+	COMMAND_INTERRUPTED
+} CommandState;
+
+typedef struct Command Command;
+
+/**
+ * A schedulable command. Embed it as the first member of a larger struct to give the command
+ * its own state.
+ */
+struct Command {
+	//Shown by the shell
+	const char *name;
+	//COMMAND_DRIVE, COMMAND_LIFT and COMMAND_CLAW bits
+	unsigned char requires;
+	//Called once before the first update; may be NULL
+	void (*start)(Command *command);
+	//Called every control tick; returns true when the command is done
+	bool (*update)(Command *command);
+	//Called once after the last update; may be NULL
+	void (*end)(Command *command, bool interrupted);
+	//Managed by the scheduler
+	volatile CommandState state;
+	volatile bool cancelRequested;
+};
+
+/**
+ * commandInit()
+ * Sets up the scheduler. Call once from initialize() before the tasks start.
+ */
+void commandInit();
+
+/**
+ * commandSchedule()
+ * Starts a command at the next control tick, interrupting the commands that share a mechanism
+ * with it. Scheduling a command that is already pending or running does nothing.
+ *
+ * @param command the command to run
+ * @return false if every slot is taken
+ */
+bool commandSchedule(Command *command);
+
+/**
+ * commandCancel()
+ * Interrupts a command at the next control tick.
+ *
+ * @param command the command to stop
+ */
+void commandCancel(Command *command);
+
+/**
+ * commandCancelAll()
+ * Interrupts every command at the next control tick.
+ */
+void commandCancelAll();
+
+/**
+ * commandDone()
+ * @return true once a command has finished or been interrupted, or if it was never scheduled
+ */
+bool commandDone(const Command *command);
+
+/**
+ * commandRequired()
+ * @return the mechanisms required by every pending or running command
+ */
+unsigned char commandRequired();
+
+/**
+ * commandUpdate()
+ * Starts, updates and ends commands for one control tick. Run by the control task.
+ */
+void commandUpdate();
+
+/**
+ * commandReport()
+ * Writes the running commands as JSON.
+ *
+ * @param stream the stream to write to, such as stdout
+ */
+void commandReport(FILE *stream);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+/** @file containers.h
+ * @brief Fixed-capacity containers with storage from the arena
+ *
+ * Each container is given its item size and capacity when it is set up during initialize(),
+ * takes its storage from the arena (arena.h) and never grows. Items are copied in and out.
+ *
+ * A Ring is a first-in first-out queue safe between one producer and one consumer without a
+ * mutex. A Seqlock holds the latest value of some state written by one producer and read by any
+ * number of readers without a mutex. Either side of both may be a task or an interrupt handler
+ * (ioSetInterrupt()), as neither ever blocks. A SmallVector is an array that keeps its items in
+ * order. A Pool hands out fixed-size blocks that are returned when done with. SmallVector and
+ * Pool are not safe to share between tasks.
+ */
+
+#ifndef CONTAINERS_H_
+#define CONTAINERS_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A first-in first-out queue for one producer and one consumer
+ */
+typedef struct {
+	unsigned char *data;
+	unsigned int size;
+	//A power of two, so the free-running indexes wrap cleanly
+	unsigned int capacity;
+	//Only the producer writes head and only the consumer writes tail
+	volatile unsigned int head;
+	volatile unsigned int tail;
+	volatile unsigned int peak;
+} Ring;
+
+/**
+ * The latest value of some state, for one writer and any number of readers
+ */
+typedef struct {
+	//Two copies: the writer fills the one readers are not being sent to, then switches
+	unsigned char *data;
+	unsigned int size;
+	//Completed writes; the low bit picks the copy to read
+	volatile unsigned int sequence;
+	//Reads that had to start over because a write finished during them
+	volatile unsigned int retries;
+} Seqlock;
+
+/**
+ * An array that keeps its items in order
+ */
+typedef struct {
+	unsigned char *data;
+	unsigned int size;
+	unsigned int capacity;
+	unsigned int count;
+	volatile unsigned int peak;
+} SmallVector;
+
+/**
+ * A set of equal-size blocks
+ */
+typedef struct {
+	unsigned char *data;
+	unsigned int size;
+	unsigned int capacity;
+	//Free blocks are linked through their first word
+	void *free;
+	unsigned int used;
+	volatile unsigned int peak;
+} Pool;
+
+/**
+ * ringInit()
+ * Sets up an empty queue. Only call during initialize().
+ *
+ * @param ring the queue
+ * @param name the name shown in arenaReport()
+ * @param size the item size in bytes
+ * @param capacity the most items held, a power of two
+ * @return true if the storage was allocated
+ */
+bool ringInit(Ring *ring, const char *name, unsigned int size, unsigned int capacity);
+
+/**
+ * ringPush()
+ * Copies an item onto the back of the queue. Only the producer task calls this.
+ *
+ * @return false if the queue is full
+ */
+bool ringPush(Ring *ring, const void *item);
+
+/**
+ * ringPop()
+ * Copies the item at the front of the queue out and removes it. Only the consumer task calls
+ * this.
+ *
+ * @return false if the queue is empty
+ */
+bool ringPop(Ring *ring, void *item);
+
+/**
+ * ringCount()
+ * @return the number of items queued
+ */
+unsigned int ringCount(const Ring *ring);
+
+/**
+ * seqlockInit()
+ * Sets up a cell holding zeros. Only call during initialize().
+ *
+ * @param lock the cell
+ * @param size the value size in bytes
+ * @return true if the storage was allocated
+ */
+bool seqlockInit(Seqlock *lock, unsigned int size);
+
+/**
+ * seqlockWrite()
+ * Replaces the value. Only the writer calls this.
+ */
+void seqlockWrite(Seqlock *lock, const void *value);
+
+/**
+ * seqlockRead()
+ * Copies the value out. A higher-priority reader never waits for a preempted writer, as it
+ * reads the copy the writer is not filling; a read only starts over when a write finishes
+ * during it.
+ */
+void seqlockRead(Seqlock *lock, void *value);
+
+/**
+ * vectorInit()
+ * Sets up an empty vector. Only call during initialize().
+ *
+ * @param vector the vector
+ * @param name the name shown in arenaReport()
+ * @param size the item size in bytes
+ * @param capacity the most items held
+ * @return true if the storage was allocated
+ */
+bool vectorInit(SmallVector *vector, const char *name, unsigned int size,
+	unsigned int capacity);
+
+/**
+ * vectorPush()
+ * Copies an item onto the end.
+ *
+ * @return false if the vector is full
+ */
+bool vectorPush(SmallVector *vector, const void *item);
+
+/**
+ * vectorAt()
+ * @return the item at an index, or NULL past the end
+ */
+void *vectorAt(const SmallVector *vector, unsigned int index);
+
+/**
+ * vectorRemove()
+ * Removes the item at an index, moving the later items down.
+ */
+void vectorRemove(SmallVector *vector, unsigned int index);
+
+/**
+ * vectorClear()
+ * Removes every item.
+ */
+void vectorClear(SmallVector *vector);
+
+/**
+ * poolInit()
+ * Sets up a pool with every block free. Only call during initialize().
+ *
+ * @param pool the pool
+ * @param name the name shown in arenaReport()
+ * @param size the block size in bytes
+ * @param capacity the number of blocks
+ * @return true if the storage was allocated
+ */
+bool poolInit(Pool *pool, const char *name, unsigned int size, unsigned int capacity);
+
+/**
+ * poolAlloc()
+ * @return a free block, or NULL if every block is in use
+ */
+void *poolAlloc(Pool *pool);
+
+/**
+ * poolFree()
+ * Returns a block to the pool.
+ *
+ * @param block a block from poolAlloc() on the same pool, or NULL
+ */
+void poolFree(Pool *pool, void *block);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
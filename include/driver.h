@@ -0,0 +1,120 @@
+/** @file driver.h
+ * @brief Inputs and per-tick step of operator control
+ *
+ * operatorControl() samples everything the driver code reads into a DriverInput, then runs
+ * driverStep() on it. driverStep() reads nothing else and only writes the motor frame, so the
+ * same input stream always produces the same frames; replay.h relies on this.
+ *
+ * Both joysticks are always sampled, connected or not, so sampling costs the same whichever
+ * are plugged in. The calibration maps each mechanism to joystick 1, joystick 2 or either.
+ * A mechanism mapped to one joystick falls back to the other while it is disconnected. One
+ * mapped to either follows the joystick the driver moves, joystick 1 first if both do. When
+ * a mechanism changes hands through a disconnect or reconnect, the new joystick's input is
+ * ignored until it has been centered, so a stick held over does not jerk the robot.
+ */
+
+#ifndef DRIVER_H_
+#define DRIVER_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Joysticks sampled
+ */
+#define DRIVER_JOYSTICKS 2
+/**
+ * Joystick mapping value for a mechanism either joystick may drive
+ */
+#define DRIVER_EITHER 0
+
+/**
+ * Mechanisms with a joystick mapping
+ */
+typedef enum {
+	DRIVER_DRIVE,
+	DRIVER_LIFT,
+	DRIVER_CLAW,
+	DRIVER_MECHANISMS
+} DriverMechanism;
+
+/**
+ * Everything the driver code reads in one loop iteration
+ */
+typedef struct {
+	//millis() when the inputs were sampled
+	unsigned long time;
+	//Axes 1-4 of joysticks 1 and 2, zero when disconnected
+	int analog[DRIVER_JOYSTICKS][4];
+	//Button groups 5-8 of joysticks 1 and 2 as JOY_* bitmasks
+	unsigned char buttons[DRIVER_JOYSTICKS][4];
+	//Bit 0 set while joystick 1 is connected, bit 1 for joystick 2
+	unsigned char connected;
+	//Encoder counts
+	int leftTicks;
+	int rightTicks;
+	int liftTicks;
+	//Left side of the lift less the right side, in ticks
+	int liftTwist;
+	//Main battery in millivolts
+	unsigned int battery;
+	//Mechanisms held by commands such as macros (commandRequired()), left alone by driverStep()
+	unsigned char held;
+} DriverInput;
+
+/**
+ * Tests whether a button of joystick 1 or 2 was held in a sampled input
+ */
+#define driverJoystickButton(input, joystick, group, button) \
+	(((input)->buttons[(joystick) - 1][(group) - 5] & (button)) != 0)
+/**
+ * Tests whether a button of joystick 1 was held in a sampled input
+ */
+#define driverButton(input, group, button) driverJoystickButton(input, 1, group, button)
+
+/**
+ * driverInputSample()
+ * Reads both joysticks, the encoders, the battery and the mechanisms held by commands into an
+ * input record.
+ *
+ * @param input the record to fill
+ */
+void driverInputSample(DriverInput *input);
+
+/**
+ * driverMoving()
+ * Tests whether the driver is moving a set of mechanisms on the joysticks the calibration maps
+ * them to. Call from the operator control task only.
+ *
+ * @param input the inputs sampled for this iteration
+ * @param mechanisms a bit for each DriverMechanism
+ * @return true if a control of one of the mechanisms is off center
+ */
+bool driverMoving(const DriverInput *input, unsigned int mechanisms);
+
+/**
+ * driverReset()
+ * Clears the state driverStep() keeps between iterations.
+ *
+ * @param input the first input of the run
+ */
+void driverReset(const DriverInput *input);
+
+/**
+ * driverStep()
+ * Runs one iteration of the drive, lift and claw control, writing the motor frame.
+ *
+ * @param input the inputs sampled for this iteration
+ */
+void driverStep(const DriverInput *input);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/** @file events.h
+ * @brief Hardware events from interrupt handlers
+ *
+ * Switches that must not be missed between samples raise an interrupt. The handler only stamps
+ * the time and queues an event; the control task takes the events off the queue at the start
+ * of each tick and passes them to the code that reacts to them. The queue is a Ring, so the
+ * handler never waits on a task.
+ */
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Digital port of the switch pressed when the lift is all the way down, unused while a right
+ * lift encoder has the port (lift.h)
+ */
+#define EVENTS_LIFT_LIMIT_PORT 11
+/**
+ * Most events waiting for the control task
+ */
+#define EVENTS_QUEUE 8
+
+/**
+ * Kinds of event
+ */
+typedef enum {
+	EVENT_LIFT_LIMIT
+} EventType;
+
+/**
+ * One event
+ */
+typedef struct {
+	//millis() when the handler ran
+	unsigned long time;
+	unsigned char type;
+	unsigned char port;
+} Event;
+
+/**
+ * eventsInit()
+ * Sets up the queue and the switch interrupts. Call once from initialize().
+ */
+void eventsInit();
+
+/**
+ * eventsDispatch()
+ * Passes every queued event to the code that handles it. Run by the control task.
+ */
+void eventsDispatch();
+
+/**
+ * eventsDropped()
+ * @return the number of events lost because the queue was full
+ */
+unsigned int eventsDropped();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
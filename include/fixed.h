@@ -0,0 +1,132 @@
+/** @file fixed.h
+ * @brief Q16.16 fixed-point math for control code
+ *
+ * The Cortex-M3 has no FPU, so every float operation runs through the soft-float routines in
+ * libgcc and -lm. Control code should use these integer routines instead. A Fixed holds a
+ * signed value with 16 integer and 16 fraction bits; angles are in radians.
+ */
+
+#ifndef FIXED_H_
+#define FIXED_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A signed Q16.16 fixed-point number
+ */
+typedef int Fixed;
+
+/**
+ * 1.0 in Q16.16
+ */
+#define FIXED_ONE 65536
+/**
+ * Largest and smallest representable values, returned on saturation
+ */
+#define FIXED_MAX 0x7FFFFFFF
+#define FIXED_MIN (-0x7FFFFFFF - 1)
+/**
+ * pi, pi / 2 and 2 pi in Q16.16
+ */
+#define FIXED_PI 205887
+#define FIXED_HALF_PI 102944
+#define FIXED_TWO_PI 411775
+
+/**
+ * Converts a constant to Q16.16 at compile time; do not use on run-time floats
+ */
+#define FIXED(x) ((Fixed)((x) * 65536.0))
+
+/**
+ * Converts an integer to Q16.16 and back (rounding toward negative infinity)
+ */
+#define fixedFromInt(x) ((Fixed)((x) * FIXED_ONE))
+#define fixedToInt(x) ((int)((x) >> 16))
+
+/**
+ * fixedAdd()
+ * @return a + b, saturated to FIXED_MIN..FIXED_MAX
+ */
+Fixed fixedAdd(Fixed a, Fixed b);
+
+/**
+ * fixedSub()
+ * @return a - b, saturated to FIXED_MIN..FIXED_MAX
+ */
+Fixed fixedSub(Fixed a, Fixed b);
+
+/**
+ * fixedMul()
+ * @return a * b, saturated to FIXED_MIN..FIXED_MAX
+ */
+Fixed fixedMul(Fixed a, Fixed b);
+
+/**
+ * fixedDiv()
+ * @return a / b, saturated to FIXED_MIN..FIXED_MAX; dividing by zero saturates by the sign of a
+ */
+Fixed fixedDiv(Fixed a, Fixed b);
+
+/**
+ * fixedRecip()
+ * @return 1 / x, saturated to FIXED_MIN..FIXED_MAX
+ */
+Fixed fixedRecip(Fixed x);
+
+/**
+ * fixedSqrt()
+ * @return the square root of x, or 0 if x is negative
+ */
+Fixed fixedSqrt(Fixed x);
+
+/**
+ * fixedSin()
+ * Quarter-wave table lookup with linear interpolation, accurate to about 1e-4.
+ *
+ * @param angle any angle in radians
+ * @return the sine of the angle
+ */
+Fixed fixedSin(Fixed angle);
+
+/**
+ * fixedCos()
+ * @param angle any angle in radians
+ * @return the cosine of the angle
+ */
+Fixed fixedCos(Fixed angle);
+
+/**
+ * fixedAtan2()
+ * Table lookup with linear interpolation, accurate to about 1e-4 radians.
+ *
+ * @return the angle of the vector (x, y) from -pi to pi; 0 when both are zero
+ */
+Fixed fixedAtan2(Fixed y, Fixed x);
+
+/**
+ * fixedWrapAngle()
+ * @return the angle wrapped into -pi to pi
+ */
+Fixed fixedWrapAngle(Fixed angle);
+
+/**
+ * fixedBenchmark()
+ * Times the routines above and the soft-float ones they replace on the robot, and writes the
+ * cycles each call takes as one JSON object. Defined in fixedbench.c; takes a few tens of
+ * milliseconds.
+ *
+ * @param stream the stream to write to, such as stdout
+ */
+void fixedBenchmark(FILE *stream);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
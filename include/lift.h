@@ -0,0 +1,158 @@
+/** @file lift.h
+ * @brief Lift position controller
+ *
+ * Holds the lift at a height with a PID loop plus a constant gravity feedforward, both from
+ * calibration.h. It runs in the control task; while it is stopped the lift motors are left to
+ * whoever else writes them.
+ *
+ * Setpoints are queued to the control task without a mutex, so only one task at a time may
+ * queue them: the autonomous routine, or a self-test or tune while operator control waits for
+ * it. The driver taking the lift back and the mode manager holding it after a cut-off routine
+ * do not go through the queue: each is a flag the control task picks up after the setpoints.
+ *
+ * Each side of the lift has its own pair of motors. With a second sensor on the right side,
+ * liftTicks in the snapshot is the average of the two sides, and every lift output goes
+ * through liftControlDrive(), which speeds up the lower side and slows the higher one by the
+ * same amount. The average, which the position loop holds, is unaffected while the sides are
+ * pulled level.
+ */
+
+#ifndef LIFT_H_
+#define LIFT_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Distance from the setpoint in ticks within which the lift counts as there
+ */
+#define LIFT_TOLERANCE 10
+/**
+ * Most setpoint changes waiting for the control task
+ */
+#define LIFT_REQUESTS 8
+
+/**
+ * Sensor on the right side of the lift, chosen by calibration.h
+ */
+typedef enum {
+	//Only the encoder on the left side; both sides get the same command
+	LIFT_SENSOR_NONE,
+	//A potentiometer on LIFT_POT_PORT
+	LIFT_SENSOR_POT,
+	//A second encoder on LIFT_ENCODER_TOP and LIFT_ENCODER_BOTTOM
+	LIFT_SENSOR_ENCODER
+} LiftSensor;
+
+/**
+ * Analog port of the right lift potentiometer
+ */
+#define LIFT_POT_PORT 3
+/**
+ * Digital ports of the right lift encoder. Only port 12 is free, so the encoder takes the lift
+ * limit switch's port and the switch is left off (events.h).
+ */
+#define LIFT_ENCODER_TOP 12
+#define LIFT_ENCODER_BOTTOM 11
+/**
+ * Largest correction between the sides, in motor command units
+ */
+#define LIFT_SYNC_MAX 40
+/**
+ * Twist in ticks past which a side's sensor is taken to have failed; the correction stops
+ * rather than drive the sides further apart
+ */
+#define LIFT_TWIST_FAULT 120
+
+/**
+ * liftControlInit()
+ * Sets up the setpoint queue. Call once from initialize().
+ */
+void liftControlInit();
+
+/**
+ * liftControlSet()
+ * Starts driving the lift to a height and holding it there, from the next control tick.
+ *
+ * @param height the target in lift encoder ticks
+ */
+void liftControlSet(int height);
+
+/**
+ * liftControlStop()
+ * Stops the controller and the lift motors at the next control tick.
+ */
+void liftControlStop();
+
+/**
+ * liftControlRelease()
+ * Stops the controller and the lift motors at the next control tick, after any queued
+ * setpoints, so the driver can take the lift. Run by the driver's task only.
+ */
+void liftControlRelease();
+
+/**
+ * liftControlHold()
+ * Holds the lift where it is from this control tick, after any queued setpoints, if the
+ * controller is running. Run by the control task.
+ */
+void liftControlHold();
+
+/**
+ * liftControlActive()
+ * @return true while the controller is driving the lift, as of the last control tick
+ */
+bool liftControlActive();
+
+/**
+ * liftControlAtTarget()
+ * @return true once the lift is within LIFT_TOLERANCE of its target
+ */
+bool liftControlAtTarget();
+
+/**
+ * liftControlLimit()
+ * Handles the lift limit switch (events.h): a target below the current height is raised to it.
+ * Run by the control task.
+ */
+void liftControlLimit();
+
+/**
+ * liftControlOutput()
+ * One period of the lift position loop, for code that runs its own loop such as the driver's
+ * lift hold.
+ *
+ * @param pid the loop state, initialized with the lift gains
+ * @param target the target in lift encoder ticks
+ * @param height the measured height in lift encoder ticks
+ * @param elapsed the time since the last period in milliseconds
+ * @return the lift motor command
+ */
+int liftControlOutput(Pid *pid, int target, int height, unsigned long elapsed);
+
+/**
+ * liftControlDrive()
+ * Sets both sides of the lift for the current frame, correcting the twist between them. The
+ * command is pulled back from full power if needed to leave room for the correction.
+ *
+ * @param output the lift motor command
+ * @param twist the left side's height less the right side's, in ticks
+ */
+void liftControlDrive(int output, int twist);
+
+/**
+ * liftControlUpdate()
+ * Runs one control period. Run by the control task.
+ */
+void liftControlUpdate();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
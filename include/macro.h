@@ -0,0 +1,82 @@
+/** @file macro.h
+ * @brief Driver-assist macros
+ *
+ * A macro is a fixed sequence of claw, lift and drive steps started by one joystick button in
+ * operator control, such as grabbing an object, raising it to a preset and letting it go. Each
+ * macro runs as a command (command.h) in the control task, so the driver loop never waits on
+ * it, and the driver keeps the mechanisms the macro does not use. Moving the stick or pressing
+ * the buttons of a mechanism the macro uses, on the joystick mapped to it, interrupts it and
+ * hands everything back. Starting a macro that uses the lift releases the lift controller.
+ */
+
+#ifndef MACRO_H_
+#define MACRO_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lift presets in lift encoder ticks
+ */
+#define MACRO_CARRY_HEIGHT 120
+#define MACRO_SCORE_HEIGHT 640
+/**
+ * Claw command and time to close on an object and to open off it; a positive claw command
+ * closes (motors.h)
+ */
+#define MACRO_GRAB_POWER 127
+#define MACRO_GRAB_TIME 400
+#define MACRO_RELEASE_TIME 300
+/**
+ * Longest a lift step waits to reach its height, in milliseconds
+ */
+#define MACRO_LIFT_TIMEOUT 2000
+
+/**
+ * Step actions
+ */
+typedef enum {
+	//Run the claw at value for time
+	MACRO_CLAW,
+	//Move the lift to value ticks and hold it there for the rest of the macro; time is the limit
+	MACRO_LIFT,
+	//Run the drive at value for time
+	MACRO_DRIVE,
+	//Do nothing for time
+	MACRO_WAIT
+} MacroAction;
+
+/**
+ * One step of a macro
+ */
+typedef struct {
+	MacroAction action;
+	int value;
+	unsigned long time;
+} MacroStep;
+
+/**
+ * macroUpdate()
+ * Starts the macro bound to a newly pressed button, and interrupts running macros when the
+ * driver takes over. Call from operatorControl() once per loop, before driverStep().
+ *
+ * @param input the inputs sampled for this iteration
+ */
+void macroUpdate(const DriverInput *input);
+
+/**
+ * macroCancel()
+ * Interrupts every macro.
+ */
+void macroCancel();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
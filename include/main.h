@@ -44,6 +44,34 @@
 #define MAIN_H_
 
 #include <API.h>
+#include "arena.h"
+#include "autotune.h"
+#include "driver.h"
+#include "events.h"
+#include "fixed.h"
+#include "profile.h"
+#include "pid.h"
+#include "lift.h"
+#include "macro.h"
+#include "mode.h"
+#include "motors.h"
+#include "calibration.h"
+#include "containers.h"
+#include "command.h"
+#include "approach.h"
+#include "odometry.h"
+#include "path.h"
+#include "paths.h"
+#include "power.h"
+#include "range.h"
+#include "replay.h"
+#include "selftest.h"
+#include "sensors.h"
+#include "shell.h"
+#include "tasks.h"
+#include "telemetry.h"
+#include "traction.h"
+#include "yaw.h"
 
 // Allow usage of this file in C++ programs
 #ifdef __cplusplus
@@ -70,6 +98,44 @@ extern "C" {
  * so, the robot will await a switch to another mode or disable/enable cycle.
  */
 void autonomous();
+/**
+ * The autonomous routine itself, run in the routine task by the mode manager (mode.h) so it can
+ * be stopped at any moment. Its blocking steps must return once modeRoutineAborted() is true.
+ */
+void autonomousRoutine();
+/**
+ * autonomousSelect()
+ * Picks the routine autonomousRoutine() runs. The first routine in auto.c runs until another is
+ * picked.
+ *
+ * @param name the routine's name
+ * @return true if auto.c has a routine by that name
+ */
+bool autonomousSelect(const char *name);
+/**
+ * autonomousSelected()
+ * @return the name of the routine autonomousRoutine() runs
+ */
+const char *autonomousSelected();
+/**
+ * autonomousName()
+ * @param index a routine's place in auto.c, from 0
+ * @return the routine's name, or NULL past the last routine
+ */
+const char *autonomousName(unsigned int index);
+/**
+ * The turn routine: drive ticks each side runs to turn left on the spot
+ */
+#define AUTO_TURN 50
+/**
+ * The scoreAndReturn routine: distance from the goal to score at in centimeters and the longest
+ * the approach may take in milliseconds, then drive ticks to turn around onto backToStart and to
+ * drive on past its end to the next object
+ */
+#define AUTO_SCORE_DISTANCE 40
+#define AUTO_SCORE_TIMEOUT 3000
+#define AUTO_TURN_AROUND 600
+#define AUTO_PICKUP_DISTANCE 300
 /**
  * Runs pre-initialization code. This function will be started in kernel mode one time while the
  * VEX Cortex is starting up. As the scheduler is still paused, most API functions will fail.
@@ -0,0 +1,106 @@
+/** @file mode.h
+ * @brief Competition mode manager and the background autonomous routine
+ *
+ * The control task watches isEnabled(), isAutonomous() and isOnline() every tick. The tasks,
+ * odometry and the controllers run straight through every mode change; only the work that
+ * belongs to one mode is handed over. The lift controller keeps holding the lift where
+ * autonomous left it until the driver moves the lift stick.
+ *
+ * The autonomous routine, autonomousRoutine() in auto.c, runs once per start in the routine
+ * task, as a command, so autonomous() and the driver's practice shortcut only start it. It is
+ * cancelled when the field leaves autonomous, when the robot is disabled, or when the driver
+ * takes over. The routine's blocking helpers poll modeRoutineAborted() and return within
+ * MODE_POLL ms. The time from a cancel until the routine has let go of the mechanisms is kept
+ * as the handover latency.
+ */
+
+#ifndef MODE_H_
+#define MODE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Longest a routine helper waits between checks of modeRoutineAborted(), in milliseconds
+ */
+#define MODE_POLL 5
+
+/**
+ * Competition modes
+ */
+typedef enum {
+	MODE_DISABLED,
+	MODE_AUTONOMOUS,
+	MODE_DRIVER
+} Mode;
+
+/**
+ * modeInit()
+ * Sets up the routine's start signal. Call once from initialize() before the tasks start.
+ */
+void modeInit();
+
+/**
+ * modeUpdate()
+ * Follows the field state and cancels the routine when its mode ends. Run by the control task
+ * before commandUpdate().
+ */
+void modeUpdate();
+
+/**
+ * modeGet()
+ * @return the mode seen at the last control tick
+ */
+Mode modeGet();
+
+/**
+ * modeRoutineStart()
+ * Starts the autonomous routine in the routine task at the next control tick.
+ *
+ * @return false if the routine is running or still letting go after a cancel
+ */
+bool modeRoutineStart();
+
+/**
+ * modeRoutineCancel()
+ * Stops the autonomous routine, timing how long it takes to let go.
+ */
+void modeRoutineCancel();
+
+/**
+ * modeRoutineRunning()
+ * @return true from modeRoutineStart() until the routine has returned; the driver leaves every
+ * mechanism alone meanwhile
+ */
+bool modeRoutineRunning();
+
+/**
+ * modeRoutineAborted()
+ * @return true once the running routine has been cancelled; its helpers return at once
+ */
+bool modeRoutineAborted();
+
+/**
+ * modeRoutineRun()
+ * Waits for a start and runs the routine once. Run by the routine task.
+ */
+void modeRoutineRun();
+
+/**
+ * modeReport()
+ * Writes the mode, whether the field is connected and the handover latencies as JSON.
+ *
+ * @param stream the stream to write to, such as stdout
+ */
+void modeReport(FILE *stream);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+/** @file motors.h
+ * @brief Motor port map and buffered motor output layer
+ *
+ * All robot code writes its motor commands into a frame with motorFrameSet() or
+ * motorGroupSet(), and motorFrameCommit() sends the frame to the motors once per loop. This
+ * gives the power budget (power.h) one place to see and scale every output before it reaches
+ * the Cortex. The port each motor is sent to comes from the calibration port map, so a motor
+ * moved to another port only needs a calibration change.
+ */
+
+#ifndef MOTORS_H_
+#define MOTORS_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Motor Constants, each the port the motor is on unless calibration.h maps it elsewhere
+enum {
+	leftBackDrive = 1,
+	leftFrontDrive = 2,
+	leftLiftInner = 3,
+	leftLiftOuter = 4,
+	leftClaw = 5,
+	rightClaw = 6,
+	rightLiftOuter = 7,
+	rightLiftInner = 8,
+	rightFrontDrive = 9,
+	rightBackDrive = 10
+};
+
+/**
+ * Number of motor ports on the Cortex
+ */
+#define MOTOR_PORTS 10
+
+/**
+ * Largest number of motors driven together as one mechanism
+ */
+#define MOTOR_GROUP_MAX 4
+
+/**
+ * A set of motors that drive one mechanism together. A positive group speed moves the
+ * mechanism forward (drive forward, lift up, claw closed); direction flips the motors that are
+ * mounted the other way round.
+ */
+typedef struct {
+	unsigned char count;
+	unsigned char ports[MOTOR_GROUP_MAX];
+	signed char direction[MOTOR_GROUP_MAX];
+	unsigned char priority;
+} MotorGroup;
+
+extern const MotorGroup driveLeftMotors;
+extern const MotorGroup driveRightMotors;
+extern const MotorGroup liftMotors;
+//The two sides of liftMotors, for liftControlDrive()
+extern const MotorGroup liftLeftMotors;
+extern const MotorGroup liftRightMotors;
+extern const MotorGroup clawMotors;
+
+/**
+ * motorFrameSet()
+ * Sets the speed of one motor in the current frame. Nothing is sent until motorFrameCommit().
+ *
+ * @param channel the motor port from 1-10
+ * @param speed the new signed speed from -127 to 127
+ */
+void motorFrameSet(unsigned char channel, int speed);
+
+/**
+ * motorGroupSet()
+ * Sets every motor of a group in the current frame, applying each motor's direction.
+ *
+ * @param group the mechanism to drive
+ * @param speed the signed mechanism speed from -127 to 127
+ */
+void motorGroupSet(const MotorGroup *group, int speed);
+
+/**
+ * motorFrameGet()
+ * @param channel the motor port from 1-10
+ * @return the speed requested for the port in the current frame, before the power budget
+ */
+int motorFrameGet(unsigned char channel);
+
+/**
+ * motorGroupMeasured()
+ * Reports the measured speed of a mechanism so the power model can estimate back-EMF.
+ *
+ * @param group the mechanism that was measured
+ * @param speed the measured speed in command units, where 127 is free speed
+ */
+void motorGroupMeasured(const MotorGroup *group, int speed);
+
+/**
+ * motorFrameCommit()
+ * Updates the power model, scales the frame to the power budget and sends it to the motors.
+ * Only the control task calls this.
+ */
+void motorFrameCommit();
+
+/**
+ * motorFrameHold()
+ * Keeps every motor stopped while the frame is still written, as during a replay.
+ *
+ * @param hold true to stop the motors, false to resume sending the frame
+ */
+void motorFrameHold(bool hold);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
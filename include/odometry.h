@@ -0,0 +1,75 @@
+/** @file odometry.h
+ * @brief Drive encoder odometry
+ *
+ * Tracks the robot pose from the drive encoders in the shared sensor snapshot. Positions are in
+ * inches from where odometryReset() was last called, x pointing forward at that moment, and the
+ * heading is counter-clockwise positive in radians.
+ */
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Drive wheel travel per encoder tick in inches: a 4" wheel with a 360 tick encoder
+ */
+#define ODOMETRY_INCHES_PER_TICK FIXED(0.0349)
+/**
+ * Distance between the left and right wheels in inches
+ */
+#define ODOMETRY_TRACK_WIDTH FIXED(14.0)
+/**
+ * Most odometryReset() calls waiting for the control task
+ */
+#define ODOMETRY_RESETS 4
+
+/**
+ * A position and heading on the field
+ */
+typedef struct {
+	Fixed x;
+	Fixed y;
+	Fixed heading;
+} Pose;
+
+/**
+ * odometryInit()
+ * Sets up the pose storage. Call once from initialize() before odometryReset().
+ */
+void odometryInit();
+
+/**
+ * odometryReset()
+ * Sets the current pose. It takes effect at the next control tick; only one task at a time
+ * may call this.
+ *
+ * @param pose the pose the robot is at now
+ */
+void odometryReset(const Pose *pose);
+
+/**
+ * odometryUpdate()
+ * Advances the pose by the encoder travel since the last update. Run by the control task.
+ */
+void odometryUpdate();
+
+/**
+ * odometryGet()
+ * Copies the current pose.
+ *
+ * @param pose the copy to fill
+ */
+void odometryGet(Pose *pose);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/** @file path.h
+ * @brief Precomputed paths and the pure pursuit path follower
+ *
+ * Paths are planned offline by tools/pathgen.py, which fits quintic Hermite splines through
+ * waypoints and writes them to src/paths.c as const tables, so they live in flash. Each point
+ * carries the speed the robot should have there, limited by curvature and acceleration.
+ *
+ * The follower runs in the control task: it steers toward the point one lookahead distance
+ * ahead on the path using the odometry pose, so the robot drives a whole route without stopping
+ * to turn.
+ */
+
+#ifndef PATH_H_
+#define PATH_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Distance ahead on the path the follower steers toward, in inches
+ */
+#define PATH_LOOKAHEAD FIXED(12.0)
+/**
+ * Distance from the last point at which a path is finished, in inches
+ */
+#define PATH_TOLERANCE FIXED(1.5)
+/**
+ * Fastest drive speed planned by tools/pathgen.py, in inches per second
+ */
+#define PATH_MAX_SPEED FIXED(20.0)
+/**
+ * Slowest speed commanded before the end of a path, so the robot does not stall short of it
+ */
+#define PATH_MIN_SPEED FIXED(3.0)
+
+/**
+ * One sample of a planned path
+ */
+typedef struct {
+	Fixed x;
+	Fixed y;
+	//Target speed at this point in inches per second
+	Fixed speed;
+} PathPoint;
+
+/**
+ * A planned path
+ */
+typedef struct {
+	const PathPoint *points;
+	unsigned int count;
+} Path;
+
+/**
+ * pathFollowStart()
+ * Starts following a path from the current pose. The path's first point should be close to it.
+ *
+ * @param path the path to follow; it must stay valid until the follower is done
+ */
+void pathFollowStart(const Path *path);
+
+/**
+ * pathFollowUpdate()
+ * Steers one control tick along the current path. Run by the control task.
+ */
+void pathFollowUpdate();
+
+/**
+ * pathFollowDone()
+ * @return true once the robot has reached the end of the path, or if no path is running
+ */
+bool pathFollowDone();
+
+/**
+ * pathFollowStop()
+ * Abandons the current path and stops the drive.
+ */
+void pathFollowStop();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,13 @@
+/** @file paths.h
+ * @brief Planned paths, generated by tools/pathgen.py; do not edit
+ */
+
+#ifndef PATHS_H_
+#define PATHS_H_
+
+#include "path.h"
+
+extern const Path scoreCurve;
+extern const Path backToStart;
+
+#endif
@@ -0,0 +1,62 @@
+/** @file pid.h
+ * @brief Fixed-point PID controller
+ */
+
+#ifndef PID_H_
+#define PID_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * PID gains and state. Error is in sensor ticks and the output in motor command units, so kP
+ * is command per tick, kI command per tick-second and kD command per tick-per-second.
+ */
+typedef struct {
+	Fixed kP;
+	Fixed kI;
+	Fixed kD;
+	//Accumulated error in tick-seconds
+	Fixed integral;
+	int lastError;
+	bool started;
+	//Timing of each step, one section per task so two tasks never share a start time
+	ProfileSection *profile;
+} Pid;
+
+/**
+ * pidInit()
+ * Sets the gains and clears the state.
+ *
+ * @param pid the controller
+ * @param kP the proportional gain
+ * @param kI the integral gain
+ * @param kD the derivative gain
+ * @param profile the section each step is timed in, owned by the task that steps the controller
+ */
+void pidInit(Pid *pid, Fixed kP, Fixed kI, Fixed kD, ProfileSection *profile);
+
+/**
+ * pidStep()
+ * Runs the controller for one period. The integral only grows while neither the output,
+ * feedforward included, nor the proportional term alone saturates, and what it contributes is
+ * clamped to 20. A long gap between steps is integrated as 100 ms.
+ *
+ * @param pid the controller
+ * @param error the setpoint minus the measurement, in ticks
+ * @param feedforward a command added to the loop's, such as the lift's gravity hold
+ * @param elapsed the time since the last step in milliseconds
+ * @return the motor command from -127 to 127
+ */
+int pidStep(Pid *pid, int error, int feedforward, unsigned long elapsed);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
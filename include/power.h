@@ -0,0 +1,189 @@
+/** @file power.h
+ * @brief Motor current, heating and PTC breaker model with power budgeting
+ *
+ * The 393 motors and the two Cortex port banks (1-5 and 6-10) are protected by PTC fuses that
+ * cut the motors out when they get hot. The model estimates each motor's current from the
+ * commanded PWM, the measured speed and the battery voltage, tracks the heat in every fuse,
+ * and lets the budget scale lower priority outputs down before any fuse trips.
+ *
+ * The brownout monitor follows the main battery at the sensing rate. The Cortex resets when
+ * the battery sags too far, which a stalled lift on a tired battery can do. So the monitor
+ * predicts the voltage a short horizon ahead from its slope and sheds load in stages before it
+ * gets there:
+ *
+ *     1  claw hold     low priority outputs scaled down to POWER_SHED_CLAW_FLOOR percent
+ *     2  lift speed    medium priority outputs scaled down to POWER_SHED_LIFT_FLOOR percent
+ *     3  drive accel   high priority outputs slew limited to POWER_SHED_DRIVE_ACCEL
+ *
+ * The thresholds for each stage are calibration fields. A stage is lifted one at a time, only
+ * after the prediction has stayed clear of its threshold for POWER_SHED_HOLD ms. The load then
+ * ramps back at POWER_SHED_RESTORE percent per second instead of all at once.
+ *
+ * The model does not call the PROS API so it can be fed from recorded telemetry.
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Outputs that may be scaled first (claw hold)
+ */
+#define POWER_PRIORITY_LOW 0
+/**
+ * Outputs scaled only when a fuse is close to tripping (lift)
+ */
+#define POWER_PRIORITY_MEDIUM 1
+/**
+ * Outputs that are never scaled by the budget (drive); only their acceleration is limited
+ * near brownout
+ */
+#define POWER_PRIORITY_HIGH 2
+
+/**
+ * Number of Cortex port bank breakers
+ */
+#define POWER_BANKS 2
+
+/**
+ * Sustained current in milliamps that trips a 393 motor's internal PTC
+ */
+#define POWER_MOTOR_TRIP_MA 1800
+/**
+ * Sustained current in milliamps that trips one Cortex port bank PTC
+ */
+#define POWER_BANK_TRIP_MA 4000
+/**
+ * Thermal time constant of a motor PTC in milliseconds
+ */
+#define POWER_MOTOR_TAU_MS 8000
+/**
+ * Thermal time constant of a Cortex bank PTC in milliseconds
+ */
+#define POWER_BANK_TAU_MS 20000
+
+/**
+ * Brownout shedding stages, each including the ones before it
+ */
+#define POWER_SHED_NONE 0
+#define POWER_SHED_CLAW 1
+#define POWER_SHED_LIFT 2
+#define POWER_SHED_DRIVE 3
+/**
+ * Time constants in milliseconds of the battery voltage filter and of its slope
+ */
+#define POWER_VOLTAGE_TAU_MS 40
+#define POWER_SLOPE_TAU_MS 80
+/**
+ * Share of the claw and lift commands, in percent, left while their stage is shed
+ */
+#define POWER_SHED_CLAW_FLOOR 0
+#define POWER_SHED_LIFT_FLOOR 50
+/**
+ * Drive acceleration limit in command units per second while the drive stage is shed
+ */
+#define POWER_SHED_DRIVE_ACCEL 400
+/**
+ * Millivolts above a stage's threshold the prediction must reach before it is lifted, and the
+ * time in milliseconds it must stay there
+ */
+#define POWER_SHED_HYSTERESIS 150
+#define POWER_SHED_HOLD 500
+/**
+ * Percent per second at which shed load comes back
+ */
+#define POWER_SHED_RESTORE 100
+
+/**
+ * powerMotorCurrent()
+ * Estimates the current drawn by one 393 motor.
+ *
+ * @param command the commanded speed from -127 to 127
+ * @param measured the measured speed in command units, where 127 is free speed
+ * @param batteryMillivolts the main battery voltage
+ * @return the estimated current in milliamps, never negative
+ */
+int powerMotorCurrent(int command, int measured, unsigned int batteryMillivolts);
+
+/**
+ * powerModelUpdate()
+ * Advances the fuse heat model by the given time using the outputs that were held over it.
+ *
+ * @param command the committed speed of each port, indexed from port 1
+ * @param measured the measured speed of each port in command units
+ * @param batteryMillivolts the main battery voltage
+ * @param elapsed the time in milliseconds the outputs were held
+ */
+void powerModelUpdate(const int *command, const int *measured, unsigned int batteryMillivolts,
+	unsigned long elapsed);
+
+/**
+ * powerBudgetApply()
+ * Scales low and medium priority outputs down as the fuses feeding them heat up, and sheds
+ * load by the brownout stage. Call once per motor frame commit.
+ *
+ * @param command the requested speed of each port, scaled in place
+ * @param priority the POWER_PRIORITY_* of each port
+ */
+void powerBudgetApply(int *command, const unsigned char *priority);
+
+/**
+ * powerMotorLoad()
+ * @param channel the motor port from 1-10
+ * @return the heat in the motor's PTC as a percentage of its trip point
+ */
+int powerMotorLoad(unsigned char channel);
+
+/**
+ * powerBankLoad()
+ * @param bank 0 for ports 1-5, 1 for ports 6-10
+ * @return the heat in the Cortex bank PTC as a percentage of its trip point
+ */
+int powerBankLoad(unsigned char bank);
+
+/**
+ * powerMonitorUpdate()
+ * Follows the battery voltage and updates the shedding stage. Run by the sensing task after
+ * every sample.
+ *
+ * @param batteryMillivolts the main battery voltage; 0, a failed reading, is skipped
+ * @param elapsed the time in milliseconds since the last update
+ */
+void powerMonitorUpdate(unsigned int batteryMillivolts, unsigned long elapsed);
+
+/**
+ * powerShedLevel()
+ * @return the shedding stage, POWER_SHED_NONE to POWER_SHED_DRIVE
+ */
+int powerShedLevel();
+
+/**
+ * powerPredicted()
+ * @return the battery voltage predicted at the calibration's brownout horizon, in millivolts
+ */
+int powerPredicted();
+
+/**
+ * powerBrownouts()
+ * @return the number of times shedding has started since initialize()
+ */
+unsigned int powerBrownouts();
+
+/**
+ * powerModelReset()
+ * Clears all fuse heat, as after the robot has been sitting disabled.
+ */
+void powerModelReset();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
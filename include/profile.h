@@ -0,0 +1,83 @@
+/** @file profile.h
+ * @brief On-robot timing of control code paths
+ *
+ * Wrap a code path in profileBegin() / profileEnd() to record how often it runs and how long
+ * it takes, measured with micros(). profileReport() writes every section as one JSON object
+ * so runs from different builds can be compared by a script.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most sections that can be reported
+ */
+#define PROFILE_SECTIONS 16
+/**
+ * Histogram buckets; bucket n counts runs shorter than 2^n microseconds, the last one the rest
+ */
+#define PROFILE_BUCKETS 12
+
+/**
+ * Timing statistics for one code path
+ */
+typedef struct {
+	const char *name;
+	bool registered;
+	unsigned long start;
+	unsigned long count;
+	unsigned long total;
+	unsigned long min;
+	unsigned long max;
+	unsigned long histogram[PROFILE_BUCKETS];
+} ProfileSection;
+
+/**
+ * Declares a section with the given name, to be defined at file scope
+ */
+#define PROFILE_SECTION(sectionName) { sectionName, false, 0, 0, 0, 0xFFFFFFFF, 0, {0} }
+
+/**
+ * profileBegin()
+ * Starts timing a section. Sections must not be shared between tasks.
+ *
+ * @param section the section being entered
+ */
+void profileBegin(ProfileSection *section);
+
+/**
+ * profileEnd()
+ * Stops timing a section and records the run.
+ *
+ * @param section the section being left
+ * @return the time this run took in microseconds
+ */
+unsigned long profileEnd(ProfileSection *section);
+
+/**
+ * profileReport()
+ * Writes the statistics of every section that has run as a JSON object on one line.
+ *
+ * @param stream the serial port or stdout to write to
+ */
+void profileReport(FILE *stream);
+
+/**
+ * profileReset()
+ * Clears the statistics of every section.
+ */
+void profileReset();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/** @file range.h
+ * @brief Ultrasonic range sensors
+ *
+ * Two ultrasonic sensors face forward, one each side of the robot. PROS pings them in the
+ * background one after the other, so reading them never waits on an echo. The sensing task
+ * takes a reading from each every RANGE_PERIOD and filters it: missed echoes and readings that
+ * jump away from the recent median are dropped until they repeat, and the published distance
+ * is the median of the last three kept readings.
+ *
+ * For bench testing with the wheels off the ground, the sensors can be replaced by a model of
+ * a wall in front of the robot, measured from the odometry pose with the sensors' cone, noise,
+ * missed echoes and stray short echoes.
+ */
+
+#ifndef RANGE_H_
+#define RANGE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Digital ports of the sensors
+ */
+#define RANGE_LEFT_ECHO 7
+#define RANGE_LEFT_PING 8
+#define RANGE_RIGHT_ECHO 9
+#define RANGE_RIGHT_PING 10
+/**
+ * Distance between the two sensors across the robot in centimeters
+ */
+#define RANGE_SPACING 30
+/**
+ * Time between readings in milliseconds, about one ping of each sensor
+ */
+#define RANGE_PERIOD 50
+/**
+ * Farthest distance trusted in centimeters
+ */
+#define RANGE_MAX 200
+/**
+ * Largest change from the median in centimeters kept without a repeat
+ */
+#define RANGE_JUMP 25
+/**
+ * Missed echoes in a row after which a sensor reports nothing
+ */
+#define RANGE_MISSES 3
+/**
+ * Distance reported when a sensor sees nothing
+ */
+#define RANGE_NONE -1
+
+/**
+ * rangeInit()
+ * Starts both sensors. Call once from initialize().
+ */
+void rangeInit();
+
+/**
+ * rangeUpdate()
+ * Takes and filters a reading from each sensor when RANGE_PERIOD has passed, otherwise gives
+ * the last filtered distances. Run by the sensing task.
+ *
+ * @param now the sample time from millis()
+ * @param left filled with the left distance in centimeters, or RANGE_NONE
+ * @param right filled with the right distance in centimeters, or RANGE_NONE
+ */
+void rangeUpdate(unsigned long now, int *left, int *right);
+
+/**
+ * rangeSimulate()
+ * Replaces the sensors with the wall model, or goes back to the sensors.
+ *
+ * @param simulate true to use the model
+ * @param wallX the wall position along the odometry x axis in inches; the wall faces -x
+ */
+void rangeSimulate(bool simulate, Fixed wallX);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/** @file replay.h
+ * @brief Record and replay of operator control for regression checks
+ *
+ * While recording, every operatorControl() iteration queues the sampled DriverInput, the time
+ * driverStep() took and the motor frame it produced, and the shell task sends each as one text
+ * line on the USB serial console. The driver code is reset as recording starts, as it is when
+ * the recording is replayed. Saving the console output gives a recording:
+ *
+ *     F,<time>,<a1>,<a2>,<a3>,<a4>,<b5>,<b6>,<b7>,<b8>,<p1>,<p2>,<p3>,<p4>,<q5>,<q6>,<q7>,<q8>,
+ *       <connected>,<left>,<right>,<lift>,<twist>,<battery>,<held>,<us>,<m1>,...,<m10>
+ *
+ * where a and b are joystick 1's axes and button groups and p and q are joystick 2's. A field
+ * the same as in the line before is left empty, which keeps a line to a few dozen characters
+ * while most sticks and buttons rest, well inside what 115200 baud carries every 20 ms. The
+ * driver loop never waits on the console: when the queue is full the iteration is dropped, and
+ * the next line is sent in full after a line "G,<dropped>".
+ *
+ * replayRun() reads the same lines back from the console, runs driverStep() on each input
+ * with the motors left off, and reports every output that differs and whether the step got
+ * slower. After a gap it starts the driver code again from the next line, and the replay
+ * fails. Ports of mechanisms held by a command, such as a macro, are driven by the control
+ * task rather than driverStep(), so they are not compared. Send a recording to a robot running
+ * a new build with, for example, "cat drive.rec > /dev/ttyACM0", and end it with a line holding
+ * only "E". "make replay" does the same on the development machine (tools/replaysim.c).
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Percentage by which the mean step time may grow before a timing regression is flagged
+ */
+#define REPLAY_TIMING_TOLERANCE 20
+
+/**
+ * Recorded iterations queued for the shell task; a power of two
+ */
+#define REPLAY_QUEUE 8
+/**
+ * Longest recorded line in characters, including the terminating null
+ */
+#define REPLAY_LINE 240
+
+/**
+ * replayInit()
+ * Sets up the recording queue. Only call during initialize().
+ */
+void replayInit();
+
+/**
+ * replayRecord()
+ * Queues one recorded iteration for replaySend(). Call from the operator control task only.
+ *
+ * @param input the inputs of the iteration
+ * @param stepMicros the time driverStep() took
+ */
+void replayRecord(const DriverInput *input, unsigned long stepMicros);
+
+/**
+ * replayNextLine()
+ * Takes the next recorded line off the queue, without the line ending.
+ *
+ * @param line filled with the line
+ * @param size the size of line, at least REPLAY_LINE
+ * @return false if nothing is queued
+ */
+bool replayNextLine(char *line, unsigned int size);
+
+/**
+ * replaySend()
+ * Sends every queued line to the serial console. Run by the shell task every SHELL_PERIOD.
+ */
+void replaySend();
+
+/**
+ * replayBegin()
+ * Starts a replay, for replayLine() to feed.
+ */
+void replayBegin();
+
+/**
+ * replayLine()
+ * Replays one recorded line; other lines are skipped.
+ *
+ * @param line the line, which may end in a line ending
+ */
+void replayLine(char *line);
+
+/**
+ * replayEnd()
+ * Prints the summary of a replay.
+ *
+ * @return true if frames were replayed without a gap, every frame matched and the step time is
+ * within tolerance
+ */
+bool replayEnd();
+
+/**
+ * replayRun()
+ * Replays a recording from the serial console until the end line, then prints a summary.
+ *
+ * @return the result of replayEnd()
+ */
+bool replayRun();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+/** @file selftest.h
+ * @brief Subsystem self-tests
+ *
+ * Each mechanism with a sensor is driven briefly at a low command and its encoder is checked
+ * for movement in the right direction, which catches unplugged motors, swapped ports and
+ * reversed or dead encoders before a match. The battery is checked as well.
+ *
+ * The robot moves during a test: the drive creeps forward a few inches and the lift rises a
+ * little. operatorControl() leaves the motors alone while a test runs.
+ */
+
+#ifndef SELFTEST_H_
+#define SELFTEST_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Command each mechanism is driven at during its test
+ */
+#define SELFTEST_POWER 50
+/**
+ * Time each mechanism is driven for in milliseconds
+ */
+#define SELFTEST_TIME 400
+/**
+ * Fewest encoder ticks a mechanism must move to pass
+ */
+#define SELFTEST_MIN_TICKS 20
+/**
+ * Lowest battery voltage that passes in millivolts
+ */
+#define SELFTEST_MIN_BATTERY 7000
+
+/**
+ * selftestRun()
+ * Runs every test in the calling task and writes the results as one JSON object. Does nothing
+ * during autonomous.
+ *
+ * @param stream the stream to write the results to, such as stdout
+ * @return true if every test passed
+ */
+bool selftestRun(FILE *stream);
+
+/**
+ * selftestActive()
+ * @return true while a test is driving the motors
+ */
+bool selftestActive();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
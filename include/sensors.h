@@ -0,0 +1,126 @@
+/** @file sensors.h
+ * @brief Robot sensors and the shared sensor snapshot
+ *
+ * The sensing task samples every sensor at a fixed rate into one snapshot. Other tasks copy
+ * the snapshot with sensorsGet() instead of reading the hardware, so everything in one control
+ * tick sees values taken at the same moment.
+ *
+ * The encoders are never reset. Each sample adds what they moved since the last one to 64-bit
+ * counts that do not wrap in any match, and code that measures from a point of its own, such
+ * as a distance move, keeps an EncoderMark instead of resetting the counts under everyone
+ * else.
+ */
+
+#ifndef SENSORS_H_
+#define SENSORS_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sensor sampling period in milliseconds
+ */
+#define SENSORS_PERIOD 5
+
+/**
+ * Encoders counted in the snapshot
+ */
+typedef enum {
+	SENSORS_LEFT,
+	SENSORS_RIGHT,
+	//On the left side of the lift
+	SENSORS_LIFT,
+	//The right lift encoder, which stays at zero unless calibration.h selects one
+	SENSORS_LIFT_RIGHT,
+	SENSORS_ENCODERS
+} SensorsEncoder;
+
+/**
+ * All sensor values taken in one sample
+ */
+typedef struct {
+	//millis() when the sample was taken
+	unsigned long time;
+	//Counts of each encoder since initialize()
+	long long counts[SENSORS_ENCODERS];
+	//Drive encoder counts, the low 32 bits of counts; take differences
+	int leftTicks;
+	int rightTicks;
+	//Lift height above sensorsLiftZero(), the average of its two sides when the right side has
+	//a sensor (lift.h)
+	int liftTicks;
+	int liftLeftTicks;
+	int liftRightTicks;
+	//Main battery in millivolts
+	unsigned int battery;
+	//Gyro heading in radians, counterclockwise positive and not wrapped (yaw.h)
+	Fixed heading;
+	//Filtered ultrasonic distances in centimeters, or RANGE_NONE (range.h)
+	int rangeLeft;
+	int rangeRight;
+} SensorSnapshot;
+
+/**
+ * One consumer's zero point on an encoder
+ */
+typedef struct {
+	SensorsEncoder encoder;
+	long long zero;
+} EncoderMark;
+
+/**
+ * sensorsInit()
+ * Initializes the encoders and the snapshot. Call once from initialize().
+ */
+void sensorsInit();
+
+/**
+ * sensorsLiftZero()
+ * Takes the lift height at the next sample as zero on both sides. Call only with the lift all
+ * the way down.
+ */
+void sensorsLiftZero();
+
+/**
+ * sensorsUpdate()
+ * Samples every sensor into the snapshot. Run by the sensing task, which is the snapshot's only
+ * writer.
+ */
+void sensorsUpdate();
+
+/**
+ * sensorsGet()
+ * Copies the latest snapshot.
+ *
+ * @param snapshot the copy to fill
+ */
+void sensorsGet(SensorSnapshot *snapshot);
+
+/**
+ * sensorsMark()
+ * Sets a mark at an encoder's count in a snapshot.
+ *
+ * @param mark the mark to set
+ * @param encoder the encoder to measure
+ * @param sensors the snapshot to take the count from
+ */
+void sensorsMark(EncoderMark *mark, SensorsEncoder encoder, const SensorSnapshot *sensors);
+
+/**
+ * sensorsSinceMark()
+ * @param mark a mark set by sensorsMark()
+ * @param sensors a snapshot taken since the mark was set
+ * @return the counts the marked encoder moved from the mark to the snapshot
+ */
+int sensorsSinceMark(const EncoderMark *mark, const SensorSnapshot *sensors);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
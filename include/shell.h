@@ -0,0 +1,54 @@
+/** @file shell.h
+ * @brief Command shell on the USB serial console
+ *
+ * A low priority task reads command lines from stdin and answers on stdout. Type "help" for
+ * the command list. Input is only read once characters have arrived, so the task never waits
+ * on the console and streams telemetry between commands.
+ *
+ * Telemetry lines are
+ *
+ *     T,<time>,<left>,<right>,<lift>,<battery>,<m1>,...,<m10>
+ *
+ * with the sensor snapshot and the motor frame, at up to 1000 / SHELL_PERIOD lines a second.
+ */
+
+#ifndef SHELL_H_
+#define SHELL_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Longest command line in characters
+ */
+#define SHELL_LINE 64
+/**
+ * Most words in a command line, including the command
+ */
+#define SHELL_ARGS 4
+
+/**
+ * shellPoll()
+ * Reads any waiting console input, runs each complete command and sends telemetry when due.
+ * Run by the shell task every SHELL_PERIOD.
+ */
+void shellPoll();
+
+/**
+ * shellSuspend()
+ * Stops the shell reading the console, so other code such as replayRun() can.
+ *
+ * @param suspend true to stop reading, false to resume
+ */
+void shellSuspend(bool suspend);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
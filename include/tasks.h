@@ -0,0 +1,93 @@
+/** @file tasks.h
+ * @brief Task plan for the robot subsystems
+ *
+ * Every subsystem loop runs in its own task, created once from initialize() so it keeps running
+ * across mode changes:
+ *
+ *     control   TASK_PRIORITY_HIGHEST      odometry, path follower, lift controller and motor
+ *                                          frame commit every CONTROL_PERIOD ms
+ *     sensing   TASK_PRIORITY_HIGHEST - 1  samples the sensor snapshot every SENSORS_PERIOD ms
+ *     routine   TASK_PRIORITY_DEFAULT      runs the autonomous routine when started (mode.h)
+ *     display   TASK_PRIORITY_LOWEST       writes the LCD every DISPLAY_PERIOD ms
+ *
+ * operatorControl() and autonomous() stay in the PROS tasks at TASK_PRIORITY_DEFAULT and only
+ * write the motor frame; autonomous() only starts the routine. Stacks are painted when a task
+ * starts so tasksReport() can show how much of each stack has ever been used; size the stacks
+ * from that report.
+ */
+
+#ifndef TASKS_H_
+#define TASKS_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Control loop period in milliseconds
+ */
+#define CONTROL_PERIOD 10
+/**
+ * LCD refresh period in milliseconds
+ */
+#define DISPLAY_PERIOD 100
+/**
+ * Serial shell poll period in milliseconds, which also limits the telemetry rate
+ */
+#define SHELL_PERIOD 20
+/**
+ * Telemetry send period in milliseconds
+ */
+#define TELEMETRY_PERIOD 20
+
+/**
+ * Stack sizes in 4-byte words
+ */
+#define CONTROL_STACK 384
+#define SENSING_STACK 256
+#define ROUTINE_STACK 384
+#define DISPLAY_STACK 384
+#define SHELL_STACK 512
+#define TELEMETRY_STACK 256
+
+/**
+ * tasksStart()
+ * Creates every task in the plan. Call once from initialize() after sensorsInit().
+ */
+void tasksStart();
+
+/**
+ * tasksReport()
+ * Writes each task's priority, stack size and stack high-water mark, and the total stack use
+ * against the RAM left for the heap, as one JSON object.
+ *
+ * @param stream the serial port or stdout to write to
+ */
+void tasksReport(FILE *stream);
+
+/**
+ * displayStatus()
+ * Sets the text on the second LCD line until it is changed again.
+ *
+ * @param text up to 16 characters, or NULL to show the drive encoders since displayZero(); the
+ * pointer must stay
+ * valid
+ */
+void displayStatus(const char *text);
+
+/**
+ * displayZero()
+ * Starts the drive encoders shown on the LCD from zero, leaving the counts everything else
+ * reads alone.
+ */
+void displayZero();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
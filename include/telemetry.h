@@ -0,0 +1,99 @@
+/** @file telemetry.h
+ * @brief Binary telemetry stream on UART 2
+ *
+ * The control task takes one sample of every channel each period into a lock-free queue, and
+ * a low priority task sends the queued samples as binary frames on UART 2, so formatting and
+ * serial output never hold up the control loop. A full queue drops samples rather than wait.
+ *
+ * Each frame is COBS encoded and ends with a zero byte. Decoded, it holds (little endian):
+ *
+ *     u8 type (TELEMETRY_SAMPLE), u8 sequence, u32 time in ms,
+ *     s16 value for each of the TELEMETRY_CHANNELS channels, u16 CRC-16/CCITT of the above
+ *
+ * The sequence number counts every sample taken, so the receiver sees dropped ones as gaps.
+ * Values are 16 bits; encoder counts wrap and the receiver unwraps them. tools/telemetry.py
+ * decodes the stream to CSV or a live plot.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * UART 2 baud rate
+ */
+#define TELEMETRY_BAUD 115200
+/**
+ * Samples the queue holds; a power of two
+ */
+#define TELEMETRY_QUEUE 32
+/**
+ * Frame type of a sample
+ */
+#define TELEMETRY_SAMPLE 1
+
+/**
+ * Telemetry channels, in frame order
+ */
+enum {
+	TELEMETRY_LEFT_TICKS,
+	TELEMETRY_RIGHT_TICKS,
+	TELEMETRY_LIFT_TICKS,
+	TELEMETRY_LIFT_TARGET,
+	TELEMETRY_LIFT_OUTPUT,
+	TELEMETRY_DRIVE_LEFT,
+	TELEMETRY_DRIVE_RIGHT,
+	TELEMETRY_BATTERY,
+	TELEMETRY_LIFT_TWIST,
+	//Brownout monitor (power.h): the predicted battery millivolts and the shedding stage
+	TELEMETRY_BATTERY_PREDICTED,
+	TELEMETRY_SHED_LEVEL,
+	TELEMETRY_CHANNELS
+};
+
+/**
+ * telemetryInit()
+ * Opens UART 2. Call from initializeIO().
+ */
+void telemetryInit();
+
+/**
+ * telemetrySet()
+ * Sets a channel that is not read from the sensors or the motor frame, such as a setpoint. The
+ * value is sent with every sample until it is set again.
+ *
+ * @param channel the channel
+ * @param value the new value
+ */
+void telemetrySet(unsigned int channel, int value);
+
+/**
+ * telemetrySample()
+ * Queues one sample of every channel. Run by the control task after motorFrameCommit().
+ */
+void telemetrySample();
+
+/**
+ * telemetrySend()
+ * Sends every queued sample. Run by the telemetry task.
+ */
+void telemetrySend();
+
+/**
+ * telemetryDropped()
+ * @return the number of samples dropped because the queue was full
+ */
+unsigned int telemetryDropped();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+/** @file traction.h
+ * @brief Drive traction control and anti-tip limits
+ *
+ * Shapes the driver's drive command for one side of the drive before it reaches the motors.
+ * A 393 motor's torque follows the gap between its command and its speed, so the command is
+ * kept within a torque limit of the measured wheel speed, below what the wheels can put on the
+ * floor. When the measured wheels speed up faster than the robot can, they are slipping and the
+ * limit drops until they grip again.
+ *
+ * The command is also slew limited. The higher the lift, the higher the robot's center of
+ * gravity, so the acceleration and braking limits shrink as the lift rises, to keep a hard
+ * start or stop from tipping the robot.
+ *
+ * Speeds are in motor command units, where 127 is free speed. The controller does not call the
+ * PROS API, so tools/tractionsim.c runs it against a model of the drive.
+ */
+
+#ifndef TRACTION_H_
+#define TRACTION_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Largest command above or below the measured speed, about the torque the wheels hold
+ */
+#define TRACTION_TORQUE 70
+/**
+ * Torque limit while the wheels are slipping
+ */
+#define TRACTION_SLIP_TORQUE 30
+/**
+ * Measured wheel acceleration, in command units per second, above which the wheels are
+ * slipping; the robot itself cannot speed up this fast
+ */
+#define TRACTION_SLIP_ACCEL 1500
+/**
+ * Acceleration and braking limits in command units per second, with the lift down and at the
+ * top; the limits in between follow the lift height
+ */
+#define TRACTION_ACCEL 1000
+#define TRACTION_ACCEL_HIGH 300
+#define TRACTION_DECEL 1200
+#define TRACTION_DECEL_HIGH 300
+/**
+ * Lift height in ticks at which the high limits apply
+ */
+#define TRACTION_LIFT_TOP 700
+
+/**
+ * Traction state of one side of the drive
+ */
+typedef struct {
+	//Last command sent, in thousandths so slow slews are not lost to rounding
+	int output;
+	//Measured speed at the last step
+	int measured;
+} Traction;
+
+/**
+ * tractionReset()
+ * Starts a side from its current speed.
+ *
+ * @param side the side
+ * @param measured the measured speed
+ */
+void tractionReset(Traction *side, int measured);
+
+/**
+ * tractionStep()
+ * Shapes one command for a side.
+ *
+ * @param side the side
+ * @param target the command the driver asked for
+ * @param measured the measured speed of the side's wheels
+ * @param liftTicks the lift height in encoder ticks
+ * @param elapsed the time since the last step in milliseconds
+ * @return the command to send
+ */
+int tractionStep(Traction *side, int target, int measured, int liftTicks,
+	unsigned long elapsed);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/** @file yaw.h
+ * @brief Gyro heading service
+ *
+ * Reads the yaw rate gyro on an analog port at the sensing rate and integrates it into a
+ * heading for the sensor snapshot. The PROS gyro driver is not used, so the integration rate,
+ * the bias estimate and the scale are under our control.
+ *
+ * The bias is measured once while the robot sits still in initialize(). The gyro has no
+ * temperature output, so drift from warming up and from age is followed instead: whenever the
+ * drive encoders have not moved and the rate is small for YAW_STILL_TIME, the reading is taken
+ * as pure bias, the bias estimate is nudged toward it and nothing is integrated.
+ */
+
+#ifndef YAW_H_
+#define YAW_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Analog port of the gyro
+ */
+#define YAW_PORT 2
+/**
+ * Largest rate, in analogReadCalibratedHR() counts, still taken as bias when the drive has not
+ * moved; about 3 degrees per second
+ */
+#define YAW_STILL_RATE 40
+/**
+ * Time the robot must be still before the bias is tracked, in milliseconds
+ */
+#define YAW_STILL_TIME 500
+/**
+ * Bias tracking gain as a shift; 8 follows a step with a time constant of 256 samples
+ */
+#define YAW_BIAS_SHIFT 8
+
+/**
+ * yawInit()
+ * Measures the gyro bias, taking half a second. The robot must not move. Call once from
+ * initialize().
+ */
+void yawInit();
+
+/**
+ * yawUpdate()
+ * Integrates one gyro sample. Run by the sensing task.
+ *
+ * @param elapsed the time since the last sample in milliseconds
+ * @param driveStill true if the drive encoders have not moved since the last sample
+ */
+void yawUpdate(unsigned long elapsed, bool driveStill);
+
+/**
+ * yawHeading()
+ * @return the heading in radians, counterclockwise positive and not wrapped
+ */
+Fixed yawHeading();
+
+/**
+ * yawReset()
+ * Sets the current heading. It takes effect at the next yawUpdate().
+ *
+ * @param heading the new heading in radians
+ */
+void yawReset(Fixed heading);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
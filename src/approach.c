@@ -0,0 +1,95 @@
+/** @file approach.c
+ * @brief Ultrasonic approach to a game object
+ */
+
+#include "main.h"
+
+/**
+ * approachDrive()
+ * Limits a drive command to the approach speed range, keeping it off the stall band.
+ */
+static int approachDrive(Fixed command, bool moving) {
+	int speed = fixedToInt(command);
+
+	if(speed > APPROACH_MAX_SPEED) {
+		return APPROACH_MAX_SPEED;
+	}
+	if(speed < -APPROACH_MAX_SPEED) {
+		return -APPROACH_MAX_SPEED;
+	}
+	if(moving && abs(speed) < APPROACH_MIN_SPEED) {
+		return command < 0 ? -APPROACH_MIN_SPEED : APPROACH_MIN_SPEED;
+	}
+	return speed;
+}
+
+static void approachStart(Command *command) {
+	Approach *approach = (Approach *)command;
+
+	approach->startTime = approach->lastSeen = millis();
+	approach->settledSince = 0;
+	approach->reached = false;
+}
+
+static bool approachUpdate(Command *command) {
+	Approach *approach = (Approach *)command;
+	SensorSnapshot sensors;
+	int error, skew = 0;
+	int forward, turn = 0;
+	bool aligned = true;
+
+	sensorsGet(&sensors);
+	if(approach->timeout != 0 && sensors.time - approach->startTime >= approach->timeout) {
+		return true;
+	}
+
+	if(sensors.rangeLeft != RANGE_NONE && sensors.rangeRight != RANGE_NONE) {
+		error = (sensors.rangeLeft + sensors.rangeRight) / 2 - approach->distance;
+		//The farther side drives forward to square up
+		skew = sensors.rangeLeft - sensors.rangeRight;
+		aligned = abs(skew) <= APPROACH_TOLERANCE;
+		turn = approachDrive(APPROACH_TURN_KP * skew, !aligned);
+	} else if(sensors.rangeLeft != RANGE_NONE) {
+		error = sensors.rangeLeft - approach->distance;
+	} else if(sensors.rangeRight != RANGE_NONE) {
+		error = sensors.rangeRight - approach->distance;
+	} else {
+		motorGroupSet(&driveLeftMotors, 0);
+		motorGroupSet(&driveRightMotors, 0);
+		return sensors.time - approach->lastSeen >= APPROACH_LOST_TIME;
+	}
+	approach->lastSeen = sensors.time;
+
+	if(abs(error) <= APPROACH_TOLERANCE && aligned) {
+		if(approach->settledSince == 0) {
+			approach->settledSince = sensors.time;
+		}
+		if(sensors.time - approach->settledSince >= APPROACH_SETTLE_TIME) {
+			approach->reached = true;
+			return true;
+		}
+	} else {
+		approach->settledSince = 0;
+	}
+
+	forward = approachDrive(APPROACH_KP * error, abs(error) > APPROACH_TOLERANCE);
+	motorGroupSet(&driveLeftMotors, forward + turn);
+	motorGroupSet(&driveRightMotors, forward - turn);
+	return false;
+}
+
+static void approachEnd(Command *command, bool interrupted) {
+	motorGroupSet(&driveLeftMotors, 0);
+	motorGroupSet(&driveRightMotors, 0);
+}
+
+void approachInit(Approach *approach, int distance, unsigned long timeout) {
+	approach->command.name = "approach";
+	approach->command.requires = COMMAND_DRIVE;
+	approach->command.start = approachStart;
+	approach->command.update = approachUpdate;
+	approach->command.end = approachEnd;
+	approach->distance = distance;
+	approach->timeout = timeout;
+	approach->reached = false;
+}
@@ -0,0 +1,61 @@
+/** @file arena.c
+ * @brief Static memory arena for buffers sized at startup
+ */
+
+#include "main.h"
+#include <string.h>
+
+//Every block starts on this boundary, enough for any type on the Cortex-M3
+#define ARENA_ALIGN 8
+
+typedef struct {
+	const char *name;
+	unsigned int capacity;
+	const volatile unsigned int *peak;
+} Tracked;
+
+static unsigned char arena[ARENA_BYTES] __attribute__((aligned(ARENA_ALIGN)));
+static unsigned int used;
+static unsigned int failed;
+static bool locked;
+static Tracked tracked[ARENA_TRACKED];
+static unsigned int trackedCount;
+
+void *arenaAlloc(unsigned int bytes) {
+	void *block;
+
+	bytes = (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	if(locked || bytes > ARENA_BYTES - used) {
+		failed++;
+		return NULL;
+	}
+	block = &arena[used];
+	used += bytes;
+	memset(block, 0, bytes);
+	return block;
+}
+
+void arenaLock() {
+	locked = true;
+}
+
+void arenaTrack(const char *name, unsigned int capacity, const volatile unsigned int *peak) {
+	if(trackedCount < ARENA_TRACKED) {
+		tracked[trackedCount].name = name;
+		tracked[trackedCount].capacity = capacity;
+		tracked[trackedCount].peak = peak;
+		trackedCount++;
+	}
+}
+
+void arenaReport(FILE *stream) {
+	unsigned int i;
+
+	fprintf(stream, "{\"arenaBytes\":%u,\"usedBytes\":%u,\"failedAllocs\":%u,\"containers\":[",
+		ARENA_BYTES, used, failed);
+	for(i = 0; i < trackedCount; i++) {
+		fprintf(stream, "%s{\"name\":\"%s\",\"capacity\":%u,\"peak\":%u}", i == 0 ? "" : ",",
+			tracked[i].name, tracked[i].capacity, *tracked[i].peak);
+	}
+	fprintf(stream, "]}\r\n");
+}
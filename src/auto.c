@@ -33,6 +33,7 @@
  */
 
 #include "main.h"
+#include <string.h>
 
 /*
  * Runs the user autonomous code. This function will be started in its own task with the default
@@ -51,63 +52,144 @@
 
 
 
-//Motor Port Constants
-const int rightBackDrive = 10;
-const int rightFrontDrive = 9;
-const int rightLiftInner = 8;
-const int rightLiftOuter = 7;
-const int rightClaw = 6;
-const int leftClaw = 5;
-const int leftLiftOuter = 4;
-const int leftLiftInner = 3;
-const int leftFrontDrive = 2;
-const int leftBackDrive = 1;
-
 const int clawPot = 1;
 
+//scoreAndReturnStops: the legs of scoreCurve in drive ticks, 36 inches across and 48 up the
+//field, and a quarter turn on the spot, a quarter of the circle the 14 inch track turns on
+#define LEG_ACROSS 1031
+#define LEG_UP 1375
+#define QUARTER_TURN 315
+
 //////////////////////////
 // Function Prototypes	//
 //////////////////////////
 void move();
 void turn();
-void PID();
+void followPath();
+bool approach();
 void lift();
+void clawFor();
+static void turnRoutine();
+static void scoreAndReturn();
+static void scoreAndReturnStops();
+
+/**
+ * A routine autonomousRoutine() can run
+ */
+typedef struct {
+	const char *name;
+	void (*run)();
+} Routine;
+
+//Keep the routines in tools/autobudget.py in step with these, to check they still fit in the
+//autonomous period on a tired battery
+static const Routine routines[] = {
+	{"turn", turnRoutine},
+	{"scoreAndReturn", scoreAndReturn},
+	{"scoreAndReturnStops", scoreAndReturnStops}
+};
+
+#define ROUTINE_COUNT (sizeof(routines) / sizeof(routines[0]))
+
+//Picked before the match; the first routine runs until another is picked
+static const Routine *volatile selected = &routines[0];
 
 //lift globals
 int liftHeight;
-int currHeight;
-int liftSpeed;
 
 //Encoder Globals
-Encoder rEnc;
-Encoder lEnc;
-Encoder liftEnc;
 Encoder clawEnc;
 
 void autonomous() {
+	//The routine runs in the routine task, where the mode manager can stop it at any time
+	modeRoutineStart();
+}
 
-	lcdInit(uart1);
-	lcdSetBacklight(uart1, true);
+bool autonomousSelect(const char *name) {
+	unsigned int i;
 
-	//Initalize encoders if not already set
-	if(!lEnc){
-		lEnc = encoderInit(1, 2, 0);
-	}
-	if(!rEnc){
-		rEnc = encoderInit(3, 4, 0);
-	}
-	if(!liftEnc) {
-		liftEnc = encoderInit(5, 6, 0);
+	for(i = 0; i < ROUTINE_COUNT; i++) {
+		if(strcmp(routines[i].name, name) == 0) {
+			selected = &routines[i];
+			return true;
+		}
 	}
+	return false;
+}
 
-	//Reset after initialization
-	encoderReset(lEnc);
-	encoderReset(rEnc);
+const char *autonomousSelected() {
+	return selected->name;
+}
 
-	liftHeight = encoderGet(liftEnc);
+const char *autonomousName(unsigned int index) {
+	return index < ROUTINE_COUNT ? routines[index].name : NULL;
+}
+
+void autonomousRoutine() {
+	//Paths are planned from the starting pose
+	Pose start = {0, 0, 0};
+	SensorSnapshot sensors;
 
-	turn(50, 0);
+	odometryReset(&start);
+	yawReset(start.heading);
 
+	//The average of both sides of the lift
+	sensorsGet(&sensors);
+	liftHeight = sensors.liftTicks;
+
+	selected->run();
+}
+
+/**
+ * turnRoutine()
+ * Turns left on the spot.
+ */
+static void turnRoutine() {
+	turn(AUTO_TURN, 0);
+}
+
+/**
+ * scoreAndReturn()
+ * Scores the preload on the goal at the end of scoreCurve, then comes back past the start to
+ * pick up the next object.
+ */
+static void scoreAndReturn() {
+	//The lift rises on the control task while the path is followed
+	liftControlSet(MACRO_SCORE_HEIGHT);
+	followPath(&scoreCurve);
+	lift(MACRO_SCORE_HEIGHT);
+	approach(AUTO_SCORE_DISTANCE, AUTO_SCORE_TIMEOUT);
+	clawFor(-MACRO_GRAB_POWER, MACRO_RELEASE_TIME);
+	//backToStart leaves the way scoreCurve came, so turn around onto it first. The lift comes
+	//down meanwhile, and is waited for before closing on the next object
+	liftControlSet(MACRO_CARRY_HEIGHT);
+	turn(AUTO_TURN_AROUND, 1);
+	followPath(&backToStart);
+	move(AUTO_PICKUP_DISTANCE, 0);
+	lift(MACRO_CARRY_HEIGHT);
+	clawFor(MACRO_GRAB_POWER, MACRO_GRAB_TIME);
+}
+
+/**
+ * scoreAndReturnStops()
+ * scoreAndReturn driven the old way, along the legs of its paths with a stop to turn at each
+ * corner, kept to compare the two in tools/autosim.c.
+ */
+static void scoreAndReturnStops() {
+	liftControlSet(MACRO_SCORE_HEIGHT);
+	move(LEG_ACROSS, 0);
+	turn(QUARTER_TURN, 0);
+	move(LEG_UP, 0);
+	lift(MACRO_SCORE_HEIGHT);
+	approach(AUTO_SCORE_DISTANCE, AUTO_SCORE_TIMEOUT);
+	clawFor(-MACRO_GRAB_POWER, MACRO_RELEASE_TIME);
+	liftControlSet(MACRO_CARRY_HEIGHT);
+	turn(AUTO_TURN_AROUND, 1);
+	move(LEG_UP, 0);
+	turn(QUARTER_TURN, 1);
+	move(LEG_ACROSS + AUTO_PICKUP_DISTANCE, 0);
+	lift(MACRO_CARRY_HEIGHT);
+	clawFor(MACRO_GRAB_POWER, MACRO_GRAB_TIME);
 }
 
 /**
@@ -118,26 +200,66 @@ void autonomous() {
  * @param dir is direction 1 is left and 0 right default right
  */
 void turn(int dist, int dir){
-	encoderReset(lEnc);
-	encoderReset(rEnc);
+	SensorSnapshot sensors;
+	EncoderMark left;
+	EncoderMark right;
+
+	sensorsGet(&sensors);
+	sensorsMark(&left, SENSORS_LEFT, &sensors);
+	sensorsMark(&right, SENSORS_RIGHT, &sensors);
 	if(dir == 1){
-		motorSet(leftBackDrive, 110);
-		motorSet(rightBackDrive, 110);
-		motorSet(leftFrontDrive, 110);
-		motorSet(rightFrontDrive, 110);
+		motorGroupSet(&driveLeftMotors, calibration->drivePower);
+		motorGroupSet(&driveRightMotors, -calibration->drivePower);
 	} else if(dir !=  1) {
-		motorSet(leftBackDrive, -110);
-		motorSet(rightBackDrive, -110);
-		motorSet(leftFrontDrive, -110);
-		motorSet(rightFrontDrive, -110);
+		motorGroupSet(&driveLeftMotors, -calibration->drivePower);
+		motorGroupSet(&driveRightMotors, calibration->drivePower);
+	}
+	while(sensorsSinceMark(&left, &sensors) <= dist &&
+			sensorsSinceMark(&right, &sensors) <= dist && !modeRoutineAborted()){
+		delay(MODE_POLL);
+		sensorsGet(&sensors);
+	}
+	motorGroupSet(&driveLeftMotors, 0);
+	motorGroupSet(&driveRightMotors, 0);
+}
+
+/**
+ * followPath()
+ * Drives along a planned path without stopping, returning once the end is reached.
+ *
+ * @param path a path from paths.h, starting at the robot's current pose
+ */
+void followPath(const Path *path){
+	pathFollowStart(path);
+	while(!pathFollowDone() && !modeRoutineAborted()) {
+		delay(MODE_POLL);
+	}
+}
+
+/**
+ * approach()
+ * Drives up to the object in front of the ultrasonics and squares up to it, returning once
+ * the robot is there or the approach gives up.
+ *
+ * @param distance the distance to stop at in centimeters
+ * @param timeout the time limit in milliseconds
+ * @return true if the robot reached the object
+ */
+bool approach(int distance, unsigned long timeout){
+	//Static, as the scheduler holds it until it is done
+	static Approach command;
+
+	approachInit(&command, distance, timeout);
+	if(!commandSchedule(&command.command)) {
+		return false;
 	}
-	while(encoderGet(lEnc) <= dist && encoderGet(rEnc) <= dist){
-		lcdPrint(uart1, 1, "B:%d", encoderGet(lEnc));
+	while(!commandDone(&command.command)) {
+		if(modeRoutineAborted()) {
+			commandCancel(&command.command);
+		}
+		delay(MODE_POLL);
 	}
-	motorSet(leftBackDrive, 0);
-	motorSet(rightBackDrive, 0);
-	motorSet(leftFrontDrive, 0);
-	motorSet(rightFrontDrive, 0);
+	return command.reached;
 }
 
 /**
@@ -148,77 +270,64 @@ void turn(int dist, int dir){
  * @param reverse if set to 1, the robot reverses, otherwise it moves forward;
  */
 void move(int dist, int reverse){
-	encoderReset(lEnc);
-	encoderReset(rEnc);
+	SensorSnapshot sensors;
+	EncoderMark left;
+	EncoderMark right;
+
+	//Measured from here, leaving the counts to odometry
+	sensorsGet(&sensors);
+	sensorsMark(&left, SENSORS_LEFT, &sensors);
+	sensorsMark(&right, SENSORS_RIGHT, &sensors);
 
 	//Forward/Reverse statements
 	if(reverse == 1){ 	//Reverse
-		motorSet(leftBackDrive, -110);
-		motorSet(rightBackDrive, 110);
-		motorSet(leftFrontDrive, -110);
-		motorSet(rightFrontDrive, 110);
+		motorGroupSet(&driveLeftMotors, -calibration->drivePower);
+		motorGroupSet(&driveRightMotors, -calibration->drivePower);
 	}else {				//Forward
-		motorSet(leftBackDrive, 110);
-		motorSet(rightBackDrive, -110);
-		motorSet(leftFrontDrive, 110);
-		motorSet(rightFrontDrive, -110);
+		motorGroupSet(&driveLeftMotors, calibration->drivePower);
+		motorGroupSet(&driveRightMotors, calibration->drivePower);
 	}
 
 
 	//Run while distance is being traveled
-	while(encoderGet(lEnc) <= dist && encoderGet(rEnc) <= dist) {
-		lcdPrint(uart1, 1, "Left: %d", encoderGet(lEnc));
-		lcdPrint(uart1, 2, "Right: %d", encoderGet(rEnc));
+	while(sensorsSinceMark(&left, &sensors) <= dist &&
+			sensorsSinceMark(&right, &sensors) <= dist && !modeRoutineAborted()) {
+		delay(MODE_POLL);
+		sensorsGet(&sensors);
 	}
 
 	//Stop
-	motorSet(leftBackDrive, 0);
-	motorSet(rightBackDrive, 0);
-	motorSet(leftFrontDrive, 0);
-	motorSet(rightFrontDrive, 0);
+	motorGroupSet(&driveLeftMotors, 0);
+	motorGroupSet(&driveRightMotors, 0);
 }
 
 /**
- * PID()
- * Controls the lift through a PID funtion.
- * Insert into every user function
+ * clawFor()
+ * Runs the claw for a time, then stops it.
+ *
+ * @param speed the claw command; positive closes
+ * @param time how long to run it in milliseconds
  */
-void PID() {
-	currHeight = encoderGet(liftEnc);
-
-	if(currHeight < liftHeight){
+void clawFor(int speed, unsigned long time) {
+	unsigned long start = millis();
 
+	motorGroupSet(&clawMotors, speed);
+	while(millis() - start < time && !modeRoutineAborted()) {
+		delay(MODE_POLL);
 	}
+	motorGroupSet(&clawMotors, 0);
 }
 
 /**
  * lift()
- * Moves the lift, and changes the value that PID() uses to control the position
+ * Moves the lift to a height and returns once it is there; the lift controller keeps holding it
  *
  * @param height denotes the height, in encoder ticks, that the lift will go to.
  */
 void lift(int height) {
 	liftHeight = height;
-	if(encoderGet(liftEnc) < height) {
-		motorSet(leftLiftInner, 110);
-		motorSet(leftLiftOuter, -110);
-		motorSet(rightLiftInner, -110);
-		motorSet(rightLiftOuter, 110);
-		while(encoderGet(liftEnc) < height) {
-
-		}
-	} else if (encoderGet(liftEnc) > height) {
-		motorSet(leftLiftInner, -110);
-		motorSet(leftLiftOuter, 110);
-		motorSet(rightLiftInner, 110);
-		motorSet(rightLiftOuter, -110);
-		while(encoderGet(liftEnc) > height){
-
-		}
+	liftControlSet(height);
+	while(!liftControlAtTarget() && !modeRoutineAborted()) {
+		delay(MODE_POLL);
 	}
-
-	motorSet(leftLiftInner, 0);
-	motorSet(leftLiftOuter, 0);
-	motorSet(rightLiftInner, 0);
-	motorSet(rightLiftOuter, 0);
 }
@@ -0,0 +1,181 @@
+/** @file autotune.c
+ * @brief On-robot tuning of the lift and drive gains
+ */
+
+#include "main.h"
+
+//Lift relay: swing either side of the feedforward, and height above the start to tune at
+#define RELAY_AMPLITUDE 30
+#define RELAY_OFFSET 150
+//Relay cycles to let the oscillation settle, then cycles measured
+#define RELAY_SETTLE 3
+#define RELAY_MEASURE 5
+#define LIFT_TIMEOUT 20000
+
+//Drive steps: commands, how long each is held and the final part over which speed is measured
+#define STEP_LOW 40
+#define STEP_HIGH 100
+#define STEP_TIME 1500
+#define STEP_MEASURE 500
+
+/**
+ * aborted()
+ * @return true if either driver has moved a stick
+ */
+static bool aborted() {
+	unsigned char joystick;
+	int axis;
+
+	for(joystick = 1; joystick <= DRIVER_JOYSTICKS; joystick++) {
+		for(axis = 1; axis <= 4; axis++) {
+			if(isJoystickConnected(joystick) &&
+					abs(joystickGetAnalog(joystick, axis)) > calibration->deadzone) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool autotuneLift() {
+	SensorSnapshot sensors;
+	unsigned long start;
+	unsigned long wake;
+	unsigned long now;
+	unsigned long lastSwitch;
+	unsigned long highTime = 0;
+	unsigned long periodTotal = 0;
+	int swingTotal = 0;
+	int setpoint;
+	int bias = fixedToInt(calibration->gains.liftKg);
+	int peakHigh;
+	int peakLow;
+	int cycles = 0;
+	bool rising = true;
+	Fixed ultimate;
+	Fixed period;
+	Fixed kP;
+	Gains tuned = calibration->gains;
+
+	liftControlStop();
+	sensorsGet(&sensors);
+	setpoint = sensors.liftTicks + RELAY_OFFSET;
+	peakHigh = peakLow = sensors.liftTicks;
+	start = lastSwitch = wake = millis();
+
+	while(cycles < RELAY_SETTLE + RELAY_MEASURE) {
+		now = millis();
+		if(aborted() || now - start > LIFT_TIMEOUT) {
+			motorGroupSet(&liftMotors, 0);
+			return false;
+		}
+		sensorsGet(&sensors);
+		if(sensors.liftTicks > peakHigh) {
+			peakHigh = sensors.liftTicks;
+		}
+		if(sensors.liftTicks < peakLow) {
+			peakLow = sensors.liftTicks;
+		}
+
+		if(rising && sensors.liftTicks > setpoint) {
+			highTime = now - lastSwitch;
+			lastSwitch = now;
+			rising = false;
+		} else if(!rising && sensors.liftTicks < setpoint) {
+			//A full cycle; only count it once the oscillation has settled
+			if(cycles >= RELAY_SETTLE) {
+				swingTotal += peakHigh - peakLow;
+				periodTotal += highTime + now - lastSwitch;
+			}
+			//Re-center the relay until it spends as long rising as falling
+			bias += RELAY_AMPLITUDE * ((int)highTime - (int)(now - lastSwitch)) /
+				(int)(highTime + now - lastSwitch);
+			lastSwitch = now;
+			rising = true;
+			peakHigh = peakLow = sensors.liftTicks;
+			cycles++;
+		}
+
+		liftControlDrive(bias + (rising ? RELAY_AMPLITUDE : -RELAY_AMPLITUDE),
+			sensors.liftLeftTicks - sensors.liftRightTicks);
+		taskDelayUntil(&wake, CONTROL_PERIOD);
+	}
+
+	if(swingTotal <= 0 || periodTotal == 0) {
+		motorGroupSet(&liftMotors, 0);
+		return false;
+	}
+	//Ultimate gain 4d / (pi a) with a the half swing, and ultimate period in seconds
+	ultimate = fixedDiv(fixedFromInt(4 * RELAY_AMPLITUDE * 2 * RELAY_MEASURE),
+		fixedMul(FIXED_PI, fixedFromInt(swingTotal)));
+	period = fixedDiv(fixedFromInt(periodTotal / RELAY_MEASURE), fixedFromInt(1000));
+
+	//Classic Ziegler-Nichols PID
+	kP = fixedMul(ultimate, FIXED(0.6));
+	tuned.liftKp = kP;
+	tuned.liftKi = fixedDiv(2 * kP, period);
+	tuned.liftKd = fixedMul(kP, period) / 8;
+	tuned.liftKg = fixedFromInt(bias);
+	calibrationSetGains(&tuned);
+
+	//Hold against gravity until the caller takes the lift back
+	liftControlDrive(bias, sensors.liftLeftTicks - sensors.liftRightTicks);
+	return calibrationSave();
+}
+
+/**
+ * stepSpeed()
+ * Drives at a command for STEP_TIME and measures the speed over its end.
+ *
+ * @return the speed in inches per second, or a negative number if aborted
+ */
+static Fixed stepSpeed(int command) {
+	SensorSnapshot sensors;
+	SensorSnapshot from;
+	unsigned long start = millis();
+	bool measuring = false;
+
+	motorGroupSet(&driveLeftMotors, command);
+	motorGroupSet(&driveRightMotors, command);
+	while(millis() - start < STEP_TIME) {
+		if(aborted()) {
+			motorGroupSet(&driveLeftMotors, 0);
+			motorGroupSet(&driveRightMotors, 0);
+			return -1;
+		}
+		if(!measuring && millis() - start >= STEP_TIME - STEP_MEASURE) {
+			sensorsGet(&from);
+			measuring = true;
+		}
+		delay(CONTROL_PERIOD);
+	}
+	sensorsGet(&sensors);
+	motorGroupSet(&driveLeftMotors, 0);
+	motorGroupSet(&driveRightMotors, 0);
+	delay(STEP_MEASURE);
+
+	//Mean of both sides over the measuring window
+	return fixedDiv(abs(sensors.leftTicks + sensors.rightTicks - from.leftTicks -
+		from.rightTicks) / 2 * ODOMETRY_INCHES_PER_TICK,
+		fixedDiv(fixedFromInt(sensors.time - from.time), fixedFromInt(1000)));
+}
+
+bool autotuneDrive() {
+	Fixed low = stepSpeed(STEP_LOW);
+	Fixed high;
+	Gains tuned = calibration->gains;
+
+	if(low < 0 || aborted()) {
+		return false;
+	}
+	//Drive back so the robot ends near where it started
+	high = stepSpeed(-STEP_HIGH);
+	if(high <= low) {
+		return false;
+	}
+
+	tuned.driveKv = fixedDiv(fixedFromInt(STEP_HIGH - STEP_LOW), high - low);
+	tuned.driveKs = fixedFromInt(STEP_LOW) - fixedMul(tuned.driveKv, low);
+	calibrationSetGains(&tuned);
+	return calibrationSave();
+}
@@ -0,0 +1,384 @@
+/** @file calibration.c
+ * @brief Robot calibration, stored in flash
+ */
+
+#include "main.h"
+#include <stddef.h>
+#include <string.h>
+
+//Marks the start of a calibration record
+#define CALIBRATION_MAGIC 0x43414C42
+//Time without a button press after which the LCD editor closes
+#define EDIT_TIMEOUT 10000
+
+//Kinds of field
+#define FIELD_FIXED 0
+#define FIELD_INT 1
+#define FIELD_PORT 2
+
+typedef struct {
+	unsigned int magic;
+	unsigned short version;
+	//Bytes of Calibration stored after the header
+	unsigned short length;
+} RecordHeader;
+
+typedef struct {
+	const char *name;
+	unsigned short offset;
+	unsigned char kind;
+	//Range and LCD step, raw Fixed values for FIELD_FIXED
+	int min;
+	int max;
+	int step;
+} CalibrationField;
+
+#define PORT_FIELD(name) \
+	{#name, offsetof(Calibration, ports[name - 1]), FIELD_PORT, 1, MOTOR_PORTS, 1}
+#define JOYSTICK_FIELD(name, mechanism) \
+	{#name, offsetof(Calibration, joysticks[mechanism]), FIELD_INT, DRIVER_EITHER, \
+		DRIVER_JOYSTICKS, 1}
+
+static const CalibrationField fields[] = {
+	{"liftKp", offsetof(Calibration, gains.liftKp), FIELD_FIXED, 0, FIXED(10.0), FIXED(0.01)},
+	{"liftKi", offsetof(Calibration, gains.liftKi), FIELD_FIXED, 0, FIXED(10.0), FIXED(0.01)},
+	{"liftKd", offsetof(Calibration, gains.liftKd), FIELD_FIXED, 0, FIXED(10.0), FIXED(0.005)},
+	{"liftKg", offsetof(Calibration, gains.liftKg), FIELD_FIXED, FIXED(-127.0), FIXED(127.0),
+		FIXED(1.0)},
+	{"driveKs", offsetof(Calibration, gains.driveKs), FIELD_FIXED, 0, FIXED(127.0), FIXED(0.5)},
+	{"driveKv", offsetof(Calibration, gains.driveKv), FIELD_FIXED, 0, FIXED(127.0), FIXED(0.05)},
+	{"deadzone", offsetof(Calibration, deadzone), FIELD_INT, 0, 60, 1},
+	{"drivePower", offsetof(Calibration, drivePower), FIELD_INT, 0, 127, 5},
+	PORT_FIELD(leftBackDrive),
+	PORT_FIELD(leftFrontDrive),
+	PORT_FIELD(leftLiftInner),
+	PORT_FIELD(leftLiftOuter),
+	PORT_FIELD(leftClaw),
+	PORT_FIELD(rightClaw),
+	PORT_FIELD(rightLiftOuter),
+	PORT_FIELD(rightLiftInner),
+	PORT_FIELD(rightFrontDrive),
+	PORT_FIELD(rightBackDrive),
+	{"gyroScale", offsetof(Calibration, gyroScale), FIELD_FIXED, FIXED(-100.0), FIXED(100.0),
+		FIXED(0.1)},
+	JOYSTICK_FIELD(driveJoystick, DRIVER_DRIVE),
+	JOYSTICK_FIELD(liftJoystick, DRIVER_LIFT),
+	JOYSTICK_FIELD(clawJoystick, DRIVER_CLAW),
+	{"liftSensor", offsetof(Calibration, liftSensor), FIELD_INT, LIFT_SENSOR_NONE,
+		LIFT_SENSOR_ENCODER, 1},
+	{"liftPotScale", offsetof(Calibration, liftPotScale), FIELD_FIXED, FIXED(-1.0), FIXED(1.0),
+		FIXED(0.005)},
+	{"liftSyncKp", offsetof(Calibration, liftSyncKp), FIELD_FIXED, 0, FIXED(10.0), FIXED(0.1)},
+	{"brownoutClaw", offsetof(Calibration, brownoutClaw), FIELD_INT, 4000, 8000, 50},
+	{"brownoutLift", offsetof(Calibration, brownoutLift), FIELD_INT, 4000, 8000, 50},
+	{"brownoutDrive", offsetof(Calibration, brownoutDrive), FIELD_INT, 4000, 8000, 50},
+	{"brownoutHorizon", offsetof(Calibration, brownoutHorizon), FIELD_INT, 0, 1000, 10}
+};
+
+#define FIELD_COUNT (sizeof(fields) / sizeof(fields[0]))
+
+//Starting values for an untuned robot, with each motor on the port of the same number. The
+//gyro scale is the 1.1 mV per degree per second of the VEX gyro on the 5 V, 12-bit ADC. The
+//partner joystick runs the lift and claw, which fall back to joystick 1 without it. The lift
+//has no right side sensor until one is fitted; the potentiometer scale is its 250 degrees over
+//4096 counts, on the same shaft as the 360 tick per turn lift encoder. The Cortex resets at
+//about 5.5 V on the main battery, so the last brownout stage is shed a little above that.
+#define CALIBRATION_DEFAULTS { \
+	{ \
+		FIXED(0.5), FIXED(0.2), FIXED(0.02), FIXED(15.0), \
+		FIXED(12.0), FIXED(5.75) \
+	}, \
+	20, \
+	110, \
+	{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}, \
+	FIXED(14.4), \
+	{1, 2, 2}, \
+	LIFT_SENSOR_NONE, \
+	FIXED(0.061), \
+	FIXED(1.0), \
+	6200, \
+	5900, \
+	5700, \
+	150 \
+}
+
+static const Calibration defaults = CALIBRATION_DEFAULTS;
+static Calibration live = CALIBRATION_DEFAULTS;
+
+const Calibration *const calibration = &live;
+
+//LCD editor state, only touched by the display task
+static bool editing;
+static bool edited;
+static unsigned int editField;
+static unsigned int lastButtons;
+static unsigned long lastPress;
+
+/**
+ * crc32()
+ * Continues a CRC-32 (the zlib polynomial) over a block of bytes. The record is small and only
+ * checked at boot, so the bitwise form is used instead of a table.
+ *
+ * @param crc the CRC so far, 0 to start
+ * @return the CRC including the block
+ */
+static unsigned int crc32(unsigned int crc, const void *data, unsigned int length) {
+	const unsigned char *bytes = data;
+	int bit;
+
+	crc = ~crc;
+	while(length-- > 0) {
+		crc ^= *bytes++;
+		for(bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+/**
+ * fieldValue()
+ * @return a pointer to the field in the live record
+ */
+static void *fieldValue(const CalibrationField *field) {
+	return (char *)&live + field->offset;
+}
+
+static int fieldGet(const CalibrationField *field) {
+	if(field->kind == FIELD_PORT) {
+		return *(unsigned char *)fieldValue(field);
+	}
+	return *(int *)fieldValue(field);
+}
+
+static void fieldPut(const CalibrationField *field, int value) {
+	if(value < field->min) {
+		value = field->min;
+	}
+	if(value > field->max) {
+		value = field->max;
+	}
+	if(field->kind == FIELD_PORT) {
+		*(unsigned char *)fieldValue(field) = (unsigned char)value;
+	} else {
+		*(int *)fieldValue(field) = value;
+	}
+}
+
+/**
+ * fieldFormat()
+ * Writes a field value as text, gains with three decimal places.
+ */
+static void fieldFormat(char *buffer, size_t size, const CalibrationField *field) {
+	int value = fieldGet(field);
+	unsigned int thousandths;
+
+	if(field->kind != FIELD_FIXED) {
+		snprintf(buffer, size, "%d", value);
+		return;
+	}
+	thousandths = (unsigned int)(((long long)abs(value) * 1000 + FIXED_ONE / 2) >> 16);
+	snprintf(buffer, size, "%s%u.%03u", value < 0 ? "-" : "", thousandths / 1000,
+		thousandths % 1000);
+}
+
+/**
+ * recordValid()
+ * @return true if every field of a record is inside its range and no two motors share a port
+ */
+static bool recordValid(const Calibration *record) {
+	const CalibrationField *field;
+	bool used[MOTOR_PORTS] = {false};
+	int value;
+	unsigned int i;
+
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		if(record->ports[i] >= 1 && record->ports[i] <= MOTOR_PORTS) {
+			if(used[record->ports[i] - 1]) {
+				return false;
+			}
+			used[record->ports[i] - 1] = true;
+		}
+	}
+	for(i = 0; i < FIELD_COUNT; i++) {
+		field = &fields[i];
+		if(field->kind == FIELD_PORT) {
+			value = *((const unsigned char *)record + field->offset);
+		} else {
+			value = *(const int *)((const char *)record + field->offset);
+		}
+		if(value < field->min || value > field->max) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void calibrationLoad() {
+	RecordHeader header;
+	Calibration stored = defaults;
+	unsigned int crc;
+	unsigned int storedCrc;
+	FILE *file = fopen(CALIBRATION_FILE, "r");
+
+	if(file == NULL) {
+		return;
+	}
+	if(fread(&header, sizeof(header), 1, file) == 1 && header.magic == CALIBRATION_MAGIC &&
+			header.version <= CALIBRATION_VERSION && header.length <= sizeof(stored) &&
+			fread(&stored, 1, header.length, file) == header.length &&
+			fread(&storedCrc, sizeof(storedCrc), 1, file) == 1) {
+		crc = crc32(crc32(0, &header, sizeof(header)), &stored, header.length);
+		if(crc == storedCrc && recordValid(&stored)) {
+			live = stored;
+		}
+	}
+	fclose(file);
+}
+
+bool calibrationSave() {
+	RecordHeader header = {CALIBRATION_MAGIC, CALIBRATION_VERSION, sizeof(Calibration)};
+	Calibration record = live;
+	unsigned int crc = crc32(crc32(0, &header, sizeof(header)), &record, sizeof(record));
+	FILE *file;
+	bool written;
+
+	//Saved as it would be loaded, so a port map edited halfway through a swap is not kept
+	if(!recordValid(&record)) {
+		return false;
+	}
+	file = fopen(CALIBRATION_FILE, "w");
+	if(file == NULL) {
+		return false;
+	}
+	written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(&record, sizeof(record), 1, file) == 1 &&
+		fwrite(&crc, sizeof(crc), 1, file) == 1;
+	fclose(file);
+	return written;
+}
+
+void calibrationSetGains(const Gains *gains) {
+	live.gains = *gains;
+}
+
+unsigned int calibrationFieldCount() {
+	return FIELD_COUNT;
+}
+
+int calibrationFieldFind(const char *name) {
+	unsigned int i;
+
+	for(i = 0; i < FIELD_COUNT; i++) {
+		if(strcmp(fields[i].name, name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool calibrationFieldSet(unsigned int index, const char *text) {
+	const CalibrationField *field;
+	bool negative = false;
+	bool digits = false;
+	long long whole = 0;
+	int fraction = 0;
+	int scale = 1;
+
+	if(index >= FIELD_COUNT) {
+		return false;
+	}
+	field = &fields[index];
+	if(*text == '-' || *text == '+') {
+		negative = *text++ == '-';
+	}
+	while(*text >= '0' && *text <= '9') {
+		//Anything this large is clamped to the range anyway
+		if(whole < 100000) {
+			whole = whole * 10 + (*text - '0');
+		}
+		text++;
+		digits = true;
+	}
+	if(*text == '.' && field->kind == FIELD_FIXED) {
+		text++;
+		while(*text >= '0' && *text <= '9') {
+			if(scale < 10000) {
+				fraction = fraction * 10 + (*text - '0');
+				scale *= 10;
+			}
+			text++;
+			digits = true;
+		}
+	}
+	if(!digits || (*text != '\0' && *text != '\r' && *text != '\n' && *text != ' ')) {
+		return false;
+	}
+
+	if(field->kind == FIELD_FIXED) {
+		whole = (whole << 16) + ((long long)fraction << 16) / scale;
+	}
+	if(whole > FIXED_MAX) {
+		whole = FIXED_MAX;
+	}
+	fieldPut(field, negative ? -(int)whole : (int)whole);
+	return true;
+}
+
+void calibrationPrint(FILE *stream) {
+	char value[16];
+	unsigned int i;
+
+	for(i = 0; i < FIELD_COUNT; i++) {
+		fieldFormat(value, sizeof(value), &fields[i]);
+		fprintf(stream, "%s %s\r\n", fields[i].name, value);
+	}
+}
+
+bool calibrationLcdEdit(FILE *lcdPort) {
+	const CalibrationField *field;
+	char value[16];
+	unsigned int buttons = lcdReadButtons(lcdPort);
+	unsigned int pressed = buttons & ~lastButtons;
+	unsigned long now = millis();
+
+	lastButtons = buttons;
+	if(pressed != 0) {
+		lastPress = now;
+	}
+	if(!editing) {
+		if(!(pressed & LCD_BTN_CENTER)) {
+			return false;
+		}
+		editing = true;
+		edited = false;
+		editField = 0;
+		pressed = 0;
+	}
+
+	field = &fields[editField];
+	if(pressed & LCD_BTN_LEFT) {
+		fieldPut(field, fieldGet(field) - field->step);
+		edited = true;
+	}
+	if(pressed & LCD_BTN_RIGHT) {
+		fieldPut(field, fieldGet(field) + field->step);
+		edited = true;
+	}
+	if(pressed & LCD_BTN_CENTER) {
+		editField++;
+	}
+	if(editField >= FIELD_COUNT || now - lastPress > EDIT_TIMEOUT) {
+		editing = false;
+		if(edited && !calibrationSave()) {
+			displayStatus("Save failed");
+		}
+		return false;
+	}
+
+	field = &fields[editField];
+	fieldFormat(value, sizeof(value), field);
+	lcdSetText(lcdPort, 1, field->name);
+	lcdPrint(lcdPort, 2, "<  %s  >", value);
+	return true;
+}
@@ -0,0 +1,137 @@
+/** @file command.c
+ * @brief Non-blocking command scheduler
+ */
+
+#include "main.h"
+
+//Stops the compiler moving a state change across a slot change; one core needs no more
+#define barrier() __asm__ volatile("" ::: "memory")
+
+//Filled by commandSchedule() and emptied only by the control task
+static Command *volatile slots[COMMAND_SLOTS];
+//Serializes commandSchedule() between tasks; the control task never takes it
+static Mutex scheduleLock;
+static volatile bool cancelAll;
+
+/**
+ * commandEnd()
+ * Ends a started command and frees its slot.
+ */
+static void commandEnd(unsigned int slot, bool interrupted) {
+	Command *command = slots[slot];
+
+	if(command->state == COMMAND_RUNNING && command->end != NULL) {
+		command->end(command, interrupted);
+	}
+	slots[slot] = NULL;
+	barrier();
+	command->state = interrupted ? COMMAND_INTERRUPTED : COMMAND_FINISHED;
+}
+
+void commandInit() {
+	scheduleLock = mutexCreate();
+}
+
+bool commandSchedule(Command *command) {
+	unsigned int i;
+	bool scheduled = false;
+
+	mutexTake(scheduleLock, -1);
+	if(command->state == COMMAND_PENDING || command->state == COMMAND_RUNNING) {
+		scheduled = true;
+	} else {
+		for(i = 0; i < COMMAND_SLOTS && !scheduled; i++) {
+			if(slots[i] == NULL) {
+				command->cancelRequested = false;
+				command->state = COMMAND_PENDING;
+				barrier();
+				slots[i] = command;
+				scheduled = true;
+			}
+		}
+	}
+	mutexGive(scheduleLock);
+	return scheduled;
+}
+
+void commandCancel(Command *command) {
+	command->cancelRequested = true;
+}
+
+void commandCancelAll() {
+	cancelAll = true;
+}
+
+bool commandDone(const Command *command) {
+	return command->state != COMMAND_PENDING && command->state != COMMAND_RUNNING;
+}
+
+unsigned char commandRequired() {
+	Command *command;
+	unsigned char requires = 0;
+	unsigned int i;
+
+	for(i = 0; i < COMMAND_SLOTS; i++) {
+		command = slots[i];
+		if(command != NULL) {
+			requires |= command->requires;
+		}
+	}
+	return requires;
+}
+
+void commandUpdate() {
+	Command *command;
+	unsigned int i, j;
+	bool all = cancelAll;
+
+	cancelAll = false;
+	for(i = 0; i < COMMAND_SLOTS; i++) {
+		command = slots[i];
+		if(command != NULL && (all || command->cancelRequested)) {
+			commandEnd(i, true);
+		}
+	}
+
+	//Start new commands, interrupting the ones they take a mechanism from
+	for(i = 0; i < COMMAND_SLOTS; i++) {
+		command = slots[i];
+		if(command == NULL || command->state != COMMAND_PENDING) {
+			continue;
+		}
+		for(j = 0; j < COMMAND_SLOTS; j++) {
+			if(slots[j] != NULL && slots[j]->state == COMMAND_RUNNING &&
+					(slots[j]->requires & command->requires) != 0) {
+				commandEnd(j, true);
+			}
+		}
+		if(command->start != NULL) {
+			command->start(command);
+		}
+		command->state = COMMAND_RUNNING;
+	}
+
+	for(i = 0; i < COMMAND_SLOTS; i++) {
+		command = slots[i];
+		if(command != NULL && command->state == COMMAND_RUNNING && command->update(command)) {
+			commandEnd(i, false);
+		}
+	}
+}
+
+void commandReport(FILE *stream) {
+	Command *command;
+	unsigned int i;
+	bool first = true;
+
+	fprintf(stream, "{\"commands\":[");
+	for(i = 0; i < COMMAND_SLOTS; i++) {
+		command = slots[i];
+		if(command != NULL) {
+			fprintf(stream, "%s{\"name\":\"%s\",\"running\":%s}", first ? "" : ",",
+				command->name, command->state == COMMAND_RUNNING ? "true" : "false");
+			first = false;
+		}
+	}
+	fprintf(stream, "]}\r\n");
+}
@@ -0,0 +1,191 @@
+/** @file containers.c
+ * @brief Fixed-capacity containers with storage from the arena
+ */
+
+#include "main.h"
+#include <string.h>
+
+//Stops the compiler moving item accesses across an index update; one core needs no more
+#define barrier() __asm__ volatile("" ::: "memory")
+
+//Pool blocks hold a pointer while free and start on a word boundary
+#define BLOCK_ALIGN (sizeof(void *))
+
+bool ringInit(Ring *ring, const char *name, unsigned int size, unsigned int capacity) {
+	ring->size = size;
+	ring->capacity = capacity;
+	ring->head = ring->tail = ring->peak = 0;
+	if(capacity == 0 || (capacity & (capacity - 1)) != 0) {
+		ring->data = NULL;
+		return false;
+	}
+	ring->data = arenaAlloc(size * capacity);
+	if(ring->data == NULL) {
+		return false;
+	}
+	arenaTrack(name, capacity, &ring->peak);
+	return true;
+}
+
+bool ringPush(Ring *ring, const void *item) {
+	unsigned int head = ring->head;
+	unsigned int count = head - ring->tail;
+
+	if(ring->data == NULL || count >= ring->capacity) {
+		return false;
+	}
+	memcpy(ring->data + (head & (ring->capacity - 1)) * ring->size, item, ring->size);
+	barrier();
+	ring->head = head + 1;
+	if(count + 1 > ring->peak) {
+		ring->peak = count + 1;
+	}
+	return true;
+}
+
+bool ringPop(Ring *ring, void *item) {
+	unsigned int tail = ring->tail;
+
+	if(tail == ring->head) {
+		return false;
+	}
+	barrier();
+	memcpy(item, ring->data + (tail & (ring->capacity - 1)) * ring->size, ring->size);
+	barrier();
+	ring->tail = tail + 1;
+	return true;
+}
+
+unsigned int ringCount(const Ring *ring) {
+	return ring->head - ring->tail;
+}
+
+bool seqlockInit(Seqlock *lock, unsigned int size) {
+	lock->size = size;
+	lock->sequence = lock->retries = 0;
+	lock->data = arenaAlloc(2 * size);
+	return lock->data != NULL;
+}
+
+void seqlockWrite(Seqlock *lock, const void *value) {
+	unsigned int sequence = lock->sequence + 1;
+
+	if(lock->data == NULL) {
+		return;
+	}
+	memcpy(lock->data + (sequence & 1) * lock->size, value, lock->size);
+	barrier();
+	lock->sequence = sequence;
+}
+
+void seqlockRead(Seqlock *lock, void *value) {
+	unsigned int sequence;
+
+	if(lock->data == NULL) {
+		memset(value, 0, lock->size);
+		return;
+	}
+	while(1) {
+		sequence = lock->sequence;
+		barrier();
+		memcpy(value, lock->data + (sequence & 1) * lock->size, lock->size);
+		barrier();
+		//Any finished write may have been followed by one into the copy just read
+		if(lock->sequence == sequence) {
+			return;
+		}
+		lock->retries++;
+	}
+}
+
+bool vectorInit(SmallVector *vector, const char *name, unsigned int size,
+		unsigned int capacity) {
+	vector->size = size;
+	vector->capacity = capacity;
+	vector->count = vector->peak = 0;
+	vector->data = arenaAlloc(size * capacity);
+	if(vector->data == NULL) {
+		vector->capacity = 0;
+		return false;
+	}
+	arenaTrack(name, capacity, &vector->peak);
+	return true;
+}
+
+bool vectorPush(SmallVector *vector, const void *item) {
+	if(vector->count >= vector->capacity) {
+		return false;
+	}
+	memcpy(vector->data + vector->count * vector->size, item, vector->size);
+	vector->count++;
+	if(vector->count > vector->peak) {
+		vector->peak = vector->count;
+	}
+	return true;
+}
+
+void *vectorAt(const SmallVector *vector, unsigned int index) {
+	if(index >= vector->count) {
+		return NULL;
+	}
+	return vector->data + index * vector->size;
+}
+
+void vectorRemove(SmallVector *vector, unsigned int index) {
+	if(index >= vector->count) {
+		return;
+	}
+	vector->count--;
+	memmove(vector->data + index * vector->size, vector->data + (index + 1) * vector->size,
+		(vector->count - index) * vector->size);
+}
+
+void vectorClear(SmallVector *vector) {
+	vector->count = 0;
+}
+
+bool poolInit(Pool *pool, const char *name, unsigned int size, unsigned int capacity) {
+	unsigned int i;
+
+	size = (size + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+	pool->size = size;
+	pool->capacity = capacity;
+	pool->used = pool->peak = 0;
+	pool->free = NULL;
+	pool->data = arenaAlloc(size * capacity);
+	if(pool->data == NULL) {
+		pool->capacity = 0;
+		return false;
+	}
+	//Link the blocks so the first one is handed out first
+	for(i = capacity; i > 0; i--) {
+		*(void **)(pool->data + (i - 1) * size) = pool->free;
+		pool->free = pool->data + (i - 1) * size;
+	}
+	arenaTrack(name, capacity, &pool->peak);
+	return true;
+}
+
+void *poolAlloc(Pool *pool) {
+	void *block = pool->free;
+
+	if(block == NULL) {
+		return NULL;
+	}
+	pool->free = *(void **)block;
+	memset(block, 0, pool->size);
+	pool->used++;
+	if(pool->used > pool->peak) {
+		pool->peak = pool->used;
+	}
+	return block;
+}
+
+void poolFree(Pool *pool, void *block) {
+	if(block == NULL) {
+		return;
+	}
+	*(void **)block = pool->free;
+	pool->free = block;
+	pool->used--;
+}
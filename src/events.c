@@ -0,0 +1,49 @@
+/** @file events.c
+ * @brief Hardware events from interrupt handlers
+ */
+
+#include "main.h"
+
+//Filled by the interrupt handlers, which do not nest, and emptied by the control task
+static Ring queue;
+static volatile unsigned int dropped;
+
+/**
+ * liftLimitPressed()
+ * Interrupt handler for the lift limit switch, which pulls its port low when pressed.
+ */
+static void liftLimitPressed(unsigned char pin) {
+	Event event;
+
+	event.time = millis();
+	event.type = EVENT_LIFT_LIMIT;
+	event.port = pin;
+	if(!ringPush(&queue, &event)) {
+		dropped++;
+	}
+}
+
+void eventsInit() {
+	ringInit(&queue, "events", sizeof(Event), EVENTS_QUEUE);
+	//A right lift encoder takes the switch's port
+	if(calibration->liftSensor != LIFT_SENSOR_ENCODER) {
+		pinMode(EVENTS_LIFT_LIMIT_PORT, INPUT);
+		ioSetInterrupt(EVENTS_LIFT_LIMIT_PORT, INTERRUPT_EDGE_FALLING, liftLimitPressed);
+	}
+}
+
+void eventsDispatch() {
+	Event event;
+
+	while(ringPop(&queue, &event)) {
+		switch(event.type) {
+		case EVENT_LIFT_LIMIT:
+			liftControlLimit();
+			break;
+		}
+	}
+}
+
+unsigned int eventsDropped() {
+	return dropped;
+}
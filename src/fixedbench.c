@@ -0,0 +1,155 @@
+/** @file fixedbench.c
+ * @brief Cycle counts of the fixed-point routines against the soft-float ones
+ *
+ * Kept out of fixed.c so the host tools that link it need no PROS timer. Each routine runs
+ * FIXED_BENCH_CALLS times through a function pointer, from volatile inputs so nothing is folded
+ * away, and the best of FIXED_BENCH_RUNS runs is kept so a task switch during one does not
+ * count. The cost of the loop and the call, timed the same way, is taken off both.
+ */
+
+#include "main.h"
+#include <math.h>
+
+//Calls per timed run, and runs each routine is timed over
+#define FIXED_BENCH_CALLS 200
+#define FIXED_BENCH_RUNS 5
+//Core clock of the Cortex-M3 in MHz
+#define CPU_MHZ 72
+
+typedef struct {
+	const char *name;
+	Fixed (*fixed)(Fixed a, Fixed b);
+	float (*soft)(float a, float b);
+} BenchOp;
+
+static volatile Fixed fixedA = FIXED(0.7);
+static volatile Fixed fixedB = FIXED(1.3);
+static volatile float floatA = 0.7;
+static volatile float floatB = 1.3;
+static volatile Fixed fixedSink;
+static volatile float floatSink;
+
+static Fixed fixedNone(Fixed a, Fixed b) {
+	return a;
+}
+
+static Fixed fixedSinOp(Fixed a, Fixed b) {
+	return fixedSin(a);
+}
+
+static Fixed fixedCosOp(Fixed a, Fixed b) {
+	return fixedCos(a);
+}
+
+static Fixed fixedSqrtOp(Fixed a, Fixed b) {
+	return fixedSqrt(a);
+}
+
+static float floatNone(float a, float b) {
+	return a;
+}
+
+static float floatAdd(float a, float b) {
+	return a + b;
+}
+
+static float floatMul(float a, float b) {
+	return a * b;
+}
+
+static float floatDiv(float a, float b) {
+	return a / b;
+}
+
+static float floatSqrt(float a, float b) {
+	return sqrtf(a);
+}
+
+static float floatSin(float a, float b) {
+	return sinf(a);
+}
+
+static float floatCos(float a, float b) {
+	return cosf(a);
+}
+
+static float floatAtan2(float a, float b) {
+	return atan2f(a, b);
+}
+
+static const BenchOp benchOps[] = {
+	{"add", fixedAdd, floatAdd},
+	{"mul", fixedMul, floatMul},
+	{"div", fixedDiv, floatDiv},
+	{"sqrt", fixedSqrtOp, floatSqrt},
+	{"sin", fixedSinOp, floatSin},
+	{"cos", fixedCosOp, floatCos},
+	{"atan2", fixedAtan2, floatAtan2}
+};
+
+/**
+ * timeFixed()
+ * @return the fewest microseconds FIXED_BENCH_CALLS calls of a fixed-point routine took
+ */
+static unsigned long timeFixed(Fixed (*op)(Fixed a, Fixed b)) {
+	unsigned long best = 0xFFFFFFFF;
+	unsigned long start, elapsed;
+	unsigned int run, i;
+
+	for(run = 0; run < FIXED_BENCH_RUNS; run++) {
+		start = micros();
+		for(i = 0; i < FIXED_BENCH_CALLS; i++) {
+			fixedSink = op(fixedA, fixedB);
+		}
+		elapsed = micros() - start;
+		if(elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+/**
+ * timeSoft()
+ * @return the fewest microseconds FIXED_BENCH_CALLS calls of a soft-float routine took
+ */
+static unsigned long timeSoft(float (*op)(float a, float b)) {
+	unsigned long best = 0xFFFFFFFF;
+	unsigned long start, elapsed;
+	unsigned int run, i;
+
+	for(run = 0; run < FIXED_BENCH_RUNS; run++) {
+		start = micros();
+		for(i = 0; i < FIXED_BENCH_CALLS; i++) {
+			floatSink = op(floatA, floatB);
+		}
+		elapsed = micros() - start;
+		if(elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+/**
+ * cyclesPerCall()
+ * @return the cycles one call took from a run's time less the loop's own
+ */
+static long cyclesPerCall(unsigned long elapsed, unsigned long overhead) {
+	return ((long)elapsed - (long)overhead) * CPU_MHZ / FIXED_BENCH_CALLS;
+}
+
+void fixedBenchmark(FILE *stream) {
+	unsigned long fixedOverhead = timeFixed(fixedNone);
+	unsigned long softOverhead = timeSoft(floatNone);
+	unsigned int i;
+
+	fprintf(stream, "{\"cpuMhz\":%d,\"calls\":%d,\"ops\":[", CPU_MHZ, FIXED_BENCH_CALLS);
+	for(i = 0; i < sizeof(benchOps) / sizeof(benchOps[0]); i++) {
+		fprintf(stream, "%s{\"name\":\"%s\",\"fixedCycles\":%ld,\"softCycles\":%ld}",
+			i == 0 ? "" : ",", benchOps[i].name,
+			cyclesPerCall(timeFixed(benchOps[i].fixed), fixedOverhead),
+			cyclesPerCall(timeSoft(benchOps[i].soft), softOverhead));
+	}
+	fprintf(stream, "]}\r\n");
+}
@@ -43,6 +43,7 @@
  * configure a UART port (usartOpen()) but cannot set up an LCD (lcdInit()).
  */
 void initializeIO() {
+	telemetryInit();
 }
 
 /*
@@ -59,4 +60,18 @@ void initializeIO() {
  * can be implemented in this task if desired.
  */
 void initialize() {
+	Pose start = {0, 0, 0};
+
+	calibrationLoad();
+	sensorsInit();
+	odometryInit();
+	liftControlInit();
+	eventsInit();
+	replayInit();
+	commandInit();
+	modeInit();
+	odometryReset(&start);
+	tasksStart();
+	//Everything is set up; nothing allocates from here on
+	arenaLock();
 }
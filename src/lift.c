@@ -0,0 +1,154 @@
+/** @file lift.c
+ * @brief Lift position controller
+ */
+
+#include "main.h"
+
+/**
+ * A setpoint change sent to the control task
+ */
+typedef struct {
+	bool active;
+	int target;
+} LiftRequest;
+
+//Filled by the task commanding the lift and emptied by the control task
+static Ring requests;
+//Written by the commanding task only
+static unsigned int requested;
+//Written by the driver's task only
+static volatile unsigned int releases;
+
+//Owned by the control task
+static Pid pid;
+static ProfileSection pidProfile = PROFILE_SECTION("liftPid");
+static volatile bool active;
+static int target;
+static bool holding;
+static unsigned int releasesSeen;
+static volatile unsigned int applied;
+static volatile bool atTarget;
+
+/**
+ * liftControlRequest()
+ * Queues a setpoint change for the control task.
+ */
+static void liftControlRequest(bool start, int height) {
+	LiftRequest request = {start, height};
+
+	if(ringPush(&requests, &request)) {
+		requested++;
+	}
+}
+
+void liftControlInit() {
+	ringInit(&requests, "lift", sizeof(LiftRequest), LIFT_REQUESTS);
+}
+
+void liftControlSet(int height) {
+	liftControlRequest(true, height);
+}
+
+void liftControlStop() {
+	liftControlRequest(false, 0);
+}
+
+void liftControlRelease() {
+	releases++;
+}
+
+void liftControlHold() {
+	holding = true;
+}
+
+bool liftControlActive() {
+	return active;
+}
+
+bool liftControlAtTarget() {
+	//Not there until the control task has seen the latest setpoint
+	return applied == requested && atTarget;
+}
+
+void liftControlLimit() {
+	SensorSnapshot sensors;
+
+	//Stop driving into the bottom stop; the next setpoint takes over again
+	sensorsGet(&sensors);
+	if(active && target < sensors.liftTicks) {
+		target = sensors.liftTicks;
+	}
+}
+
+int liftControlOutput(Pid *pid, int target, int height, unsigned long elapsed) {
+	telemetrySet(TELEMETRY_LIFT_TARGET, target);
+	return pidStep(pid, target - height, fixedToInt(calibration->gains.liftKg), elapsed);
+}
+
+void liftControlDrive(int output, int twist) {
+	int correction = 0;
+
+	if(calibration->liftSensor != LIFT_SENSOR_NONE && abs(twist) <= LIFT_TWIST_FAULT) {
+		correction = fixedToInt(fixedMul(fixedFromInt(twist), calibration->liftSyncKp));
+		if(correction > LIFT_SYNC_MAX) {
+			correction = LIFT_SYNC_MAX;
+		} else if(correction < -LIFT_SYNC_MAX) {
+			correction = -LIFT_SYNC_MAX;
+		}
+	}
+	//Keep the correction whole at full power so the sides still level
+	if(output > 127 - abs(correction)) {
+		output = 127 - abs(correction);
+	} else if(output < abs(correction) - 127) {
+		output = abs(correction) - 127;
+	}
+	telemetrySet(TELEMETRY_LIFT_TWIST, twist);
+	motorGroupSet(&liftLeftMotors, output - correction);
+	motorGroupSet(&liftRightMotors, output + correction);
+}
+
+void liftControlUpdate() {
+	SensorSnapshot sensors;
+	LiftRequest request;
+	unsigned int count = applied;
+	int error;
+	int output;
+
+	while(ringPop(&requests, &request)) {
+		//Gains are picked up each time the controller starts
+		if(request.active && !active) {
+			pidInit(&pid, calibration->gains.liftKp, calibration->gains.liftKi,
+				calibration->gains.liftKd, &pidProfile);
+		}
+		if(!request.active && active) {
+			motorGroupSet(&liftMotors, 0);
+		}
+		active = request.active;
+		target = request.target;
+		atTarget = false;
+		count++;
+	}
+	applied = count;
+	//After the setpoints, which the hold and the release both came after
+	if(holding && active) {
+		sensorsGet(&sensors);
+		target = sensors.liftTicks;
+		atTarget = false;
+	}
+	holding = false;
+	if(releases != releasesSeen) {
+		releasesSeen = releases;
+		if(active) {
+			motorGroupSet(&liftMotors, 0);
+			active = false;
+		}
+	}
+	if(!active) {
+		return;
+	}
+	sensorsGet(&sensors);
+	error = target - sensors.liftTicks;
+	output = liftControlOutput(&pid, target, sensors.liftTicks, CONTROL_PERIOD);
+	atTarget = abs(error) <= LIFT_TOLERANCE;
+	liftControlDrive(output, sensors.liftLeftTicks - sensors.liftRightTicks);
+}
@@ -0,0 +1,186 @@
+/** @file macro.c
+ * @brief Driver-assist macros
+ */
+
+#include "main.h"
+#include <string.h>
+
+/**
+ * A macro and the button that starts it; the command member must come first
+ */
+typedef struct {
+	Command command;
+	const MacroStep *steps;
+	unsigned int count;
+	unsigned char group;
+	unsigned char button;
+	//Run state, owned by the control task
+	unsigned int step;
+	unsigned long stepStart;
+	bool lifting;
+	int liftTarget;
+	Pid liftPid;
+} Macro;
+
+//Every macro's lift loop runs in the control task, one at a time
+static ProfileSection liftProfile = PROFILE_SECTION("macroLiftPid");
+
+static const MacroStep scoreSteps[] = {
+	{MACRO_CLAW, MACRO_GRAB_POWER, MACRO_GRAB_TIME},
+	{MACRO_LIFT, MACRO_SCORE_HEIGHT, MACRO_LIFT_TIMEOUT},
+	{MACRO_CLAW, -MACRO_GRAB_POWER, MACRO_RELEASE_TIME}
+};
+
+static const MacroStep carrySteps[] = {
+	{MACRO_CLAW, MACRO_GRAB_POWER, MACRO_GRAB_TIME},
+	{MACRO_LIFT, MACRO_CARRY_HEIGHT, MACRO_LIFT_TIMEOUT}
+};
+
+static void macroStart(Command *command);
+static bool macroRun(Command *command);
+static void macroEnd(Command *command, bool interrupted);
+
+#define MACRO(name, requires, steps) {name, requires, macroStart, macroRun, macroEnd}, \
+	steps, sizeof(steps) / sizeof(steps[0])
+
+static Macro macros[] = {
+	//Grab, raise to the scoring height and let go
+	{MACRO("score", COMMAND_CLAW | COMMAND_LIFT, scoreSteps), 5, JOY_UP},
+	//Grab and raise to carrying height
+	{MACRO("carry", COMMAND_CLAW | COMMAND_LIFT, carrySteps), 5, JOY_DOWN}
+};
+
+#define MACRO_COUNT (sizeof(macros) / sizeof(macros[0]))
+
+//Buttons held in the last input, so a macro starts once per press
+static unsigned char lastButtons[DRIVER_JOYSTICKS][4];
+
+/**
+ * stepEnd()
+ * Stops what a finished step was running, except the lift, which holds until the macro ends.
+ */
+static void stepEnd(const MacroStep *step) {
+	if(step->action == MACRO_CLAW) {
+		motorGroupSet(&clawMotors, 0);
+	} else if(step->action == MACRO_DRIVE) {
+		motorGroupSet(&driveLeftMotors, 0);
+		motorGroupSet(&driveRightMotors, 0);
+	}
+}
+
+static void macroStart(Command *command) {
+	Macro *macro = (Macro *)command;
+
+	macro->step = 0;
+	macro->stepStart = millis();
+	macro->lifting = false;
+}
+
+static bool macroRun(Command *command) {
+	Macro *macro = (Macro *)command;
+	const MacroStep *step = &macro->steps[macro->step];
+	SensorSnapshot sensors;
+	bool done;
+
+	sensorsGet(&sensors);
+	if(step->action == MACRO_LIFT) {
+		if(!macro->lifting) {
+			pidInit(&macro->liftPid, calibration->gains.liftKp, calibration->gains.liftKi,
+				calibration->gains.liftKd, &liftProfile);
+			macro->lifting = true;
+		}
+		macro->liftTarget = step->value;
+	}
+	if(macro->lifting) {
+		liftControlDrive(liftControlOutput(&macro->liftPid, macro->liftTarget,
+			sensors.liftTicks, CONTROL_PERIOD), sensors.liftLeftTicks - sensors.liftRightTicks);
+	}
+
+	switch(step->action) {
+	case MACRO_CLAW:
+		motorGroupSet(&clawMotors, step->value);
+		break;
+	case MACRO_DRIVE:
+		motorGroupSet(&driveLeftMotors, step->value);
+		motorGroupSet(&driveRightMotors, step->value);
+		break;
+	default:
+		break;
+	}
+
+	done = sensors.time - macro->stepStart >= step->time;
+	if(step->action == MACRO_LIFT && abs(step->value - sensors.liftTicks) <= LIFT_TOLERANCE) {
+		done = true;
+	}
+	if(!done) {
+		return false;
+	}
+	stepEnd(step);
+	macro->step++;
+	macro->stepStart = sensors.time;
+	return macro->step >= macro->count;
+}
+
+static void macroEnd(Command *command, bool interrupted) {
+	Macro *macro = (Macro *)command;
+
+	if(macro->step < macro->count) {
+		stepEnd(&macro->steps[macro->step]);
+	}
+	//The driver's lift hold takes over from the height the lift is left at
+	if(macro->lifting) {
+		motorGroupSet(&liftMotors, 0);
+	}
+}
+
+/**
+ * pressed()
+ * @return true if a button is held on either joystick in this input but was not in the last one
+ */
+static bool pressed(const DriverInput *input, unsigned char group, unsigned char button) {
+	int joystick;
+
+	for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+		if((input->buttons[joystick][group - 5] & button) != 0 &&
+				(lastButtons[joystick][group - 5] & button) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * mechanismsOf()
+ * @return a bit for each DriverMechanism of a command's COMMAND_* bits
+ */
+static unsigned int mechanismsOf(unsigned char requires) {
+	return ((requires & COMMAND_DRIVE) ? 1 << DRIVER_DRIVE : 0) |
+		((requires & COMMAND_LIFT) ? 1 << DRIVER_LIFT : 0) |
+		((requires & COMMAND_CLAW) ? 1 << DRIVER_CLAW : 0);
+}
+
+void macroUpdate(const DriverInput *input) {
+	unsigned int i;
+
+	for(i = 0; i < MACRO_COUNT; i++) {
+		//The driver taking over a mechanism the macro uses stops it; the others stay the driver's
+		if(driverMoving(input, mechanismsOf(macros[i].command.requires))) {
+			commandCancel(&macros[i].command);
+		} else if(pressed(input, macros[i].group, macros[i].button) &&
+				commandSchedule(&macros[i].command)) {
+			//The lift controller left holding after autonomous would fight the macro's own loop
+			if(macros[i].command.requires & COMMAND_LIFT) {
+				liftControlRelease();
+			}
+		}
+	}
+	memcpy(lastButtons, input->buttons, sizeof(lastButtons));
+}
+
+void macroCancel() {
+	unsigned int i;
+
+	for(i = 0; i < MACRO_COUNT; i++) {
+		commandCancel(&macros[i].command);
+	}
+}
@@ -0,0 +1,157 @@
+/** @file mode.c
+ * @brief Competition mode manager and the background autonomous routine
+ */
+
+#include "main.h"
+
+static void routineStart(Command *command);
+static bool routineUpdate(Command *command);
+static void routineEnd(Command *command, bool interrupted);
+
+//Requires no mechanism, so the commands the routine schedules itself do not interrupt it
+static Command routine = {
+	"autonomous", 0, routineStart, routineUpdate, routineEnd, COMMAND_IDLE, false
+};
+static Semaphore startSignal;
+static const char *const modeNames[] = {"disabled", "autonomous", "driver"};
+
+//Owned by the control task
+static volatile Mode mode = MODE_DISABLED;
+static volatile bool online;
+//One routine run, from modeRoutineStart() until the routine task lets go
+static volatile bool running;
+static volatile bool scheduled;
+static volatile bool started;
+static volatile bool aborted;
+static volatile bool finished;
+//Handover timing in microseconds, from the cancel to the routine letting go
+static volatile bool cancelTimed;
+static volatile unsigned long cancelTime;
+static volatile unsigned long lastHandover;
+static volatile unsigned long worstHandover;
+static volatile unsigned int handovers;
+//Owned by the control task
+static unsigned int handoversHeld;
+
+/**
+ * routineAbort()
+ * Tells the routine to stop, noting the time of the first request.
+ */
+static void routineAbort() {
+	if(!cancelTimed) {
+		cancelTime = micros();
+		cancelTimed = true;
+	}
+	aborted = true;
+}
+
+static void routineStart(Command *command) {
+	started = true;
+	semaphoreGive(startSignal);
+}
+
+static bool routineUpdate(Command *command) {
+	return finished;
+}
+
+static void routineEnd(Command *command, bool interrupted) {
+	if(interrupted) {
+		routineAbort();
+	}
+}
+
+void modeInit() {
+	startSignal = semaphoreCreate();
+	//Start out taken, whatever state the kernel creates it in
+	semaphoreTake(startSignal, 0);
+}
+
+void modeUpdate() {
+	Mode now = !isEnabled() ? MODE_DISABLED : isAutonomous() ? MODE_AUTONOMOUS : MODE_DRIVER;
+
+	online = isOnline();
+	//The routine was cut off and has let go; hold the lift where it left it
+	if(handovers != handoversHeld) {
+		handoversHeld = handovers;
+		liftControlHold();
+	}
+	//Cancelled before it started, so the routine task never saw it
+	if(running && scheduled && !started && commandDone(&routine)) {
+		running = false;
+	}
+	if(now != mode) {
+		//The routine ends with the autonomous period, and with the robot disabled
+		if(mode == MODE_AUTONOMOUS || now == MODE_DISABLED) {
+			modeRoutineCancel();
+		}
+		mode = now;
+	}
+}
+
+Mode modeGet() {
+	return mode;
+}
+
+bool modeRoutineStart() {
+	if(running) {
+		return false;
+	}
+	scheduled = false;
+	started = false;
+	aborted = false;
+	finished = false;
+	cancelTimed = false;
+	running = true;
+	if(!commandSchedule(&routine)) {
+		running = false;
+		return false;
+	}
+	scheduled = true;
+	return true;
+}
+
+void modeRoutineCancel() {
+	//Flagged here as well as in routineEnd(), so the routine stops before the next tick
+	if(running && !aborted) {
+		routineAbort();
+	}
+	commandCancel(&routine);
+}
+
+bool modeRoutineRunning() {
+	return running;
+}
+
+bool modeRoutineAborted() {
+	return aborted;
+}
+
+void modeRoutineRun() {
+	unsigned long handover;
+
+	semaphoreTake(startSignal, -1);
+	if(!aborted) {
+		autonomousRoutine();
+	}
+	//Stop the drive and claw for whoever comes next. After a cut-off the control task holds the
+	//lift where it is, as the routine may have left it on its way somewhere
+	pathFollowStop();
+	motorGroupSet(&clawMotors, 0);
+	if(aborted) {
+		handover = micros() - cancelTime;
+		lastHandover = handover;
+		if(handover > worstHandover) {
+			worstHandover = handover;
+		}
+		handovers++;
+	}
+	finished = true;
+	running = false;
+}
+
+void modeReport(FILE *stream) {
+	fprintf(stream, "{\"mode\":\"%s\",\"online\":%s,\"routine\":%s,\"handovers\":%u,"
+		"\"lastHandoverUs\":%lu,\"worstHandoverUs\":%lu}\r\n", modeNames[mode],
+		online ? "true" : "false", running ? "true" : "false", handovers, lastHandover,
+		worstHandover);
+}
@@ -0,0 +1,133 @@
+/** @file motors.c
+ * @brief Motor port map and buffered motor output layer
+ */
+
+#include "main.h"
+
+const MotorGroup driveLeftMotors = {
+	2, {leftBackDrive, leftFrontDrive}, {1, 1}, POWER_PRIORITY_HIGH
+};
+const MotorGroup driveRightMotors = {
+	2, {rightBackDrive, rightFrontDrive}, {-1, -1}, POWER_PRIORITY_HIGH
+};
+const MotorGroup liftMotors = {
+	4, {leftLiftInner, leftLiftOuter, rightLiftInner, rightLiftOuter}, {1, -1, -1, 1},
+	POWER_PRIORITY_MEDIUM
+};
+const MotorGroup liftLeftMotors = {
+	2, {leftLiftInner, leftLiftOuter}, {1, -1}, POWER_PRIORITY_MEDIUM
+};
+const MotorGroup liftRightMotors = {
+	2, {rightLiftInner, rightLiftOuter}, {-1, 1}, POWER_PRIORITY_MEDIUM
+};
+const MotorGroup clawMotors = {
+	2, {leftClaw, rightClaw}, {1, -1}, POWER_PRIORITY_LOW
+};
+
+static const MotorGroup *const motorGroups[] = {
+	&driveLeftMotors, &driveRightMotors, &liftMotors, &clawMotors
+};
+
+//Frame state, indexed from port 1
+static int frame[MOTOR_PORTS];
+static int committed[MOTOR_PORTS];
+static int measured[MOTOR_PORTS];
+static unsigned char priority[MOTOR_PORTS];
+//Cortex port each motor was last sent to
+static unsigned char sentPort[MOTOR_PORTS];
+static unsigned long lastCommit;
+static bool started;
+static volatile bool held;
+
+static ProfileSection commitProfile = PROFILE_SECTION("motorFrameCommit");
+
+/**
+ * clamp()
+ * Limits a speed to the range the motors accept.
+ */
+static int clamp(int speed) {
+	if(speed > 127) {
+		return 127;
+	}
+	if(speed < -127) {
+		return -127;
+	}
+	return speed;
+}
+
+void motorFrameSet(unsigned char channel, int speed) {
+	frame[channel - 1] = clamp(speed);
+}
+
+void motorFrameHold(bool hold) {
+	held = hold;
+}
+
+int motorFrameGet(unsigned char channel) {
+	return frame[channel - 1];
+}
+
+void motorGroupSet(const MotorGroup *group, int speed) {
+	int i;
+
+	for(i = 0; i < group->count; i++) {
+		motorFrameSet(group->ports[i], group->direction[i] * speed);
+	}
+}
+
+void motorGroupMeasured(const MotorGroup *group, int speed) {
+	int i;
+
+	for(i = 0; i < group->count; i++) {
+		measured[group->ports[i] - 1] = group->direction[i] * speed;
+	}
+}
+
+void motorFrameCommit() {
+	unsigned long now = millis();
+	unsigned int battery;
+	unsigned int i;
+	int g;
+
+	profileBegin(&commitProfile);
+	//Ports not in any group are never scaled
+	if(!started) {
+		for(i = 0; i < MOTOR_PORTS; i++) {
+			priority[i] = POWER_PRIORITY_HIGH;
+		}
+		for(i = 0; i < sizeof(motorGroups) / sizeof(motorGroups[0]); i++) {
+			for(g = 0; g < motorGroups[i]->count; g++) {
+				priority[motorGroups[i]->ports[g] - 1] = motorGroups[i]->priority;
+			}
+		}
+		started = true;
+	} else {
+		//powerLevelMain() can read 0 in rare cases, fall back to a charged battery
+		battery = powerLevelMain();
+		if(battery == 0) {
+			battery = 7200;
+		}
+		//The previous frame was held until now
+		powerModelUpdate(committed, measured, battery, now - lastCommit);
+	}
+	lastCommit = now;
+
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		committed[i] = held ? 0 : frame[i];
+	}
+	powerBudgetApply(committed, priority);
+
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		//A motor moved to another port leaves its old port stopped
+		if(calibration->ports[i] != sentPort[i]) {
+			if(sentPort[i] != 0) {
+				motorSet(sentPort[i], 0);
+			}
+			sentPort[i] = calibration->ports[i];
+		}
+	}
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		motorSet(sentPort[i], committed[i]);
+	}
+	profileEnd(&commitProfile);
+}
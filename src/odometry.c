@@ -0,0 +1,69 @@
+/** @file odometry.c
+ * @brief Drive encoder odometry
+ */
+
+#include "main.h"
+
+//Owned by the control task, which publishes a copy after each update
+static Pose pose;
+static Seqlock published;
+//Poses from odometryReset(), applied by the control task
+static Ring resets;
+//Where the last update left each wheel
+static EncoderMark lastLeft;
+static EncoderMark lastRight;
+static bool started;
+
+static ProfileSection updateProfile = PROFILE_SECTION("odometryUpdate");
+
+void odometryInit() {
+	seqlockInit(&published, sizeof(Pose));
+	ringInit(&resets, "odometry", sizeof(Pose), ODOMETRY_RESETS);
+}
+
+void odometryReset(const Pose *start) {
+	ringPush(&resets, start);
+}
+
+void odometryUpdate() {
+	SensorSnapshot sensors;
+	Fixed left;
+	Fixed right;
+	Fixed travel;
+	Fixed turn;
+	Fixed direction;
+	Pose start;
+
+	profileBegin(&updateProfile);
+	sensorsGet(&sensors);
+	while(ringPop(&resets, &start)) {
+		pose = start;
+		sensorsMark(&lastLeft, SENSORS_LEFT, &sensors);
+		sensorsMark(&lastRight, SENSORS_RIGHT, &sensors);
+		started = true;
+	}
+	if(!started) {
+		profileEnd(&updateProfile);
+		return;
+	}
+
+	left = sensorsSinceMark(&lastLeft, &sensors) * ODOMETRY_INCHES_PER_TICK;
+	right = sensorsSinceMark(&lastRight, &sensors) * ODOMETRY_INCHES_PER_TICK;
+	sensorsMark(&lastLeft, SENSORS_LEFT, &sensors);
+	sensorsMark(&lastRight, SENSORS_RIGHT, &sensors);
+
+	//Arc approximation, moving along the mean heading of the step
+	travel = (left + right) / 2;
+	turn = fixedDiv(right - left, ODOMETRY_TRACK_WIDTH);
+	direction = pose.heading + turn / 2;
+	pose.x += fixedMul(travel, fixedCos(direction));
+	pose.y += fixedMul(travel, fixedSin(direction));
+	pose.heading = fixedWrapAngle(pose.heading + turn);
+	seqlockWrite(&published, &pose);
+
+	profileEnd(&updateProfile);
+}
+
+void odometryGet(Pose *copy) {
+	seqlockRead(&published, copy);
+}
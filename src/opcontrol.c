@@ -35,6 +35,13 @@
 #include "main.h"
 #include "math.h"
 
+//Encoder ticks per 20ms loop at motor free speed
+#define DRIVE_FREE_TICKS 12
+#define LIFT_FREE_TICKS 12
+
+static ProfileSection stepProfile = PROFILE_SECTION("driverStep");
+static ProfileSection liftHoldProfile = PROFILE_SECTION("driverLiftPid");
+
 /*
  * Runs the user operator control code. This function will be started in its own task with the
  * default priority and stack size whenever the robot is enabled via the Field Management System
@@ -53,124 +60,356 @@
  * This task should never exit; it should end with some kind of infinite loop, even if empty.
  */
 
-	Encoder rEnc;
-	Encoder lEnc;
-	Encoder liftEnc;
+//Lift Variables
+static int liftPos;
+static Pid liftHold;
+static bool liftHolding;
+static unsigned long lastTime;
 
-void operatorControl() {
+//Drive Variables
+static Traction leftTraction;
+static Traction rightTraction;
+
+//Power Model Variables
+static int lastLeftTicks;
+static int lastRightTicks;
+static int lastLiftTicks;
 
-	lcdInit(uart1);
-	lcdSetBacklight(uart1, true);
+//Joystick Arbitration Variables, indexed by DriverMechanism
+static int owner[DRIVER_MECHANISMS];
+static bool waitCenter[DRIVER_MECHANISMS];
+static unsigned char lastConnected;
 
-	if(!liftEnc) {
-		liftEnc = encoderInit(5, 6, 0);
+void driverInputSample(DriverInput *input) {
+	SensorSnapshot sensors;
+	int joystick;
+	int i;
+
+	sensorsGet(&sensors);
+	input->time = sensors.time;
+	input->connected = 0;
+	//Every read is made whether or not the joystick is there, so the cost never changes
+	for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+		bool connected = isJoystickConnected(joystick + 1);
+
+		input->connected |= connected ? 1 << joystick : 0;
+		for(i = 0; i < 4; i++) {
+			input->analog[joystick][i] = joystickGetAnalog(joystick + 1, i + 1) * connected;
+			input->buttons[joystick][i] =
+				(joystickGetDigital(joystick + 1, i + 5, JOY_UP) ? JOY_UP : 0) |
+				(joystickGetDigital(joystick + 1, i + 5, JOY_DOWN) ? JOY_DOWN : 0);
+			//Only groups 7 and 8 have left and right buttons
+			if(i >= 2) {
+				input->buttons[joystick][i] |=
+					(joystickGetDigital(joystick + 1, i + 5, JOY_LEFT) ? JOY_LEFT : 0) |
+					(joystickGetDigital(joystick + 1, i + 5, JOY_RIGHT) ? JOY_RIGHT : 0);
+			}
+			input->buttons[joystick][i] *= connected;
+		}
+	}
+	input->leftTicks = sensors.leftTicks;
+	input->rightTicks = sensors.rightTicks;
+	input->liftTicks = sensors.liftTicks;
+	input->liftTwist = sensors.liftLeftTicks - sensors.liftRightTicks;
+	input->battery = sensors.battery;
+	input->held = commandRequired();
+	//The routine has everything while it runs, and the lift controller the lift after it
+	if(modeRoutineRunning()) {
+		input->held |= COMMAND_DRIVE | COMMAND_LIFT | COMMAND_CLAW;
+	}
+	if(liftControlActive()) {
+		input->held |= COMMAND_LIFT;
 	}
-	if(!lEnc){							//If autonomous did not initialize back encoder
-		lEnc = encoderInit(1, 2, 1);	//Initialize back Encoder
+}
+
+/**
+ * controlMoved()
+ * @return true if a joystick's controls for a mechanism are off center
+ */
+static bool controlMoved(const DriverInput *input, unsigned int mechanism, int joystick) {
+	const int *axes = input->analog[joystick];
+
+	switch(mechanism) {
+	case DRIVER_DRIVE:
+		return abs(axes[0]) > calibration->deadzone || abs(axes[1]) > calibration->deadzone;
+	case DRIVER_LIFT:
+		return abs(axes[2]) > calibration->deadzone;
+	default:
+		return (input->buttons[joystick][1] & (JOY_UP | JOY_DOWN)) != 0;
+	}
+}
+
+/**
+ * driverUsing()
+ * @return true if the driver is using one of a set of mechanisms on either joystick
+ *
+ * @param mechanisms a bit for each DriverMechanism
+ */
+static bool driverUsing(const DriverInput *input, unsigned int mechanisms) {
+	unsigned int mechanism;
+	int joystick;
+
+	for(mechanism = 0; mechanism < DRIVER_MECHANISMS; mechanism++) {
+		for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+			if((mechanisms & (1 << mechanism)) && (input->connected & (1 << joystick)) &&
+					controlMoved(input, mechanism, joystick)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * controlOwner()
+ * Applies the joystick mapping for a mechanism.
+ *
+ * @param current the joystick driving it so far, or -1
+ * @return the joystick index to drive it, or -1 if neither is connected
+ */
+static int controlOwner(const DriverInput *input, unsigned int mechanism, int current) {
+	int mapped = calibration->joysticks[mechanism];
+	int joystick;
+
+	if(mapped != DRIVER_EITHER) {
+		//The other joystick stands in while the mapped one is away
+		for(joystick = mapped - 1; joystick < mapped - 1 + DRIVER_JOYSTICKS; joystick++) {
+			if(input->connected & (1 << (joystick % DRIVER_JOYSTICKS))) {
+				return joystick % DRIVER_JOYSTICKS;
+			}
+		}
+		return -1;
+	}
+
+	//The joystick in use keeps the mechanism until let go, then whichever moves takes it
+	if(current >= 0 && (input->connected & (1 << current)) &&
+			controlMoved(input, mechanism, current)) {
+		return current;
+	}
+	for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+		if((input->connected & (1 << joystick)) && controlMoved(input, mechanism, joystick)) {
+			return joystick;
+		}
+	}
+	if(current >= 0 && (input->connected & (1 << current))) {
+		return current;
+	}
+	for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+		if(input->connected & (1 << joystick)) {
+			return joystick;
+		}
+	}
+	return -1;
+}
+
+bool driverMoving(const DriverInput *input, unsigned int mechanisms) {
+	unsigned int mechanism;
+	int joystick;
+
+	for(mechanism = 0; mechanism < DRIVER_MECHANISMS; mechanism++) {
+		if(mechanisms & (1 << mechanism)) {
+			joystick = controlOwner(input, mechanism, owner[mechanism]);
+			if(joystick >= 0 && controlMoved(input, mechanism, joystick)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * driverArbitrate()
+ * Picks the joystick driving each mechanism this iteration.
+ *
+ * @param input the inputs sampled for this iteration
+ * @param joystick filled with a joystick index per mechanism, or -1 to treat it as centered
+ */
+static void driverArbitrate(const DriverInput *input, int *joystick) {
+	unsigned int mechanism;
+	int next;
+
+	for(mechanism = 0; mechanism < DRIVER_MECHANISMS; mechanism++) {
+		next = controlOwner(input, mechanism, owner[mechanism]);
+		//Changing hands because a joystick came or went: wait for the new one to center
+		if(next != owner[mechanism] && input->connected != lastConnected) {
+			waitCenter[mechanism] = true;
+		}
+		owner[mechanism] = next;
+		if(next < 0 || !controlMoved(input, mechanism, next)) {
+			waitCenter[mechanism] = false;
+		}
+		joystick[mechanism] = waitCenter[mechanism] ? -1 : next;
 	}
-	if(!rEnc){							//If autonomous did not initialize front encoder
-		rEnc = encoderInit(3, 4, 1);	//Initialize front Encoder
+	lastConnected = input->connected;
+}
+
+void driverReset(const DriverInput *input) {
+	unsigned int mechanism;
+
+	for(mechanism = 0; mechanism < DRIVER_MECHANISMS; mechanism++) {
+		owner[mechanism] = controlOwner(input, mechanism, -1);
+		waitCenter[mechanism] = false;
 	}
-	encoderReset(liftEnc);
+	lastConnected = input->connected;
+	tractionReset(&leftTraction, 0);
+	tractionReset(&rightTraction, 0);
+	liftPos = input->liftTicks;
+	liftHolding = false;
+	lastTime = input->time;
+	lastLeftTicks = input->leftTicks;
+	lastRightTicks = input->rightTicks;
+	lastLiftTicks = input->liftTicks;
+}
+
+void driverStep(const DriverInput *input) {
+	static const int centered[4] = {0, 0, 0, 0};
+	int joystick[DRIVER_MECHANISMS];
+	const int *axes;
 
 	//Drive Variables
-	int deadzone = 20;					//Joystick deadzone
 	int xAxis;
 	int yAxis;
+	int leftTarget = 0;
+	int rightTarget = 0;
+	//Measured speeds in command units, from the ticks since the last loop
+	int leftSpeed = (input->leftTicks - lastLeftTicks) * 127 / DRIVE_FREE_TICKS;
+	int rightSpeed = (input->rightTicks - lastRightTicks) * 127 / DRIVE_FREE_TICKS;
 
 	//Lift Variables
 	int liftYAxis;
-	int liftPos = encoderGet(liftEnc);
-	int liftSpeed = 33;
-	int liftCounter = 0;
-
-
-	//Motor Port Constants
-	const int rightBackDrive = 10;
-	const int rightFrontDrive = 9;
-	const int rightLiftInner = 8;
-	const int rightLiftOuter = 7;
-	const int rightClaw = 6;
-	const int leftClaw = 5;
-	const int leftLiftOuter = 4;
-	const int leftLiftInner = 3;
-	const int leftFrontDrive = 2;
-	const int leftBackDrive = 1;
+
+	//Claw Variables
+	unsigned char clawButtons;
+
+	driverArbitrate(input, joystick);
+
+	//Gets different xAxis and yAxis values for different drive modes
+	axes = joystick[DRIVER_DRIVE] >= 0 ? input->analog[joystick[DRIVER_DRIVE]] : centered;
+	yAxis = -(axes[1]);
+	xAxis = -(axes[0]);
+	/////////p/////////////////////////////////////
+	//											//
+	//		   Drive Control Statements			//
+	//											//
+	//////////////////////////////////////////////
+
+	//If controller not out of deadzone stop motors
+	if(abs(xAxis) > calibration->deadzone || abs(yAxis) > calibration->deadzone) {
+		rightTarget = xAxis - yAxis;
+		leftTarget = -xAxis - yAxis;
+	}
+
+	if(input->held & COMMAND_DRIVE) {
+		//A macro has the drive; traction control picks up from the speed it leaves
+		tractionReset(&rightTraction, rightSpeed);
+		tractionReset(&leftTraction, leftSpeed);
+	} else {
+		//Limited to what the wheels can grip and, with the lift up, to what will not tip
+		motorGroupSet(&driveRightMotors, tractionStep(&rightTraction, rightTarget, rightSpeed,
+			input->liftTicks, input->time - lastTime));
+		motorGroupSet(&driveLeftMotors, tractionStep(&leftTraction, leftTarget, leftSpeed,
+			input->liftTicks, input->time - lastTime));
+	}
+
+	axes = joystick[DRIVER_LIFT] >= 0 ? input->analog[joystick[DRIVER_LIFT]] : centered;
+	liftYAxis = axes[2];
+
+	if(input->held & COMMAND_LIFT) {
+		//A macro has the lift; hold it wherever the macro leaves it
+		liftPos = input->liftTicks;
+		liftHolding = false;
+	} else if(abs(liftYAxis) > calibration->deadzone) {
+		liftControlDrive(liftYAxis, input->liftTwist);
+		liftPos = input->liftTicks;
+		liftHolding = false;
+	} else {
+		//Hold the lift where the driver let go of it
+		if(!liftHolding) {
+			pidInit(&liftHold, calibration->gains.liftKp, calibration->gains.liftKi,
+				calibration->gains.liftKd, &liftHoldProfile);
+			liftHolding = true;
+		}
+		liftControlDrive(liftControlOutput(&liftHold, liftPos, input->liftTicks,
+			input->time - lastTime), input->liftTwist);
+	}
+
+	clawButtons = joystick[DRIVER_CLAW] >= 0 ? input->buttons[joystick[DRIVER_CLAW]][1] : 0;
+	//Up closes the claw and down opens it
+	if(input->held & COMMAND_CLAW) {
+		//A macro has the claw
+	} else if(clawButtons & JOY_UP){
+		motorGroupSet(&clawMotors, 127);
+	} else if(clawButtons & JOY_DOWN){
+		motorGroupSet(&clawMotors, -127);
+	} else {
+		motorGroupSet(&clawMotors, 0);
+	}
+
+	//Measured speeds for the power model, in ticks since the last loop
+	motorGroupMeasured(&driveLeftMotors, leftSpeed);
+	motorGroupMeasured(&driveRightMotors, rightSpeed);
+	motorGroupMeasured(&liftMotors, (input->liftTicks - lastLiftTicks) * 127 / LIFT_FREE_TICKS);
+	lastLeftTicks = input->leftTicks;
+	lastRightTicks = input->rightTicks;
+	lastLiftTicks = input->liftTicks;
+	lastTime = input->time;
+}
+
+void operatorControl() {
+	DriverInput input;
+	unsigned long stepMicros;
+
+	//Extra Feature Variables
+	bool reportHeld = false;
+	bool recordHeld = false;
+	bool recording = false;
+	bool recordStart = false;
+	bool routineHeld = false;
+	bool routineShown = false;
+
+	//Take the drive back from autonomous. Odometry keeps its pose and the lift controller keeps
+	//holding the lift until the driver moves it or a macro takes it.
+	modeRoutineCancel();
+	commandCancelAll();
+	pathFollowStop();
+
+	driverInputSample(&input);
+	driverReset(&input);
 
 	while (1) {
 		delay(20);
 
-		//Gets different xAxis and yAxis values for different drive modes
-
-		yAxis = -(joystickGetAnalog(1, 2));
-		xAxis = -(joystickGetAnalog(1, 1));
-		/////////p/////////////////////////////////////
-		//											//
-		//		   Drive Control Statements			//
-		//											//
-		//////////////////////////////////////////////
-
-		//If controller not out of deadzone stop motors
-		if(abs(xAxis) > deadzone || abs(yAxis) > deadzone) {
-			motorSet(rightFrontDrive, -xAxis + yAxis);
-			motorSet(rightBackDrive, -xAxis + yAxis);
-			motorSet(leftFrontDrive, -xAxis - yAxis);
-			motorSet(leftBackDrive, -xAxis - yAxis);
-		} else {
-			motorSet(rightFrontDrive, 0);
-			motorSet(rightBackDrive, 0);
-			motorSet(leftFrontDrive, 0);
-			motorSet(leftBackDrive, 0);
-		}
-
-		liftYAxis = joystickGetAnalog(1, 3);
-
-		if(abs(liftYAxis) > deadzone) {
-			motorSet(leftLiftInner, liftYAxis);
-			motorSet(leftLiftOuter, -liftYAxis);
-			motorSet(rightLiftInner, -liftYAxis);
-			motorSet(rightLiftOuter, liftYAxis);
-			liftPos = encoderGet(liftEnc);
-		} else {
-			/*lcdPrint(uart1, 2, "Count: %d", encoderGet(liftEnc));
-			if (encoderGet(liftEnc) + 10 > liftPos) {
-				if(liftCounter % 20 == 0) {
-					liftSpeed -= 2;
-				}
-				liftCounter++;
-			} else if(encoderGet(liftEnc) - 10 < liftPos) {
-				if(liftCounter % 20 == 0){
-					liftSpeed += 2;
-				}
-				liftCounter++;
-			} else {
-				if(liftCounter != 0){
-					if(liftSpeed < 33) {
-						liftSpeed += 25;
-					} else if (liftSpeed > 33) {
-						liftSpeed -= 15;
-					}
-				}
-				liftCounter = 0;
-			}*/
-			motorSet(leftLiftInner, 0);
-			motorSet(leftLiftOuter, 0);
-			motorSet(rightLiftInner, 0);
-			motorSet(rightLiftOuter, 0);
+		driverInputSample(&input);
+		//A self-test started from the serial shell has the motors
+		if(selftestActive()) {
+			driverReset(&input);
+			continue;
 		}
-
-		if(joystickGetDigital(1, 6, JOY_UP)){
-			motorSet(leftClaw, 127);
-			motorSet(rightClaw, -127);
-		} else if(joystickGetDigital(1, 6, JOY_DOWN)){
-			motorSet(leftClaw, -127);
-			motorSet(rightClaw, 127);
-		} else {
-			motorSet(leftClaw, 0);
-			motorSet(rightClaw, 0);
+		//Any stick or the claw stops a routine started from the shortcut below
+		if(modeRoutineRunning() && driverUsing(&input, (1 << DRIVER_MECHANISMS) - 1)) {
+			modeRoutineCancel();
+		}
+		//Once the routine has let go, the lift stick takes the lift back from its controller
+		if(liftControlActive() && !modeRoutineRunning() && driverUsing(&input, 1 << DRIVER_LIFT)) {
+			liftControlRelease();
+		}
+		if(routineShown && !modeRoutineRunning()) {
+			displayStatus(NULL);
+			routineShown = false;
 		}
+		macroUpdate(&input);
+		//A recording starts from a reset, as its replay does
+		if(recordStart) {
+			driverReset(&input);
+			recordStart = false;
+		}
+		profileBegin(&stepProfile);
+		driverStep(&input);
+		stepMicros = profileEnd(&stepProfile);
 
-		lcdPrint(uart1, 1, "Lift: %d", encoderGet(rEnc));
+		if(recording) {
+			replayRecord(&input, stepMicros);
+		}
 
 
 
@@ -179,16 +418,67 @@ void operatorControl() {
 		//			Extra Features			//
 		//									//
 		//////////////////////////////////////
-		if(joystickGetDigital(1, 8, JOY_LEFT)){
-			if(joystickGetDigital(1, 8, JOY_UP)){ //Press up and right on left buttons
-				//Reset encoders
-				encoderReset(rEnc);
-				encoderReset(lEnc);
+		if(driverButton(&input, 8, JOY_LEFT)){
+			if(driverButton(&input, 8, JOY_UP)){ //Press up and right on left buttons
+				//Zero the encoders on the LCD
+				displayZero();
+			}
+			if(driverButton(&input, 8, JOY_DOWN)){ //Press up and left on left buttons
+				//Run autonomous in the background, off the field only, once per press
+				if(!routineHeld && !isOnline() && modeRoutineStart()) {
+					displayStatus("HIA");
+					routineShown = true;
+				}
+				routineHeld = true;
+			} else {
+				routineHeld = false;
+			}
+			if(driverButton(&input, 8, JOY_RIGHT)){ //Press left and right on left buttons
+				//Dump code path timings and stack use to the serial console, once per press
+				if(!reportHeld) {
+					profileReport(stdout);
+					tasksReport(stdout);
+				}
+				reportHeld = true;
+			} else {
+				reportHeld = false;
+			}
+		}
+		if(driverButton(&input, 7, JOY_LEFT)){
+			if(driverButton(&input, 7, JOY_UP)){ //Press left and up on right buttons
+				//Start or stop recording the driver to the serial console
+				if(!recordHeld) {
+					recording = !recording;
+					recordStart = recording;
+				}
+				recordHeld = true;
+			} else {
+				recordHeld = false;
+			}
+			if(driverButton(&input, 7, JOY_DOWN)){ //Press left and down on right buttons
+				//Replay a recording sent over the serial console with the motors off
+				motorFrameHold(true);
+				displayStatus("Replay");
+				displayStatus(replayRun() ? "Replay pass" : "Replay fail");
+				motorFrameHold(false);
+				driverInputSample(&input);
+				driverReset(&input);
+			}
+		}
+		if(driverButton(&input, 7, JOY_RIGHT)){
+			if(driverButton(&input, 7, JOY_UP)){ //Press right and up on right buttons
+				//Tune the lift gains, moving a stick aborts
+				displayStatus("Tuning lift");
+				displayStatus(autotuneLift() ? "Lift tuned" : "Tune aborted");
+				driverInputSample(&input);
+				driverReset(&input);
 			}
-			if(joystickGetDigital(1, 8, JOY_DOWN)){ //Press up and left on left buttons
-				//Start autonomous
-				lcdPrint(uart1, 1, "HIA");
-				autonomous();
+			if(driverButton(&input, 7, JOY_DOWN)){ //Press right and down on right buttons
+				//Tune the drive gains, needs clear floor in front, moving a stick aborts
+				displayStatus("Tuning drive");
+				displayStatus(autotuneDrive() ? "Drive tuned" : "Tune aborted");
+				driverInputSample(&input);
+				driverReset(&input);
 			}
 		}
 
@@ -0,0 +1,122 @@
+/** @file path.c
+ * @brief Pure pursuit path follower
+ */
+
+#include "main.h"
+
+static const Path *volatile current;
+//Closest point found so far; the search only moves forward along the path
+static unsigned int closest;
+
+static ProfileSection followProfile = PROFILE_SECTION("pathFollowUpdate");
+
+/**
+ * distanceSquared()
+ * @return the squared distance from the pose to a path point, in square inches
+ */
+static Fixed distanceSquared(const Pose *pose, const PathPoint *point) {
+	Fixed dx = point->x - pose->x;
+	Fixed dy = point->y - pose->y;
+
+	return fixedAdd(fixedMul(dx, dx), fixedMul(dy, dy));
+}
+
+/**
+ * speedCommand()
+ * Converts a wheel speed to a motor command with the drive feedforward gains.
+ */
+static int speedCommand(Fixed speed) {
+	Fixed command = fixedMul(calibration->gains.driveKv, speed);
+
+	if(speed > 0) {
+		command += calibration->gains.driveKs;
+	} else if(speed < 0) {
+		command -= calibration->gains.driveKs;
+	}
+	return fixedToInt(command);
+}
+
+void pathFollowStart(const Path *path) {
+	closest = 0;
+	current = path;
+}
+
+void pathFollowUpdate() {
+	const Path *path = current;
+	const PathPoint *points;
+	const PathPoint *goal;
+	Pose pose;
+	unsigned int next;
+	Fixed lookahead = fixedMul(PATH_LOOKAHEAD, PATH_LOOKAHEAD);
+	Fixed dx;
+	Fixed dy;
+	Fixed lateral;
+	Fixed range;
+	Fixed curvature = 0;
+	Fixed speed;
+	Fixed turn;
+	int left;
+	int right;
+	int fastest;
+
+	if(path == NULL) {
+		return;
+	}
+	profileBegin(&followProfile);
+	points = path->points;
+	odometryGet(&pose);
+
+	if(distanceSquared(&pose, &points[path->count - 1]) <
+			fixedMul(PATH_TOLERANCE, PATH_TOLERANCE)) {
+		pathFollowStop();
+		profileEnd(&followProfile);
+		return;
+	}
+
+	while(closest + 1 < path->count && distanceSquared(&pose, &points[closest + 1]) <=
+			distanceSquared(&pose, &points[closest])) {
+		closest++;
+	}
+	next = closest;
+	while(next + 1 < path->count && distanceSquared(&pose, &points[next]) < lookahead) {
+		next++;
+	}
+	goal = &points[next];
+
+	//Lateral offset of the goal in the robot frame gives the arc through it
+	dx = goal->x - pose.x;
+	dy = goal->y - pose.y;
+	lateral = fixedMul(dy, fixedCos(pose.heading)) - fixedMul(dx, fixedSin(pose.heading));
+	range = fixedAdd(fixedMul(dx, dx), fixedMul(dy, dy));
+	if(range > 0) {
+		curvature = fixedDiv(2 * lateral, range);
+	}
+
+	speed = points[closest].speed;
+	if(speed < PATH_MIN_SPEED) {
+		speed = PATH_MIN_SPEED;
+	}
+	turn = fixedMul(fixedMul(speed, curvature), ODOMETRY_TRACK_WIDTH / 2);
+	left = speedCommand(speed - turn);
+	right = speedCommand(speed + turn);
+	//Slow both sides when one cannot go any faster, so the robot still turns as tightly
+	fastest = abs(left) > abs(right) ? abs(left) : abs(right);
+	if(fastest > 127) {
+		left = left * 127 / fastest;
+		right = right * 127 / fastest;
+	}
+	motorGroupSet(&driveLeftMotors, left);
+	motorGroupSet(&driveRightMotors, right);
+
+	profileEnd(&followProfile);
+}
+
+bool pathFollowDone() {
+	return current == NULL;
+}
+
+void pathFollowStop() {
+	current = NULL;
+	motorGroupSet(&driveLeftMotors, 0);
+	motorGroupSet(&driveRightMotors, 0);
+}
@@ -0,0 +1,158 @@
+/** @file paths.c
+ * @brief Planned paths, generated by tools/pathgen.py; do not edit
+ */
+
+#include "main.h"
+
+static const PathPoint scoreCurvePoints[73] = {
+	{0, 0, 0},
+	{68077, 17, 517386},
+	{136288, 136, 732056},
+	{204741, 460, 897261},
+	{273515, 1091, 1037073},
+	{342662, 2133, 1160797},
+	{412210, 3688, 1273180},
+	{482160, 5857, 1310720},
+	{552495, 8743, 1310720},
+	{623173, 12444, 1310720},
+	{694137, 17059, 1310720},
+	{765308, 22685, 1310720},
+	{836594, 29415, 1310720},
+	{907888, 37343, 1310720},
+	{979068, 46557, 1310720},
+	{1050001, 57143, 1310720},
+	{1120545, 69185, 1310720},
+	{1190549, 82762, 1310720},
+	{1259854, 97950, 1310720},
+	{1328296, 114820, 1310720},
+	{1395706, 133440, 1310720},
+	{1461914, 153871, 1310720},
+	{1526749, 176170, 1310720},
+	{1590038, 200391, 1310720},
+	{1651613, 226578, 1310720},
+	{1711308, 254772, 1310720},
+	{1776017, 288931, 1310720},
+	{1837925, 325712, 1310720},
+	{1896824, 365142, 1310720},
+	{1952527, 407237, 1310720},
+	{2004860, 452001, 1310720},
+	{2053675, 499426, 1310720},
+	{2098847, 549489, 1310720},
+	{2140275, 602154, 1310720},
+	{2177892, 657374, 1310720},
+	{2211659, 715082, 1310720},
+	{2241577, 775200, 1310720},
+	{2267679, 837632, 1310720},
+	{2290043, 902265, 1310720},
+	{2308789, 968973, 1310720},
+	{2324082, 1037607, 1310720},
+	{2336137, 1108006, 1310720},
+	{2345219, 1179985, 1310720},
+	{2351649, 1253344, 1310720},
+	{2355441, 1319532, 1310720},
+	{2357739, 1386467, 1310720},
+	{2358885, 1453968, 1310720},
+	{2359263, 1521840, 1310720},
+	{2359296, 1591735, 1310720},
+	{2359296, 1657531, 1310720},
+	{2359296, 1727023, 1310720},
+	{2359296, 1794852, 1310720},
+	{2359296, 1860566, 1310720},
+	{2359296, 1928011, 1310720},
+	{2359296, 1996515, 1310720},
+	{2359296, 2065545, 1310720},
+	{2359296, 2131242, 1310720},
+	{2359296, 2197499, 1310720},
+	{2359296, 2264623, 1310720},
+	{2359296, 2333331, 1310720},
+	{2359296, 2401522, 1310720},
+	{2359296, 2467225, 1310720},
+	{2359296, 2534811, 1310720},
+	{2359296, 2601683, 1310720},
+	{2359296, 2668086, 1310720},
+	{2359296, 2733929, 1272501},
+	{2359296, 2803010, 1160872},
+	{2359296, 2870984, 1039393},
+	{2359296, 2937149, 905631},
+	{2359296, 3005353, 742953},
+	{2359296, 3075106, 526970},
+	{2359296, 3141009, 136213},
+	{2359296, 3145728, 0}
+};
+const Path scoreCurve = {scoreCurvePoints, 73};
+
+static const PathPoint backToStartPoints[72] = {
+	{2359296, 3145728, 0},
+	{2359296, 3079796, 509173},
+	{2359296, 3009961, 730656},
+	{2359296, 2941636, 895835},
+	{2359296, 2875324, 1031150},
+	{2359296, 2807175, 1153796},
+	{2359296, 2737902, 1266348},
+	{2359296, 2671872, 1310720},
+	{2359296, 2605289, 1310720},
+	{2359296, 2538259, 1310720},
+	{2359296, 2470551, 1310720},
+	{2359296, 2404780, 1310720},
+	{2359296, 2336579, 1310720},
+	{2359296, 2267927, 1310720},
+	{2359296, 2200912, 1310720},
+	{2359296, 2134803, 1310720},
+	{2359296, 2065545, 1310720},
+	{2359296, 1996515, 1310720},
+	{2359296, 1928011, 1310720},
+	{2359296, 1860566, 1310720},
+	{2359296, 1794852, 1310720},
+	{2359296, 1727023, 1310720},
+	{2359296, 1657531, 1310720},
+	{2359296, 1591735, 1310720},
+	{2359263, 1521840, 1310720},
+	{2358885, 1453968, 1310720},
+	{2357739, 1386467, 1310720},
+	{2355441, 1319532, 1310720},
+	{2351649, 1253344, 1310720},
+	{2345219, 1179985, 1310720},
+	{2336137, 1108006, 1310720},
+	{2324082, 1037607, 1310720},
+	{2308789, 968973, 1310720},
+	{2290043, 902265, 1310720},
+	{2267679, 837632, 1310720},
+	{2241577, 775200, 1310720},
+	{2211659, 715082, 1310720},
+	{2177892, 657374, 1310720},
+	{2140275, 602154, 1310720},
+	{2098847, 549489, 1310720},
+	{2053675, 499426, 1310720},
+	{2004860, 452001, 1310720},
+	{1952527, 407237, 1310720},
+	{1896824, 365142, 1310720},
+	{1837925, 325712, 1310720},
+	{1776017, 288931, 1310720},
+	{1711308, 254772, 1310720},
+	{1651613, 226578, 1310720},
+	{1590038, 200391, 1310720},
+	{1526749, 176170, 1310720},
+	{1461914, 153871, 1310720},
+	{1395706, 133440, 1310720},
+	{1328296, 114820, 1310720},
+	{1259854, 97950, 1310720},
+	{1190549, 82762, 1310720},
+	{1120545, 69185, 1310720},
+	{1050001, 57143, 1310720},
+	{979068, 46557, 1310720},
+	{907888, 37343, 1310720},
+	{836594, 29415, 1310720},
+	{765308, 22685, 1310720},
+	{694137, 17059, 1310720},
+	{623173, 12444, 1310720},
+	{552495, 8743, 1310720},
+	{482160, 5857, 1310720},
+	{412210, 3688, 1273180},
+	{342662, 2133, 1160797},
+	{273515, 1091, 1037073},
+	{204741, 460, 897261},
+	{136288, 136, 732056},
+	{68077, 17, 517386},
+	{0, 0, 0}
+};
+const Path backToStart = {backToStartPoints, 72};
@@ -0,0 +1,78 @@
+/** @file pid.c
+ * @brief Fixed-point PID controller
+ */
+
+#include "main.h"
+
+//Longest step integrated, in milliseconds; a task that was blocked for seconds, as by autotune
+//or a replay, would otherwise add the whole wait at the last error
+#define MAX_STEP 100
+//Most command the integral may contribute either way, about what the feedforward may be off by
+#define INTEGRAL_LIMIT 20
+
+void pidInit(Pid *pid, Fixed kP, Fixed kI, Fixed kD, ProfileSection *profile) {
+	pid->kP = kP;
+	pid->kI = kI;
+	pid->kD = kD;
+	pid->integral = 0;
+	pid->lastError = 0;
+	pid->started = false;
+	pid->profile = profile;
+}
+
+int pidStep(Pid *pid, int error, int feedforward, unsigned long elapsed) {
+	Fixed integral;
+	Fixed limit;
+	Fixed output;
+	int rate = 0;
+	int step;
+
+	profileBegin(pid->profile);
+	if(elapsed == 0) {
+		elapsed = 1;
+	}
+	if(pid->started) {
+		rate = (error - pid->lastError) * 1000 / (int)elapsed;
+		//Keep the rate within the Q16.16 integer range
+		if(rate > 32767) {
+			rate = 32767;
+		} else if(rate < -32767) {
+			rate = -32767;
+		}
+	}
+	pid->lastError = error;
+	pid->started = true;
+
+	integral = pid->integral;
+	//While the proportional term alone saturates it does the work, and what the integral built
+	//up on the way would carry the output past the setpoint
+	if(abs(fixedToInt(fixedMul(pid->kP, fixedFromInt(error)))) < 127) {
+		step = elapsed > MAX_STEP ? MAX_STEP : (int)elapsed;
+		integral = fixedAdd(integral, fixedMul(fixedFromInt(error), step * FIXED_ONE / 1000));
+	}
+	if(pid->kI > 0) {
+		limit = fixedDiv(fixedFromInt(INTEGRAL_LIMIT), pid->kI);
+		if(integral > limit) {
+			integral = limit;
+		} else if(integral < -limit) {
+			integral = -limit;
+		}
+	}
+	output = fixedAdd(fixedAdd(fixedMul(pid->kP, fixedFromInt(error)),
+		fixedMul(pid->kI, integral)), fixedMul(pid->kD, fixedFromInt(rate)));
+	output = fixedAdd(output, fixedFromInt(feedforward));
+
+	//Only integrate while the output is not saturated, so the integral cannot wind up
+	if(output < fixedFromInt(127) && output > fixedFromInt(-127)) {
+		pid->integral = integral;
+	}
+	profileEnd(pid->profile);
+
+	if(output > fixedFromInt(127)) {
+		return 127;
+	}
+	if(output < fixedFromInt(-127)) {
+		return -127;
+	}
+	return fixedToInt(output);
+}
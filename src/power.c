@@ -0,0 +1,265 @@
+/** @file power.c
+ * @brief Motor current, heating and PTC breaker model with power budgeting
+ *
+ * Each PTC is modeled as a first order filter on the square of its current; it trips when the
+ * filtered value reaches the square of its sustained trip current. Heat is tracked in mA^2.
+ *
+ * The brownout monitor filters the battery voltage and its slope with first order filters,
+ * and predicts the voltage at the horizon by carrying the slope forward when it is falling.
+ */
+
+#include "main.h"
+
+//Nominal voltage at which a 393 motor reaches free speed
+#define NOMINAL_MILLIVOLTS 7200
+//Winding resistance of a 393 motor in milliohms
+#define MOTOR_RESISTANCE 1500
+
+//Load percentages at which each priority starts being scaled and the floor it is scaled to.
+//Low priority outputs are off before medium ones are touched, and medium ones reach their floor
+//short of the trip point
+#define LOW_START 50
+#define LOW_END 75
+#define LOW_FLOOR 0
+#define MEDIUM_START 75
+#define MEDIUM_END 95
+#define MEDIUM_FLOOR 30
+
+//Brownout stages that shed load, each with its own ramp
+#define SHED_STAGES 3
+
+static int motorHeat[MOTOR_PORTS];
+static int bankHeat[POWER_BANKS];
+
+//Written by the sensing task, read by the control task
+static int voltage;
+static int slope;
+static volatile int predicted;
+static volatile int shedLevel;
+static volatile unsigned int brownouts;
+//Time the prediction has been clear of the current stage's threshold
+static unsigned long clearTime;
+//Share of each stage's load allowed, in thousandths so slow ramps are not lost to rounding
+static volatile int shedShare[SHED_STAGES] = {1000, 1000, 1000};
+//High priority outputs as last committed, for the drive acceleration limit
+static int lastHigh[MOTOR_PORTS];
+
+/**
+ * filterHeat()
+ * Moves a fuse's heat toward the square of its current by one time step.
+ */
+static int filterHeat(int heat, int current, unsigned long elapsed, int tau) {
+	int target = current * current;
+
+	if(elapsed > (unsigned long)tau) {
+		return target;
+	}
+	return heat + (target - heat) / tau * (int)elapsed;
+}
+
+/**
+ * bankOf()
+ * @return the Cortex bank a motor's current flows through, from the port it is mapped to
+ */
+static int bankOf(int motor) {
+	return (calibration->ports[motor] - 1) / 5;
+}
+
+/**
+ * scaleFor()
+ * Linearly scales from 100% at start down to floor at end.
+ */
+static int scaleFor(int load, int start, int end, int floor) {
+	if(load <= start) {
+		return 100;
+	}
+	if(load >= end) {
+		return floor;
+	}
+	return 100 - (100 - floor) * (load - start) / (end - start);
+}
+
+int powerMotorCurrent(int command, int measured, unsigned int batteryMillivolts) {
+	int applied;
+	int emf;
+	int current;
+	int stall;
+
+	if(command == 0) {		//Motor is coasting, the H-bridge is open
+		return 0;
+	}
+	applied = (int)batteryMillivolts * command / 127;
+	emf = NOMINAL_MILLIVOLTS * measured / 127;
+	current = abs(applied - emf) * 1000 / MOTOR_RESISTANCE;
+
+	stall = (int)batteryMillivolts * 1000 / MOTOR_RESISTANCE;
+	if(current > stall) {
+		current = stall;
+	}
+	return current;
+}
+
+void powerModelUpdate(const int *command, const int *measured, unsigned int batteryMillivolts,
+		unsigned long elapsed) {
+	int bankCurrent[POWER_BANKS] = {0, 0};
+	int current;
+	int i;
+
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		current = powerMotorCurrent(command[i], measured[i], batteryMillivolts);
+		motorHeat[i] = filterHeat(motorHeat[i], current, elapsed, POWER_MOTOR_TAU_MS);
+		bankCurrent[bankOf(i)] += current;
+	}
+	for(i = 0; i < POWER_BANKS; i++) {
+		bankHeat[i] = filterHeat(bankHeat[i], bankCurrent[i], elapsed, POWER_BANK_TAU_MS);
+	}
+}
+
+int powerMotorLoad(unsigned char channel) {
+	return motorHeat[channel - 1] / (POWER_MOTOR_TRIP_MA * POWER_MOTOR_TRIP_MA / 100);
+}
+
+int powerBankLoad(unsigned char bank) {
+	return bankHeat[bank] / (POWER_BANK_TRIP_MA * POWER_BANK_TRIP_MA / 100);
+}
+
+/**
+ * shedThreshold()
+ * @return the predicted voltage below which a stage is shed, in millivolts
+ */
+static int shedThreshold(int level) {
+	if(level == POWER_SHED_CLAW) {
+		return calibration->brownoutClaw;
+	}
+	if(level == POWER_SHED_LIFT) {
+		return calibration->brownoutLift;
+	}
+	return calibration->brownoutDrive;
+}
+
+/**
+ * shedRamp()
+ * Cuts the share of every shed stage to its floor and moves the rest back toward full.
+ */
+static void shedRamp(unsigned long elapsed) {
+	static const int floors[SHED_STAGES] = {
+		POWER_SHED_CLAW_FLOOR * 10, POWER_SHED_LIFT_FLOOR * 10, 0
+	};
+	int share;
+	int i;
+
+	for(i = 0; i < SHED_STAGES; i++) {
+		if(i < shedLevel) {
+			share = floors[i];
+		} else {
+			share = shedShare[i] + POWER_SHED_RESTORE * 10 * (int)elapsed / 1000;
+			if(share > 1000) {
+				share = 1000;
+			}
+		}
+		shedShare[i] = share;
+	}
+}
+
+void powerMonitorUpdate(unsigned int batteryMillivolts, unsigned long elapsed) {
+	int previous = voltage;
+	int filterTime = elapsed > POWER_VOLTAGE_TAU_MS ? POWER_VOLTAGE_TAU_MS : (int)elapsed;
+	int level = POWER_SHED_NONE;
+	int rate;
+
+	if(batteryMillivolts == 0 || elapsed == 0) {
+		return;
+	}
+	if(voltage == 0) {
+		voltage = (int)batteryMillivolts;
+		predicted = voltage;
+		return;
+	}
+	voltage += ((int)batteryMillivolts - voltage) * filterTime / POWER_VOLTAGE_TAU_MS;
+	//In millivolts per second
+	rate = (voltage - previous) * 1000 / (int)elapsed;
+	slope += (rate - slope) * filterTime / POWER_SLOPE_TAU_MS;
+	predicted = voltage + (slope < 0 ? slope * calibration->brownoutHorizon / 1000 : 0);
+
+	while(level < POWER_SHED_DRIVE && predicted < shedThreshold(level + 1)) {
+		level++;
+	}
+	if(level > shedLevel) {
+		if(shedLevel == POWER_SHED_NONE) {
+			brownouts++;
+		}
+		shedLevel = level;
+		clearTime = 0;
+	} else if(level < shedLevel && predicted >= shedThreshold(shedLevel) + POWER_SHED_HYSTERESIS) {
+		clearTime += elapsed;
+		if(clearTime >= POWER_SHED_HOLD) {
+			shedLevel--;
+			clearTime = 0;
+		}
+	} else {
+		clearTime = 0;
+	}
+	shedRamp(elapsed);
+}
+
+int powerShedLevel() {
+	return shedLevel;
+}
+
+int powerPredicted() {
+	return predicted;
+}
+
+unsigned int powerBrownouts() {
+	return brownouts;
+}
+
+void powerBudgetApply(int *command, const unsigned char *priority) {
+	int load;
+	int bank;
+	int step;
+	int i;
+
+	//Each commit may move a drive output this far while its acceleration is limited
+	step = 254;
+	if(shedShare[POWER_SHED_DRIVE - 1] < 1000) {
+		step = POWER_SHED_DRIVE_ACCEL * CONTROL_PERIOD / 1000 +
+			(254 - POWER_SHED_DRIVE_ACCEL * CONTROL_PERIOD / 1000) *
+			shedShare[POWER_SHED_DRIVE - 1] / 1000;
+	}
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		if(priority[i] == POWER_PRIORITY_HIGH) {
+			if(command[i] > lastHigh[i] + step) {
+				command[i] = lastHigh[i] + step;
+			} else if(command[i] < lastHigh[i] - step) {
+				command[i] = lastHigh[i] - step;
+			}
+			lastHigh[i] = command[i];
+			continue;
+		}
+		load = powerMotorLoad(i + 1);
+		bank = powerBankLoad(bankOf(i));
+		if(bank > load) {
+			load = bank;
+		}
+
+		if(priority[i] == POWER_PRIORITY_LOW) {
+			command[i] = command[i] * scaleFor(load, LOW_START, LOW_END, LOW_FLOOR) / 100 *
+				shedShare[POWER_SHED_CLAW - 1] / 1000;
+		} else {
+			command[i] = command[i] * scaleFor(load, MEDIUM_START, MEDIUM_END, MEDIUM_FLOOR) / 100 *
+				shedShare[POWER_SHED_LIFT - 1] / 1000;
+		}
+	}
+}
+
+void powerModelReset() {
+	int i;
+
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		motorHeat[i] = 0;
+	}
+	for(i = 0; i < POWER_BANKS; i++) {
+		bankHeat[i] = 0;
+	}
+}
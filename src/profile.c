@@ -0,0 +1,72 @@
+/** @file profile.c
+ * @brief On-robot timing of control code paths
+ */
+
+#include "main.h"
+
+static ProfileSection *sections[PROFILE_SECTIONS];
+static unsigned int sectionCount;
+
+void profileBegin(ProfileSection *section) {
+	if(!section->registered && sectionCount < PROFILE_SECTIONS) {
+		sections[sectionCount++] = section;
+		section->registered = true;
+	}
+	section->start = micros();
+}
+
+unsigned long profileEnd(ProfileSection *section) {
+	unsigned long elapsed = micros() - section->start;
+	unsigned int bucket = 0;
+
+	section->count++;
+	section->total += elapsed;
+	if(elapsed < section->min) {
+		section->min = elapsed;
+	}
+	if(elapsed > section->max) {
+		section->max = elapsed;
+	}
+	while(bucket < PROFILE_BUCKETS - 1 && elapsed >= (1UL << bucket)) {
+		bucket++;
+	}
+	section->histogram[bucket]++;
+	return elapsed;
+}
+
+void profileReport(FILE *stream) {
+	ProfileSection *section;
+	unsigned int i;
+	unsigned int b;
+
+	fprintf(stream, "{\"millis\":%lu,\"sections\":[", millis());
+	for(i = 0; i < sectionCount; i++) {
+		section = sections[i];
+		fprintf(stream, "%s{\"name\":\"%s\",\"count\":%lu,\"totalUs\":%lu,\"minUs\":%lu,"
+			"\"maxUs\":%lu,\"meanUs\":%lu,\"histogram\":[", i == 0 ? "" : ",", section->name,
+			section->count, section->total, section->count ? section->min : 0, section->max,
+			section->count ? section->total / section->count : 0);
+		for(b = 0; b < PROFILE_BUCKETS; b++) {
+			fprintf(stream, b == 0 ? "%lu" : ",%lu", section->histogram[b]);
+		}
+		fprintf(stream, "]}");
+	}
+	fprintf(stream, "]}\r\n");
+}
+
+void profileReset() {
+	ProfileSection *section;
+	unsigned int i;
+	unsigned int b;
+
+	for(i = 0; i < sectionCount; i++) {
+		section = sections[i];
+		section->count = 0;
+		section->total = 0;
+		section->min = 0xFFFFFFFF;
+		section->max = 0;
+		for(b = 0; b < PROFILE_BUCKETS; b++) {
+			section->histogram[b] = 0;
+		}
+	}
+}
@@ -0,0 +1,162 @@
+/** @file range.c
+ * @brief Ultrasonic range sensors
+ */
+
+#include "main.h"
+
+//Widest angle between the sensor and the wall normal that still returns an echo
+#define SIM_CONE FIXED(0.52)
+//One reading in this many is lost in the model, and one in this many is a stray short echo
+#define SIM_MISS_ONE_IN 16
+#define SIM_STRAY_ONE_IN 23
+#define SIM_STRAY_CM 12
+
+/**
+ * Filter state of one sensor
+ */
+typedef struct {
+	//Last kept readings in centimeters, oldest first
+	int window[3];
+	unsigned char count;
+	unsigned char misses;
+	unsigned char rejected;
+	int distance;
+} RangeFilter;
+
+static Ultrasonic leftSonar;
+static Ultrasonic rightSonar;
+static RangeFilter leftFilter;
+static RangeFilter rightFilter;
+static unsigned long lastReading;
+
+static volatile bool simulating;
+static volatile Fixed simWallX;
+static unsigned int simSeed = 1;
+
+/**
+ * median3()
+ * @return the middle one of three values
+ */
+static int median3(int a, int b, int c) {
+	if(a > b) {
+		int t = a;
+		a = b;
+		b = t;
+	}
+	return c < a ? a : (c > b ? b : c);
+}
+
+/**
+ * rangeFilter()
+ * Adds one raw reading to a sensor's filter and updates its distance.
+ *
+ * @param filter the sensor's filter
+ * @param reading the raw reading in centimeters, 0 or less for no echo
+ */
+static void rangeFilter(RangeFilter *filter, int reading) {
+	if(reading <= 0 || reading > RANGE_MAX) {
+		if(filter->misses < RANGE_MISSES) {
+			filter->misses++;
+		}
+		if(filter->misses >= RANGE_MISSES) {
+			filter->count = 0;
+			filter->distance = RANGE_NONE;
+		}
+		return;
+	}
+	filter->misses = 0;
+
+	//A reading far from the median is kept only once it repeats, as when the target moves
+	if(filter->count == 3 && abs(reading - filter->distance) > RANGE_JUMP &&
+			filter->rejected < 2) {
+		filter->rejected++;
+		return;
+	}
+	filter->rejected = 0;
+
+	if(filter->count == 3) {
+		filter->window[0] = filter->window[1];
+		filter->window[1] = filter->window[2];
+		filter->window[2] = reading;
+	} else {
+		filter->window[filter->count++] = reading;
+	}
+	if(filter->count == 3) {
+		filter->distance = median3(filter->window[0], filter->window[1], filter->window[2]);
+	} else {
+		filter->distance = reading;
+	}
+}
+
+/**
+ * simRandom()
+ * @return a pseudo-random number from 0 to 32767 for the sensor model
+ */
+static unsigned int simRandom() {
+	simSeed = simSeed * 1103515245 + 12345;
+	return (simSeed >> 16) & 0x7FFF;
+}
+
+/**
+ * simReading()
+ * Models one sensor looking at the wall from the current odometry pose.
+ *
+ * @param lateral the sensor's offset to the left of the robot center in inches
+ * @return the reading the sensor would give in centimeters, 0 for no echo
+ */
+static int simReading(Fixed lateral) {
+	Pose pose;
+	Fixed cosine, sine, sensorX, inches;
+	int cm;
+
+	odometryGet(&pose);
+	cosine = fixedCos(pose.heading);
+	sine = fixedSin(pose.heading);
+	sensorX = pose.x - fixedMul(lateral, sine);
+
+	//Past the cone the echo glances off the wall and never returns
+	if(cosine < fixedCos(SIM_CONE) || sensorX >= simWallX) {
+		return 0;
+	}
+	if(simRandom() % SIM_MISS_ONE_IN == 0) {
+		return 0;
+	}
+	if(simRandom() % SIM_STRAY_ONE_IN == 0) {
+		return SIM_STRAY_CM;
+	}
+
+	//Distance along the beam, to the nearest centimeter with a centimeter of noise
+	inches = fixedDiv(simWallX - sensorX, cosine);
+	cm = fixedToInt(fixedMul(inches, FIXED(2.54)) + FIXED(0.5));
+	return cm + (int)(simRandom() % 3) - 1;
+}
+
+void rangeInit() {
+	leftSonar = ultrasonicInit(RANGE_LEFT_ECHO, RANGE_LEFT_PING);
+	rightSonar = ultrasonicInit(RANGE_RIGHT_ECHO, RANGE_RIGHT_PING);
+	leftFilter.distance = RANGE_NONE;
+	rightFilter.distance = RANGE_NONE;
+}
+
+void rangeUpdate(unsigned long now, int *left, int *right) {
+	if(now - lastReading >= RANGE_PERIOD) {
+		lastReading = now;
+		if(simulating) {
+			//Half the spacing, converted to inches
+			Fixed half = FIXED(RANGE_SPACING / 2 / 2.54);
+
+			rangeFilter(&leftFilter, simReading(half));
+			rangeFilter(&rightFilter, simReading(-half));
+		} else {
+			rangeFilter(&leftFilter, ultrasonicGet(leftSonar));
+			rangeFilter(&rightFilter, ultrasonicGet(rightSonar));
+		}
+	}
+	*left = leftFilter.distance;
+	*right = rightFilter.distance;
+}
+
+void rangeSimulate(bool simulate, Fixed wallX) {
+	simWallX = wallX;
+	simulating = simulate;
+}
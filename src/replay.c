@@ -0,0 +1,290 @@
+/** @file replay.c
+ * @brief Record and replay of operator control for regression checks
+ */
+
+#include "main.h"
+
+//Fields in a recorded line after the "F": the time, 8 per joystick, then the rest
+#define JOYSTICK_FIELDS (8 * DRIVER_JOYSTICKS)
+#define FIELDS (9 + JOYSTICK_FIELDS + MOTOR_PORTS)
+//Index of the first field after the joysticks
+#define REST (1 + JOYSTICK_FIELDS)
+
+/**
+ * One recorded iteration, queued for the shell task to send
+ */
+typedef struct {
+	DriverInput input;
+	unsigned long stepMicros;
+	signed char motors[MOTOR_PORTS];
+	//Iterations dropped from a full queue before this one
+	unsigned char dropped;
+} ReplayFrame;
+
+//Filled by the operator control task and emptied by the shell task
+static Ring queue;
+//Written by the operator control task only
+static unsigned char dropped;
+
+//Owned by the sending task: the fields of the last line sent, which the next leaves out if the
+//same, and the drop count it was sent after
+static long sent[FIELDS];
+static bool sentAny;
+static unsigned char sentDropped;
+static ReplayFrame pending;
+static bool hasPending;
+
+//Owned by the replaying task
+static long fields[FIELDS];
+static bool primed;
+static bool resetNext;
+static unsigned long stepTotal;
+static unsigned long recordedTotal;
+static unsigned int frames;
+static unsigned int mismatches;
+static unsigned int gaps;
+
+void replayInit() {
+	ringInit(&queue, "replay", sizeof(ReplayFrame), REPLAY_QUEUE);
+}
+
+void replayRecord(const DriverInput *input, unsigned long stepMicros) {
+	ReplayFrame frame;
+	int i;
+
+	frame.input = *input;
+	frame.stepMicros = stepMicros;
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		frame.motors[i] = (signed char)motorFrameGet(i + 1);
+	}
+	frame.dropped = dropped;
+	//Never wait on the console; the replay sees the gap instead
+	if(!ringPush(&queue, &frame)) {
+		dropped++;
+	}
+}
+
+/**
+ * frameFields()
+ * Lays a frame out in the order of a recorded line.
+ */
+static void frameFields(const ReplayFrame *frame, long *out) {
+	const DriverInput *input = &frame->input;
+	int joystick;
+	int i;
+
+	out[0] = (long)input->time;
+	for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+		for(i = 0; i < 4; i++) {
+			out[1 + 8 * joystick + i] = input->analog[joystick][i];
+			out[5 + 8 * joystick + i] = input->buttons[joystick][i];
+		}
+	}
+	out[REST] = input->connected;
+	out[REST + 1] = input->leftTicks;
+	out[REST + 2] = input->rightTicks;
+	out[REST + 3] = input->liftTicks;
+	out[REST + 4] = input->liftTwist;
+	out[REST + 5] = input->battery;
+	out[REST + 6] = input->held;
+	out[REST + 7] = (long)frame->stepMicros;
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		out[REST + 8 + i] = frame->motors[i];
+	}
+}
+
+bool replayNextLine(char *line, unsigned int size) {
+	long values[FIELDS];
+	unsigned int missed;
+	unsigned int used;
+	int i;
+
+	if(!hasPending && !ringPop(&queue, &pending)) {
+		return false;
+	}
+	hasPending = true;
+	//Iterations went missing before this one: say so, and send it in full after
+	if(pending.dropped != sentDropped) {
+		missed = (unsigned char)(pending.dropped - sentDropped);
+		snprintf(line, size, "G,%u", missed);
+		sentDropped = pending.dropped;
+		sentAny = false;
+		return true;
+	}
+	hasPending = false;
+
+	frameFields(&pending, values);
+	used = snprintf(line, size, "F");
+	for(i = 0; i < FIELDS && used < size; i++) {
+		if(sentAny && values[i] == sent[i]) {
+			used += snprintf(line + used, size - used, ",");
+		} else {
+			used += snprintf(line + used, size - used, ",%ld", values[i]);
+		}
+		sent[i] = values[i];
+	}
+	sentAny = true;
+	return true;
+}
+
+void replaySend() {
+	char line[REPLAY_LINE];
+
+	while(replayNextLine(line, sizeof(line))) {
+		printf("%s\r\n", line);
+	}
+}
+
+/**
+ * parseLine()
+ * Reads a recorded line's fields over those of the line before, which stand for the ones it
+ * leaves empty.
+ *
+ * @return true if the line held a complete frame
+ */
+static bool parseLine(char *line) {
+	long values[FIELDS];
+	char *next;
+	int i;
+
+	if(line[0] != 'F' || line[1] != ',') {
+		return false;
+	}
+	line += 2;
+	for(i = 0; i < FIELDS; i++) {
+		if(*line == ',' || *line == '\r' || *line == '\n' || *line == '\0') {
+			//Left out as unchanged, which needs a line before it
+			if(!primed) {
+				return false;
+			}
+			values[i] = fields[i];
+			next = line;
+		} else {
+			values[i] = strtol(line, &next, 10);
+			if(next == line) {
+				return false;
+			}
+		}
+		line = (*next == ',') ? next + 1 : next;
+	}
+	for(i = 0; i < FIELDS; i++) {
+		fields[i] = values[i];
+	}
+	primed = true;
+	return true;
+}
+
+/**
+ * groupHas()
+ * @return true if a motor group drives a port
+ */
+static bool groupHas(const MotorGroup *group, int port) {
+	int i;
+
+	for(i = 0; i < group->count; i++) {
+		if(group->ports[i] == port) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * portHeld()
+ * @return true if a port belongs to a mechanism held by a command, which driverStep() leaves to
+ * the control task and so cannot be compared on replay
+ */
+static bool portHeld(unsigned char held, int port) {
+	return ((held & COMMAND_DRIVE) && (groupHas(&driveLeftMotors, port) ||
+		groupHas(&driveRightMotors, port))) ||
+		((held & COMMAND_LIFT) && groupHas(&liftMotors, port)) ||
+		((held & COMMAND_CLAW) && groupHas(&clawMotors, port));
+}
+
+void replayBegin() {
+	primed = false;
+	resetNext = true;
+	stepTotal = 0;
+	recordedTotal = 0;
+	frames = 0;
+	mismatches = 0;
+	gaps = 0;
+}
+
+void replayLine(char *line) {
+	DriverInput input;
+	unsigned long start;
+	int port;
+	int actual;
+	int joystick;
+	int i;
+
+	if(line[0] == 'G' && line[1] == ',') {
+		//The driver code's state from before the gap is gone; start again from the next frame
+		gaps++;
+		primed = false;
+		resetNext = true;
+		return;
+	}
+	if(!parseLine(line)) {
+		return;
+	}
+	input.time = fields[0];
+	for(joystick = 0; joystick < DRIVER_JOYSTICKS; joystick++) {
+		for(i = 0; i < 4; i++) {
+			input.analog[joystick][i] = fields[1 + 8 * joystick + i];
+			input.buttons[joystick][i] = fields[5 + 8 * joystick + i];
+		}
+	}
+	input.connected = fields[REST];
+	input.leftTicks = fields[REST + 1];
+	input.rightTicks = fields[REST + 2];
+	input.liftTicks = fields[REST + 3];
+	input.liftTwist = fields[REST + 4];
+	input.battery = fields[REST + 5];
+	input.held = fields[REST + 6];
+	if(resetNext) {
+		driverReset(&input);
+		resetNext = false;
+	}
+
+	start = micros();
+	driverStep(&input);
+	stepTotal += micros() - start;
+	recordedTotal += fields[REST + 7];
+
+	for(port = 1; port <= MOTOR_PORTS; port++) {
+		if(portHeld(input.held, port)) {
+			continue;
+		}
+		actual = motorFrameGet(port);
+		if(actual != fields[REST + 7 + port]) {
+			printf("D,%u,%d,%ld,%d\r\n", frames, port, fields[REST + 7 + port], actual);
+			mismatches++;
+		}
+	}
+	frames++;
+}
+
+bool replayEnd() {
+	bool timingRegression = stepTotal * 100 > recordedTotal * (100 + REPLAY_TIMING_TOLERANCE);
+
+	printf("{\"frames\":%u,\"mismatches\":%u,\"gaps\":%u,\"stepUs\":%lu,\"recordedStepUs\":%lu,"
+		"\"timingRegression\":%s}\r\n", frames, mismatches, gaps, stepTotal, recordedTotal,
+		timingRegression ? "true" : "false");
+	return frames > 0 && mismatches == 0 && gaps == 0 && !timingRegression;
+}
+
+bool replayRun() {
+	char line[REPLAY_LINE];
+
+	//The recording comes in on the shell's console
+	shellSuspend(true);
+	printf("replay ready\r\n");
+	replayBegin();
+	while(fgets(line, REPLAY_LINE, stdin) != NULL && line[0] != 'E') {
+		replayLine(line);
+	}
+	shellSuspend(false);
+	return replayEnd();
+}
@@ -0,0 +1,86 @@
+/** @file selftest.c
+ * @brief Subsystem self-tests
+ */
+
+#include "main.h"
+
+//Which snapshot reading each mechanism test watches
+#define READ_LEFT 0
+#define READ_RIGHT 1
+#define READ_LIFT 2
+
+typedef struct {
+	const char *name;
+	const MotorGroup *motors;
+	unsigned char reading;
+} MechanismTest;
+
+static const MechanismTest tests[] = {
+	{"driveLeft", &driveLeftMotors, READ_LEFT},
+	{"driveRight", &driveRightMotors, READ_RIGHT},
+	{"lift", &liftMotors, READ_LIFT}
+};
+
+static volatile bool active;
+
+/**
+ * reading()
+ * @return the snapshot value a test watches
+ */
+static int reading(const SensorSnapshot *sensors, unsigned char which) {
+	switch(which) {
+	case READ_LEFT:
+		return sensors->leftTicks;
+	case READ_RIGHT:
+		return sensors->rightTicks;
+	default:
+		return sensors->liftTicks;
+	}
+}
+
+bool selftestRun(FILE *stream) {
+	SensorSnapshot before;
+	SensorSnapshot after;
+	unsigned int i;
+	int ticks;
+	bool pass;
+	bool allPass;
+
+	if(isAutonomous()) {
+		return false;
+	}
+	active = true;
+	pathFollowStop();
+	liftControlStop();
+	//Let the driver loop see the test has started before taking the motors
+	delay(40);
+
+	sensorsGet(&before);
+	allPass = before.battery >= SELFTEST_MIN_BATTERY;
+	fprintf(stream, "{\"selftest\":[{\"name\":\"battery\",\"millivolts\":%u,\"pass\":%s}",
+		before.battery, allPass ? "true" : "false");
+
+	for(i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+		sensorsGet(&before);
+		motorGroupSet(tests[i].motors, SELFTEST_POWER);
+		delay(SELFTEST_TIME);
+		motorGroupSet(tests[i].motors, 0);
+		//Coast to a stop so the next test starts still
+		delay(SELFTEST_TIME);
+		sensorsGet(&after);
+
+		ticks = reading(&after, tests[i].reading) - reading(&before, tests[i].reading);
+		pass = ticks >= SELFTEST_MIN_TICKS;
+		allPass = allPass && pass;
+		fprintf(stream, ",{\"name\":\"%s\",\"ticks\":%d,\"pass\":%s}", tests[i].name, ticks,
+			pass ? "true" : "false");
+	}
+	fprintf(stream, "],\"pass\":%s}\r\n", allPass ? "true" : "false");
+
+	active = false;
+	return allPass;
+}
+
+bool selftestActive() {
+	return active;
+}
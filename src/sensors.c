@@ -0,0 +1,108 @@
+/** @file sensors.c
+ * @brief Robot sensors and the shared sensor snapshot
+ */
+
+#include "main.h"
+
+//Read only by the sensing task, and never reset
+static Encoder encoders[SENSORS_ENCODERS];
+//Last encoderGet() of each encoder, and the counts accumulated from them
+static int raw[SENSORS_ENCODERS];
+static long long counts[SENSORS_ENCODERS];
+
+//Written by the sensing task only
+static Seqlock latest;
+static SensorSnapshot previous;
+//Bottom of the lift on each side, and the potentiometer reading there
+static EncoderMark liftZero;
+static EncoderMark liftRightZero;
+static int potZero;
+static volatile bool liftZeroRequested;
+
+/**
+ * liftRight()
+ * @return the height of the right side of the lift in lift encoder ticks, or left if it has no
+ * sensor
+ */
+static int liftRight(int left, const SensorSnapshot *sample) {
+	switch(calibration->liftSensor) {
+	case LIFT_SENSOR_POT:
+		return fixedToInt(fixedMul(fixedFromInt(analogRead(LIFT_POT_PORT) - potZero),
+			calibration->liftPotScale));
+	case LIFT_SENSOR_ENCODER:
+		return sensorsSinceMark(&liftRightZero, sample);
+	default:
+		return left;
+	}
+}
+
+void sensorsInit() {
+	encoders[SENSORS_LEFT] = encoderInit(1, 2, 0);
+	encoders[SENSORS_RIGHT] = encoderInit(3, 4, 0);
+	encoders[SENSORS_LIFT] = encoderInit(5, 6, 0);
+	if(calibration->liftSensor == LIFT_SENSOR_ENCODER) {
+		//Mounted facing the other way to the left one
+		encoders[SENSORS_LIFT_RIGHT] = encoderInit(LIFT_ENCODER_TOP, LIFT_ENCODER_BOTTOM, 1);
+	}
+	seqlockInit(&latest, sizeof(SensorSnapshot));
+	yawInit();
+	rangeInit();
+	//The lift starts down
+	sensorsLiftZero();
+	sensorsUpdate();
+}
+
+void sensorsLiftZero() {
+	liftZeroRequested = true;
+}
+
+void sensorsUpdate() {
+	SensorSnapshot sample;
+	unsigned int i;
+	int value;
+
+	sample.time = millis();
+	for(i = 0; i < SENSORS_ENCODERS; i++) {
+		if(encoders[i] != NULL) {
+			//Unsigned, so a wrap of the 32-bit counter still gives the right difference
+			value = encoderGet(encoders[i]);
+			counts[i] += (int)((unsigned int)value - (unsigned int)raw[i]);
+			raw[i] = value;
+		}
+		sample.counts[i] = counts[i];
+	}
+	sample.leftTicks = (int)counts[SENSORS_LEFT];
+	sample.rightTicks = (int)counts[SENSORS_RIGHT];
+
+	if(liftZeroRequested) {
+		sensorsMark(&liftZero, SENSORS_LIFT, &sample);
+		sensorsMark(&liftRightZero, SENSORS_LIFT_RIGHT, &sample);
+		potZero = analogRead(LIFT_POT_PORT);
+		liftZeroRequested = false;
+	}
+	sample.liftLeftTicks = sensorsSinceMark(&liftZero, &sample);
+	sample.liftRightTicks = liftRight(sample.liftLeftTicks, &sample);
+	sample.liftTicks = (sample.liftLeftTicks + sample.liftRightTicks) / 2;
+	sample.battery = powerLevelMain();
+
+	yawUpdate(sample.time - previous.time, sample.leftTicks == previous.leftTicks &&
+		sample.rightTicks == previous.rightTicks);
+	sample.heading = yawHeading();
+	rangeUpdate(sample.time, &sample.rangeLeft, &sample.rangeRight);
+
+	seqlockWrite(&latest, &sample);
+	previous = sample;
+}
+
+void sensorsGet(SensorSnapshot *snapshot) {
+	seqlockRead(&latest, snapshot);
+}
+
+void sensorsMark(EncoderMark *mark, SensorsEncoder encoder, const SensorSnapshot *sensors) {
+	mark->encoder = encoder;
+	mark->zero = sensors->counts[encoder];
+}
+
+int sensorsSinceMark(const EncoderMark *mark, const SensorSnapshot *sensors) {
+	return (int)(sensors->counts[mark->encoder] - mark->zero);
+}
@@ -0,0 +1,277 @@
+/** @file shell.c
+ * @brief Command shell on the USB serial console
+ */
+
+#include "main.h"
+#include <string.h>
+
+typedef struct {
+	const char *name;
+	const char *help;
+	void (*run)(int argc, char **argv);
+} ShellCommand;
+
+static void helpCommand(int argc, char **argv);
+static void sensorsCommand(int argc, char **argv);
+static void calCommand(int argc, char **argv);
+static void setCommand(int argc, char **argv);
+static void saveCommand(int argc, char **argv);
+static void profileCommand(int argc, char **argv);
+static void tasksCommand(int argc, char **argv);
+static void memoryCommand(int argc, char **argv);
+static void powerCommand(int argc, char **argv);
+static void selftestCommand(int argc, char **argv);
+static void telemetryCommand(int argc, char **argv);
+static void commandsCommand(int argc, char **argv);
+static void rangesimCommand(int argc, char **argv);
+static void modeCommand(int argc, char **argv);
+static void autoCommand(int argc, char **argv);
+static void fixedbenchCommand(int argc, char **argv);
+
+static const ShellCommand commands[] = {
+	{"help", "list commands", helpCommand},
+	{"sensors", "print the sensor snapshot", sensorsCommand},
+	{"cal", "print the calibration", calCommand},
+	{"set", "<field> <value>: change a calibration field", setCommand},
+	{"save", "write the calibration to flash", saveCommand},
+	{"profile", "[reset]: print or clear the timing histograms", profileCommand},
+	{"tasks", "print task stack use", tasksCommand},
+	{"memory", "print arena use and container high-water marks", memoryCommand},
+	{"power", "print the modeled motor and bank loads and the brownout state", powerCommand},
+	{"selftest", "drive each mechanism briefly and check its sensor", selftestCommand},
+	{"telemetry", "[<rate>|off]: stream T lines at a rate per second, or print binary "
+		"samples dropped", telemetryCommand},
+	{"commands", "print the scheduled commands", commandsCommand},
+	{"rangesim", "<inches>|off: model a wall ahead of the odometry origin in place of the "
+		"ultrasonics", rangesimCommand},
+	{"mode", "print the mode and the autonomous handover latencies", modeCommand},
+	{"auto", "[<routine>]: pick the autonomous routine, or list them", autoCommand},
+	{"fixedbench", "time the fixed-point math against soft-float", fixedbenchCommand}
+};
+
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+static char line[SHELL_LINE];
+static unsigned int lineLength;
+static bool overflow;
+static volatile bool suspended;
+static unsigned long telemetryInterval;
+static unsigned long lastTelemetry;
+
+static void helpCommand(int argc, char **argv) {
+	unsigned int i;
+
+	for(i = 0; i < COMMAND_COUNT; i++) {
+		printf("%-10s%s\r\n", commands[i].name, commands[i].help);
+	}
+}
+
+static void sensorsCommand(int argc, char **argv) {
+	SensorSnapshot sensors;
+
+	sensorsGet(&sensors);
+	printf("{\"time\":%lu,\"left\":%d,\"right\":%d,\"lift\":%d,\"liftLeft\":%d,"
+		"\"liftRight\":%d,\"battery\":%u,\"headingMrad\":%d,\"rangeLeft\":%d,"
+		"\"rangeRight\":%d}\r\n", sensors.time, sensors.leftTicks, sensors.rightTicks,
+		sensors.liftTicks, sensors.liftLeftTicks, sensors.liftRightTicks, sensors.battery,
+		fixedToInt(fixedMul(sensors.heading, FIXED(1000.0))), sensors.rangeLeft,
+		sensors.rangeRight);
+}
+
+static void calCommand(int argc, char **argv) {
+	calibrationPrint(stdout);
+}
+
+static void setCommand(int argc, char **argv) {
+	int field;
+
+	if(argc != 3) {
+		printf("usage: set <field> <value>\r\n");
+		return;
+	}
+	field = calibrationFieldFind(argv[1]);
+	if(field < 0) {
+		printf("no field %s\r\n", argv[1]);
+	} else if(!calibrationFieldSet(field, argv[2])) {
+		printf("bad value %s\r\n", argv[2]);
+	}
+}
+
+static void saveCommand(int argc, char **argv) {
+	printf(calibrationSave() ? "saved\r\n" : "save failed\r\n");
+}
+
+static void profileCommand(int argc, char **argv) {
+	if(argc > 1 && strcmp(argv[1], "reset") == 0) {
+		profileReset();
+	} else {
+		profileReport(stdout);
+	}
+}
+
+static void tasksCommand(int argc, char **argv) {
+	tasksReport(stdout);
+}
+
+static void memoryCommand(int argc, char **argv) {
+	arenaReport(stdout);
+}
+
+static void powerCommand(int argc, char **argv) {
+	int i;
+
+	printf("{\"motors\":[");
+	for(i = 1; i <= MOTOR_PORTS; i++) {
+		printf("%s%d", i == 1 ? "" : ",", powerMotorLoad(i));
+	}
+	printf("],\"banks\":[");
+	for(i = 0; i < POWER_BANKS; i++) {
+		printf("%s%d", i == 0 ? "" : ",", powerBankLoad(i));
+	}
+	printf("],\"brownout\":{\"stage\":%d,\"predicted\":%d,\"events\":%u}}\r\n",
+		powerShedLevel(), powerPredicted(), powerBrownouts());
+}
+
+static void selftestCommand(int argc, char **argv) {
+	if(isAutonomous()) {
+		printf("not during autonomous\r\n");
+		return;
+	}
+	selftestRun(stdout);
+}
+
+static void telemetryCommand(int argc, char **argv) {
+	int rate;
+
+	if(argc == 1) {
+		printf("{\"dropped\":%u}\r\n", telemetryDropped());
+		return;
+	}
+	rate = strcmp(argv[1], "off") == 0 ? 0 : atoi(argv[1]);
+	telemetryInterval = rate > 0 ? 1000 / rate : 0;
+}
+
+static void commandsCommand(int argc, char **argv) {
+	commandReport(stdout);
+}
+
+static void rangesimCommand(int argc, char **argv) {
+	if(argc != 2) {
+		printf("usage: rangesim <inches>|off\r\n");
+	} else if(strcmp(argv[1], "off") == 0) {
+		rangeSimulate(false, 0);
+	} else {
+		rangeSimulate(true, fixedFromInt(atoi(argv[1])));
+	}
+}
+
+static void modeCommand(int argc, char **argv) {
+	modeReport(stdout);
+}
+
+static void autoCommand(int argc, char **argv) {
+	const char *name;
+	unsigned int i;
+
+	if(argc > 2) {
+		printf("usage: auto [<routine>]\r\n");
+		return;
+	}
+	if(argc == 2 && !autonomousSelect(argv[1])) {
+		printf("no routine %s\r\n", argv[1]);
+	}
+	for(i = 0; (name = autonomousName(i)) != NULL; i++) {
+		printf("%c %s\r\n", strcmp(name, autonomousSelected()) == 0 ? '*' : ' ', name);
+	}
+}
+
+static void fixedbenchCommand(int argc, char **argv) {
+	fixedBenchmark(stdout);
+}
+
+/**
+ * telemetryLine()
+ * Writes one text telemetry line.
+ */
+static void telemetryLine() {
+	SensorSnapshot sensors;
+	int i;
+
+	sensorsGet(&sensors);
+	printf("T,%lu,%d,%d,%d,%u", sensors.time, sensors.leftTicks, sensors.rightTicks,
+		sensors.liftTicks, sensors.battery);
+	for(i = 1; i <= MOTOR_PORTS; i++) {
+		printf(",%d", motorFrameGet(i));
+	}
+	printf("\r\n");
+}
+
+/**
+ * execute()
+ * Splits a line into words in place and runs its command.
+ */
+static void execute(char *text) {
+	char *argv[SHELL_ARGS];
+	int argc = 0;
+	unsigned int i;
+
+	while(*text != '\0') {
+		while(*text == ' ') {
+			*text++ = '\0';
+		}
+		if(*text == '\0') {
+			break;
+		}
+		if(argc == SHELL_ARGS) {
+			printf("too many words\r\n");
+			return;
+		}
+		argv[argc++] = text;
+		while(*text != ' ' && *text != '\0') {
+			text++;
+		}
+	}
+	if(argc == 0) {
+		return;
+	}
+	for(i = 0; i < COMMAND_COUNT; i++) {
+		if(strcmp(commands[i].name, argv[0]) == 0) {
+			commands[i].run(argc, argv);
+			return;
+		}
+	}
+	printf("unknown command %s, try help\r\n", argv[0]);
+}
+
+void shellPoll() {
+	unsigned long now = millis();
+	int c;
+
+	//Only read what has arrived, so the task never waits on the console
+	while(!suspended && fcount(stdin) > 0) {
+		c = fgetc(stdin);
+		if(c == '\r' || c == '\n') {
+			line[lineLength] = '\0';
+			if(overflow) {
+				printf("line too long\r\n");
+			} else {
+				execute(line);
+			}
+			lineLength = 0;
+			overflow = false;
+		} else if(lineLength < SHELL_LINE - 1) {
+			line[lineLength++] = (char)c;
+		} else {
+			overflow = true;
+		}
+	}
+
+	if(telemetryInterval > 0 && now - lastTelemetry >= telemetryInterval) {
+		lastTelemetry = now;
+		telemetryLine();
+	}
+}
+
+void shellSuspend(bool suspend) {
+	suspended = suspend;
+}
@@ -0,0 +1,213 @@
+/** @file tasks.c
+ * @brief Task plan for the robot subsystems
+ */
+
+#include "main.h"
+
+//Value written over unused stack so the high-water mark can be found later
+#define STACK_PAINT 0xA5A5A5A5
+//Words left unpainted below the painting frame, room for an exception entry frame
+#define PAINT_GAP 16
+//Words left unpainted at the bottom, covering the frames above the painting frame
+#define PAINT_SLACK 32
+//Stack of the PROS operatorControl() and autonomous() tasks
+#define PROS_TASK_STACKS 2
+
+typedef struct {
+	const char *name;
+	TaskCode code;
+	unsigned int stackDepth;
+	unsigned int priority;
+	TaskHandle handle;
+	unsigned int *paintBottom;
+	unsigned int paintWords;
+} TaskPlan;
+
+static void controlTask(void *param);
+static void sensingTask(void *param);
+static void routineTask(void *param);
+static void displayTask(void *param);
+static void shellTask(void *param);
+static void telemetryTask(void *param);
+
+static TaskPlan plan[] = {
+	{"control", controlTask, CONTROL_STACK, TASK_PRIORITY_HIGHEST, NULL, NULL, 0},
+	{"sensing", sensingTask, SENSING_STACK, TASK_PRIORITY_HIGHEST - 1, NULL, NULL, 0},
+	{"routine", routineTask, ROUTINE_STACK, TASK_PRIORITY_DEFAULT, NULL, NULL, 0},
+	{"telemetry", telemetryTask, TELEMETRY_STACK, TASK_PRIORITY_LOWEST + 1, NULL, NULL, 0},
+	{"display", displayTask, DISPLAY_STACK, TASK_PRIORITY_LOWEST, NULL, NULL, 0},
+	{"shell", shellTask, SHELL_STACK, TASK_PRIORITY_LOWEST, NULL, NULL, 0}
+};
+
+#define PLAN_TASKS (sizeof(plan) / sizeof(plan[0]))
+
+//Bounds of the RAM left to the FreeRTOS heap, from the linker scripts
+extern char _heapbegin;
+extern char _estack;
+
+static ProfileSection lcdProfile = PROFILE_SECTION("lcdPrint");
+static const char *volatile status;
+static volatile bool zeroRequested = true;
+
+/**
+ * stackPaint()
+ * Fills the unused part of the calling task's stack with STACK_PAINT.
+ */
+static void __attribute__((noinline)) stackPaint(TaskPlan *task) {
+	//Worked out from the frame address, as the compiler flags pointers that leave an object
+	unsigned int *frame = __builtin_frame_address(0);
+	volatile unsigned int *top = frame - PAINT_GAP;
+	volatile unsigned int *bottom = frame - task->stackDepth + PAINT_SLACK;
+	volatile unsigned int *word;
+
+	for(word = bottom; word < top; word++) {
+		*word = STACK_PAINT;
+	}
+	task->paintBottom = (unsigned int *)bottom;
+	task->paintWords = top - bottom;
+}
+
+/**
+ * stackUsed()
+ * @return the most stack words the task has ever used, counting the unpainted slack as used
+ */
+static unsigned int stackUsed(const TaskPlan *task) {
+	unsigned int untouched = 0;
+
+	if(task->paintBottom == NULL) {
+		return 0;
+	}
+	while(untouched < task->paintWords && task->paintBottom[untouched] == STACK_PAINT) {
+		untouched++;
+	}
+	return task->stackDepth - untouched;
+}
+
+static void controlTask(void *param) {
+	unsigned long wake = millis();
+
+	stackPaint(param);
+	while(1) {
+		eventsDispatch();
+		modeUpdate();
+		odometryUpdate();
+		pathFollowUpdate();
+		liftControlUpdate();
+		commandUpdate();
+		motorFrameCommit();
+		telemetrySample();
+		taskDelayUntil(&wake, CONTROL_PERIOD);
+	}
+}
+
+static void sensingTask(void *param) {
+	SensorSnapshot sensors;
+	unsigned long wake = millis();
+
+	stackPaint(param);
+	while(1) {
+		sensorsUpdate();
+		sensorsGet(&sensors);
+		powerMonitorUpdate(sensors.battery, SENSORS_PERIOD);
+		telemetrySet(TELEMETRY_BATTERY_PREDICTED, powerPredicted());
+		telemetrySet(TELEMETRY_SHED_LEVEL, powerShedLevel());
+		taskDelayUntil(&wake, SENSORS_PERIOD);
+	}
+}
+
+static void routineTask(void *param) {
+	stackPaint(param);
+	while(1) {
+		modeRoutineRun();
+	}
+}
+
+static void displayTask(void *param) {
+	SensorSnapshot sensors;
+	EncoderMark left;
+	EncoderMark right;
+	const char *text;
+	unsigned long wake = millis();
+
+	stackPaint(param);
+	lcdInit(uart1);
+	lcdSetBacklight(uart1, true);
+	while(1) {
+		//The calibration editor has the LCD while it is open
+		if(calibrationLcdEdit(uart1)) {
+			taskDelayUntil(&wake, DISPLAY_PERIOD);
+			continue;
+		}
+		sensorsGet(&sensors);
+		text = status;
+		if(zeroRequested) {
+			sensorsMark(&left, SENSORS_LEFT, &sensors);
+			sensorsMark(&right, SENSORS_RIGHT, &sensors);
+			zeroRequested = false;
+		}
+
+		profileBegin(&lcdProfile);
+		lcdPrint(uart1, 1, "Lift: %d", sensors.liftTicks);
+		if(text != NULL) {
+			lcdSetText(uart1, 2, text);
+		} else {
+			lcdPrint(uart1, 2, "L:%d R:%d", sensorsSinceMark(&left, &sensors),
+				sensorsSinceMark(&right, &sensors));
+		}
+		profileEnd(&lcdProfile);
+
+		taskDelayUntil(&wake, DISPLAY_PERIOD);
+	}
+}
+
+static void shellTask(void *param) {
+	unsigned long wake = millis();
+
+	stackPaint(param);
+	while(1) {
+		shellPoll();
+		replaySend();
+		taskDelayUntil(&wake, SHELL_PERIOD);
+	}
+}
+
+static void telemetryTask(void *param) {
+	unsigned long wake = millis();
+
+	stackPaint(param);
+	while(1) {
+		telemetrySend();
+		taskDelayUntil(&wake, TELEMETRY_PERIOD);
+	}
+}
+
+void tasksStart() {
+	unsigned int i;
+
+	for(i = 0; i < PLAN_TASKS; i++) {
+		plan[i].handle = taskCreate(plan[i].code, plan[i].stackDepth, &plan[i], plan[i].priority);
+	}
+}
+
+void tasksReport(FILE *stream) {
+	unsigned int stackBytes = PROS_TASK_STACKS * TASK_DEFAULT_STACK_SIZE * 4;
+	unsigned int i;
+
+	fprintf(stream, "{\"tasks\":[");
+	for(i = 0; i < PLAN_TASKS; i++) {
+		fprintf(stream, "%s{\"name\":\"%s\",\"priority\":%u,\"stackWords\":%u,\"usedWords\":%u}",
+			i == 0 ? "" : ",", plan[i].name, plan[i].priority, plan[i].stackDepth,
+			stackUsed(&plan[i]));
+		stackBytes += plan[i].stackDepth * 4;
+	}
+	fprintf(stream, "],\"stackBytes\":%u,\"heapBytes\":%u}\r\n", stackBytes,
+		(unsigned int)(&_estack - &_heapbegin));
+}
+
+void displayStatus(const char *text) {
+	status = text;
+}
+
+void displayZero() {
+	zeroRequested = true;
+}
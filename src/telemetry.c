@@ -0,0 +1,149 @@
+/** @file telemetry.c
+ * @brief Binary telemetry stream on UART 2
+ */
+
+#include "main.h"
+
+//Decoded frame: type, sequence, time, values and CRC
+#define FRAME_BYTES (6 + 2 * TELEMETRY_CHANNELS + 2)
+//COBS adds one byte per 254 and the zero delimiter follows
+#define ENCODED_BYTES (FRAME_BYTES + FRAME_BYTES / 254 + 2)
+
+typedef struct {
+	unsigned long time;
+	unsigned char sequence;
+	short values[TELEMETRY_CHANNELS];
+} TelemetrySample;
+
+//Filled by the control task and emptied by the telemetry task
+static Ring queue;
+
+static volatile int staged[TELEMETRY_CHANNELS];
+static unsigned char sequence;
+static volatile unsigned int dropped;
+
+/**
+ * crc16()
+ * @return the CRC-16/CCITT (polynomial 0x1021, start 0xFFFF) of a block of bytes
+ */
+static unsigned short crc16(const unsigned char *bytes, unsigned int length) {
+	unsigned short crc = 0xFFFF;
+	int bit;
+
+	while(length-- > 0) {
+		crc ^= (unsigned short)(*bytes++ << 8);
+		for(bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021) :
+				(unsigned short)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/**
+ * cobsEncode()
+ * Encodes a block so it holds no zero bytes, and appends the zero delimiter.
+ *
+ * @return the encoded length including the delimiter
+ */
+static unsigned int cobsEncode(const unsigned char *in, unsigned int length,
+		unsigned char *out) {
+	unsigned int code = 0;
+	unsigned int next = 1;
+	unsigned int i;
+
+	for(i = 0; i < length; i++) {
+		if(in[i] != 0) {
+			out[next++] = in[i];
+		}
+		if(in[i] == 0 || next - code == 255) {
+			out[code] = (unsigned char)(next - code);
+			code = next++;
+		}
+	}
+	out[code] = (unsigned char)(next - code);
+	out[next++] = 0;
+	return next;
+}
+
+/**
+ * frameValue()
+ * @return the mechanism speed a group was commanded in the current frame, the average of its
+ * motors
+ */
+static int frameValue(const MotorGroup *group) {
+	int total = 0;
+	int i;
+
+	for(i = 0; i < group->count; i++) {
+		total += group->direction[i] * motorFrameGet(group->ports[i]);
+	}
+	return total / group->count;
+}
+
+void telemetryInit() {
+	usartInit(uart2, TELEMETRY_BAUD, SERIAL_8N1);
+	ringInit(&queue, "telemetry", sizeof(TelemetrySample), TELEMETRY_QUEUE);
+}
+
+void telemetrySet(unsigned int channel, int value) {
+	if(channel < TELEMETRY_CHANNELS) {
+		staged[channel] = value;
+	}
+}
+
+void telemetrySample() {
+	SensorSnapshot sensors;
+	TelemetrySample sample;
+	unsigned int i;
+
+	sequence++;
+	sensorsGet(&sensors);
+	staged[TELEMETRY_LEFT_TICKS] = sensors.leftTicks;
+	staged[TELEMETRY_RIGHT_TICKS] = sensors.rightTicks;
+	staged[TELEMETRY_LIFT_TICKS] = sensors.liftTicks;
+	staged[TELEMETRY_LIFT_OUTPUT] = frameValue(&liftMotors);
+	staged[TELEMETRY_DRIVE_LEFT] = frameValue(&driveLeftMotors);
+	staged[TELEMETRY_DRIVE_RIGHT] = frameValue(&driveRightMotors);
+	staged[TELEMETRY_BATTERY] = sensors.battery;
+
+	sample.time = sensors.time;
+	sample.sequence = sequence;
+	for(i = 0; i < TELEMETRY_CHANNELS; i++) {
+		sample.values[i] = (short)staged[i];
+	}
+	if(!ringPush(&queue, &sample)) {
+		dropped++;
+	}
+}
+
+void telemetrySend() {
+	TelemetrySample sample;
+	unsigned char frame[FRAME_BYTES];
+	unsigned char encoded[ENCODED_BYTES];
+	unsigned short crc;
+	unsigned int length;
+	unsigned int i;
+
+	while(ringPop(&queue, &sample)) {
+		frame[0] = TELEMETRY_SAMPLE;
+		frame[1] = sample.sequence;
+		for(i = 0; i < 4; i++) {
+			frame[2 + i] = (unsigned char)(sample.time >> (8 * i));
+		}
+		for(i = 0; i < TELEMETRY_CHANNELS; i++) {
+			frame[6 + 2 * i] = (unsigned char)sample.values[i];
+			frame[7 + 2 * i] = (unsigned char)((unsigned short)sample.values[i] >> 8);
+		}
+
+		crc = crc16(frame, FRAME_BYTES - 2);
+		frame[FRAME_BYTES - 2] = (unsigned char)crc;
+		frame[FRAME_BYTES - 1] = (unsigned char)(crc >> 8);
+		length = cobsEncode(frame, FRAME_BYTES, encoded);
+		fwrite(encoded, 1, length, uart2);
+	}
+}
+
+unsigned int telemetryDropped() {
+	return dropped;
+}
@@ -0,0 +1,55 @@
+/** @file traction.c
+ * @brief Drive traction control and anti-tip limits
+ */
+
+#include "main.h"
+
+/**
+ * liftScale()
+ * @return a limit between its lift-down and lift-top values, following the lift height
+ */
+static int liftScale(int low, int high, int liftTicks) {
+	if(liftTicks <= 0) {
+		return low;
+	}
+	if(liftTicks >= TRACTION_LIFT_TOP) {
+		return high;
+	}
+	return low + (high - low) * liftTicks / TRACTION_LIFT_TOP;
+}
+
+void tractionReset(Traction *side, int measured) {
+	side->output = measured * 1000;
+	side->measured = measured;
+}
+
+int tractionStep(Traction *side, int target, int measured, int liftTicks,
+		unsigned long elapsed) {
+	int change = target * 1000 - side->output;
+	//Slowing down or reversing counts as braking until the command passes zero
+	bool braking = (side->output > 0 && change < 0) || (side->output < 0 && change > 0);
+	int limit = liftScale(braking ? TRACTION_DECEL : TRACTION_ACCEL,
+		braking ? TRACTION_DECEL_HIGH : TRACTION_ACCEL_HIGH, liftTicks) * (int)elapsed;
+	int torque = TRACTION_TORQUE;
+
+	if(change > limit) {
+		change = limit;
+	} else if(change < -limit) {
+		change = -limit;
+	}
+	side->output += change;
+
+	//Wheels gaining speed faster than the robot can are spinning on the floor
+	if(elapsed > 0 &&
+			abs(measured - side->measured) * 1000 > TRACTION_SLIP_ACCEL * (int)elapsed) {
+		torque = TRACTION_SLIP_TORQUE;
+	}
+	if(side->output > (measured + torque) * 1000) {
+		side->output = (measured + torque) * 1000;
+	} else if(side->output < (measured - torque) * 1000) {
+		side->output = (measured - torque) * 1000;
+	}
+	side->measured = measured;
+
+	return side->output / 1000;
+}
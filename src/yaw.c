@@ -0,0 +1,60 @@
+/** @file yaw.c
+ * @brief Gyro heading service
+ */
+
+#include "main.h"
+
+//Bias in analogReadCalibratedHR() counts, on top of what analogCalibrate() removed
+static Fixed bias;
+//Integrated rate less bias, in counts times milliseconds, as Fixed
+static long long integral;
+static Fixed offset;
+static unsigned long stillTime;
+static volatile Fixed heading;
+static volatile Fixed resetTo;
+static volatile bool resetPending;
+
+void yawInit() {
+	analogCalibrate(YAW_PORT);
+	bias = 0;
+	integral = 0;
+	offset = 0;
+	heading = 0;
+}
+
+void yawUpdate(unsigned long elapsed, bool driveStill) {
+	Fixed rate = fixedFromInt(analogReadCalibratedHR(YAW_PORT)) - bias;
+	Fixed scale = calibration->gyroScale;
+
+	if(resetPending) {
+		integral = 0;
+		offset = resetTo;
+		resetPending = false;
+	}
+
+	if(driveStill && abs(rate) < fixedFromInt(YAW_STILL_RATE)) {
+		stillTime += elapsed;
+	} else {
+		stillTime = 0;
+	}
+	if(stillTime >= YAW_STILL_TIME) {
+		//Known to be still, so the whole reading is bias
+		bias += rate >> YAW_BIAS_SHIFT;
+	} else {
+		integral += (long long)rate * elapsed;
+	}
+
+	if(scale != 0) {
+		//Counts-ms to degrees is a division by 1000 and the scale, then degrees to radians
+		heading = offset + (Fixed)(integral / 180000 * FIXED_PI / scale);
+	}
+}
+
+Fixed yawHeading() {
+	return heading;
+}
+
+void yawReset(Fixed newHeading) {
+	resetTo = newHeading;
+	resetPending = true;
+}
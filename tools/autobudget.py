@@ -0,0 +1,343 @@
+#!/usr/bin/env python3
+"""Predicts whether autonomous routines fit in the 15 second autonomous period.
+
+Each routine below is the sequence of calls a routine in src/auto.c makes, with parallel
+groups for commands started together on the control task, such as a lift preset while a path
+is followed. Every command is simulated in CONTROL_PERIOD steps against a first order model of
+the drive, from its feedforward gains, and of the lift, paths from the speed profiles planned
+into src/paths.c, and the approach from its own gains. Motor speeds follow the battery voltage,
+so each routine is run at nominal and at worst-case voltage.
+
+The robot's constants are read from the headers and the calibration defaults rather than
+copied here, and a step argument naming a #define, such as MACRO_SCORE_HEIGHT, takes its value.
+
+For each routine the tool prints the timeline at worst-case voltage. Commands on the critical
+path, the longest branch of every parallel group, are marked with a "*"; the others show how
+much later they could finish without delaying the routine. Routines over the budget are flagged
+and make the tool exit with status 1.
+
+The models are simpler than the plant models of tools/autosim.c, so the prediction is checked
+against it: with a trend file from autosim, each routine's worst-case time is compared with its
+slowest healthy run there, and a prediction more than CHECK_TOLERANCE faster is flagged and
+fails too. "make budget" runs autosim and then this check.
+
+Edit ROUTINES to match src/auto.c and run from the project root:
+
+    python3 tools/autobudget.py [--trend autosim-trend.json] [routine]
+"""
+
+import glob
+import json
+import math
+import os
+import re
+import sys
+
+# Routines as lists of steps; ("parallel", [steps], [steps], ...) runs the branches together
+ROUTINES = {
+	# The routines of src/auto.c, by the same names
+	"turn": [
+		("turn", "AUTO_TURN", 0),
+	],
+	# Score the preload along scoreCurve and come back for the next object
+	"scoreAndReturn": [
+		("parallel",
+			[("path", "scoreCurve")],
+			[("lift", "MACRO_SCORE_HEIGHT")]),
+		("approach", "AUTO_SCORE_DISTANCE", "AUTO_SCORE_TIMEOUT"),
+		("claw", "-MACRO_GRAB_POWER", "MACRO_RELEASE_TIME"),
+		# backToStart leaves the way scoreCurve came, so turn around onto it first; the lift
+		# comes down meanwhile
+		("parallel",
+			[("turn", "AUTO_TURN_AROUND", 1), ("path", "backToStart"),
+				("move", "AUTO_PICKUP_DISTANCE", 0)],
+			[("lift", "MACRO_CARRY_HEIGHT")]),
+		("claw", "MACRO_GRAB_POWER", "MACRO_GRAB_TIME"),
+	],
+}
+
+# Distance in centimeters the ultrasonics read at the end of each path, from the field walls of
+# tools/autosim.c; the goal wall is 18 inches past the end of scoreCurve
+RANGES = {
+	"scoreCurve": 45.7,
+}
+
+BUDGET = 15.0			# seconds of autonomous
+NOMINAL_VOLTS = 7.2		# battery voltage the drive feedforward and lift free speed are for
+WORST_VOLTS = 6.5		# a tired battery sagging under load
+TIMEOUT = 15.0			# simulated seconds after which a command is taken to never finish
+CHECK_TOLERANCE = 0.5	# seconds a prediction may be faster than autosim
+
+LIFT_FREE = 600.0		# lift encoder ticks per second at full power
+MOTOR_LAG = 0.1			# seconds, time constant of a 393 reaching its speed
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+
+def load_defines():
+	"""Reads the numeric #defines of include/*.h, with FIXED() values as plain numbers."""
+	defines = {}
+	for header in sorted(glob.glob(os.path.join(ROOT, "include", "*.h"))):
+		with open(header) as source:
+			for name, value in re.findall(
+					r"^#define (\w+) (?:FIXED\()?(-?[\d.]+)\)?\s*$", source.read(), re.M):
+				defines[name] = float(value)
+	return defines
+
+
+def load_defaults():
+	"""Reads the calibration fields the models use from CALIBRATION_DEFAULTS in calibration.c."""
+	with open(os.path.join(ROOT, "src", "calibration.c")) as source:
+		body = re.search(r"#define CALIBRATION_DEFAULTS \{(.*?)\n\}", source.read(), re.S).group(1)
+	values = [float(fixed or plain) for fixed, plain in
+		re.findall(r"FIXED\(([-\d.]+)\)|\b(\d+)\b", body)]
+	# In the order of Calibration: the lift then the drive gains lead Gains, and drivePower
+	# follows the deadzone after them
+	return {"liftKp": values[0], "liftKg": values[3], "driveKs": values[4], "driveKv": values[5],
+		"drivePower": values[7]}
+
+
+DEFINES = load_defines()
+DEFAULTS = load_defaults()
+
+STEP = DEFINES["CONTROL_PERIOD"] / 1000.0
+INCHES_PER_TICK = DEFINES["ODOMETRY_INCHES_PER_TICK"]
+TRACK_WIDTH = DEFINES["ODOMETRY_TRACK_WIDTH"]
+DRIVE_POWER = DEFAULTS["drivePower"]
+LIFT_KP = DEFAULTS["liftKp"]
+LIFT_KG = DEFAULTS["liftKg"]
+DRIVE_KS = DEFAULTS["driveKs"]
+DRIVE_KV = DEFAULTS["driveKv"]
+LIFT_TOLERANCE = DEFINES["LIFT_TOLERANCE"]
+PATH_MIN_SPEED = DEFINES["PATH_MIN_SPEED"]
+PATH_TOLERANCE = DEFINES["PATH_TOLERANCE"]
+APPROACH_KP = DEFINES["APPROACH_KP"]
+APPROACH_MAX = DEFINES["APPROACH_MAX_SPEED"]
+APPROACH_MIN = DEFINES["APPROACH_MIN_SPEED"]
+APPROACH_TOLERANCE = DEFINES["APPROACH_TOLERANCE"]
+APPROACH_SETTLE = DEFINES["APPROACH_SETTLE_TIME"] / 1000.0
+
+
+def load_paths():
+	"""Reads the planned paths from src/paths.c as lists of (x, y, speed) in inches."""
+	with open(os.path.join(ROOT, "src", "paths.c")) as source:
+		text = source.read()
+	paths = {}
+	for name, body in re.findall(r"PathPoint (\w+)Points\[\d+\] = \{(.*?)\};", text, re.S):
+		points = re.findall(r"\{(-?\d+), (-?\d+), (-?\d+)\}", body)
+		paths[name] = [tuple(int(v) / 65536.0 for v in p) for p in points]
+	return paths
+
+
+def wheel_speed(command, volts):
+	"""Inches per second a drive command settles at, by the drive feedforward gains: driveKs to
+	break away, then driveKv per inch per second at NOMINAL_VOLTS."""
+	command = min(abs(command), 127)
+	return max(command - DRIVE_KS, 0) / DRIVE_KV * volts / NOMINAL_VOLTS
+
+
+def drive(state, ticks, power):
+	"""Seconds for the drive to cover a distance at a fixed command, as move() and turn() do."""
+	free = wheel_speed(power, state["volts"]) / INCHES_PER_TICK
+	speed = 0.0
+	travel = 0.0
+	time = 0.0
+	while travel < ticks and time < TIMEOUT:
+		speed += (free - speed) * STEP / MOTOR_LAG
+		travel += speed * STEP
+		time += STEP
+	return time, ""
+
+
+def move(state, ticks, reverse):
+	return drive(state, ticks, DRIVE_POWER)
+
+
+def turn(state, ticks, direction):
+	return drive(state, ticks, DRIVE_POWER)
+
+
+def path(state, name):
+	"""Seconds to follow a planned path. The follower commands each speed by the feedforward
+	gains, so the robot drives slower in proportion on a low battery. On a curve the outer side
+	runs faster than the robot, and once it would need more than full power both sides are
+	slowed together."""
+	points = state["paths"][name]
+	top = wheel_speed(127, NOMINAL_VOLTS)
+	time = 0.0
+	capped = False
+	for i in range(len(points) - 1):
+		(x0, y0, v0), (x1, y1, v1) = points[i], points[i + 1]
+		length = ((x1 - x0) ** 2 + (y1 - y0) ** 2) ** 0.5
+		# Turned from the stretch before this one to this one, over its length
+		curvature = 0.0
+		if i > 0 and length > 0:
+			xp, yp, _ = points[i - 1]
+			turned = math.atan2(y1 - y0, x1 - x0) - math.atan2(y0 - yp, x0 - xp)
+			curvature = abs(math.remainder(turned, 2 * math.pi)) / length
+		fastest = top / (1 + curvature * TRACK_WIDTH / 2)
+		speed = min(max(v0, PATH_MIN_SPEED), fastest) * state["volts"] / NOMINAL_VOLTS
+		capped = capped or v0 > fastest
+		time += length / speed
+	# Done within PATH_TOLERANCE of the end, reached at the slowest speed
+	time -= PATH_TOLERANCE / PATH_MIN_SPEED
+	state["range"] = RANGES.get(name)
+	return max(time, 0.0), "slowed to full power" if capped else ""
+
+
+def lift(state, height):
+	"""Seconds for the lift controller to bring the lift within LIFT_TOLERANCE of a height."""
+	free = LIFT_FREE * state["volts"] / NOMINAL_VOLTS
+	position = float(state["lift"])
+	speed = 0.0
+	time = 0.0
+	while abs(height - position) > LIFT_TOLERANCE and time < TIMEOUT:
+		# Gravity takes the feedforward back, so only the loop's output moves the lift
+		command = max(min(LIFT_KP * (height - position) + LIFT_KG, 127), -127) - LIFT_KG
+		speed += (free * command / 127.0 - speed) * STEP / MOTOR_LAG
+		position += speed * STEP
+		time += STEP
+	state["lift"] = height
+	return time, ""
+
+
+def approach(state, distance, timeout):
+	"""Seconds for approach() to close to distance centimeters from the wall and settle."""
+	if state.get("range") is None:
+		return timeout / 1000.0, "no wall in range"
+	error = float(state["range"] - distance)
+	state["range"] = distance
+	speed = 0.0
+	time = 0.0
+	while error > APPROACH_TOLERANCE and time < timeout / 1000.0:
+		command = max(min(APPROACH_KP * error, APPROACH_MAX), APPROACH_MIN)
+		speed += (wheel_speed(command, state["volts"]) * 2.54 - speed) * STEP / MOTOR_LAG
+		error -= speed * STEP
+		time += STEP
+	time += APPROACH_SETTLE
+	if time >= timeout / 1000.0:
+		return timeout / 1000.0, "times out"
+	return time, ""
+
+
+def claw(state, power, milliseconds):
+	return milliseconds / 1000.0, ""
+
+
+def wait(state, milliseconds):
+	return milliseconds / 1000.0, ""
+
+
+COMMANDS = {
+	"move": move,
+	"turn": turn,
+	"path": path,
+	"lift": lift,
+	"approach": approach,
+	"claw": claw,
+	"wait": wait,
+}
+
+
+def value(argument):
+	"""The value of a step argument, looking up names of #defines, optionally negated."""
+	if isinstance(argument, str) and re.match(r"-?[A-Z][A-Z0-9_]*$", argument):
+		number = DEFINES[argument.lstrip("-")]
+		return -number if argument.startswith("-") else number
+	return argument
+
+
+def run(steps, start, state, timeline):
+	"""Adds each step to the timeline from start and returns when the last one ends."""
+	time = start
+	for step in steps:
+		if step[0] == "parallel":
+			ends = []
+			branches = []
+			for branch in step[1:]:
+				entries = []
+				ends.append(run(branch, time, state, entries))
+				branches.append(entries)
+			finish = max(ends)
+			# A branch that ends early can slip by the difference
+			for end, entries in zip(ends, branches):
+				for entry in entries:
+					entry["slack"] += finish - end
+				timeline.extend(entries)
+			time = finish
+		else:
+			duration, note = COMMANDS[step[0]](state, *[value(a) for a in step[1:]])
+			timeline.append({
+				"start": time,
+				"end": time + duration,
+				"command": "%s(%s)" % (step[0], ", ".join(str(a) for a in step[1:])),
+				"slack": 0.0,
+				"note": note,
+			})
+			time += duration
+	return time
+
+
+def simulate(steps, volts, paths):
+	timeline = []
+	total = run(steps, 0.0, {"volts": volts, "lift": 0, "paths": paths}, timeline)
+	timeline.sort(key=lambda entry: entry["start"])
+	return total, timeline
+
+
+def simulated(trend):
+	"""The slowest healthy run of each routine in the last line of an autosim trend file."""
+	with open(trend) as source:
+		lines = source.read().splitlines()
+	if not lines:
+		sys.exit("%s is empty; run make autosim first" % trend)
+	slowest = {}
+	for scenario in json.loads(lines[-1])["scenarios"]:
+		if scenario["fault"] == "none":
+			name = scenario["routine"]
+			slowest[name] = max(slowest.get(name, 0.0), scenario["time"])
+	return slowest
+
+
+def main():
+	arguments = sys.argv[1:]
+	trend = None
+	if arguments[:1] == ["--trend"] and len(arguments) > 1:
+		trend = arguments[1]
+		arguments = arguments[2:]
+	if len(arguments) > 1 or arguments[:1] == ["--trend"]:
+		sys.exit("usage: autobudget.py [--trend file] [routine]")
+	names = arguments or list(ROUTINES)
+	paths = load_paths()
+	measured = simulated(trend) if trend else {}
+	failed = False
+	for name in names:
+		if name not in ROUTINES:
+			sys.exit("no routine %s" % name)
+		nominal, _ = simulate(ROUTINES[name], NOMINAL_VOLTS, paths)
+		worst, timeline = simulate(ROUTINES[name], WORST_VOLTS, paths)
+		print("%s at %.1f V" % (name, WORST_VOLTS))
+		print("   start     end   slack  command")
+		for entry in timeline:
+			print("%8.2f%8.2f%8.2f %s %s%s" % (entry["start"], entry["end"], entry["slack"],
+				"*" if entry["slack"] < STEP / 2 else " ", entry["command"],
+				"  (%s)" % entry["note"] if entry["note"] else ""))
+		print("total %.2f s at %.1f V, %.2f s at %.1f V, budget %.1f s: %s" % (worst, WORST_VOLTS,
+			nominal, NOMINAL_VOLTS, BUDGET,
+			"OVER BUDGET" if worst > BUDGET else "%.2f s to spare" % (BUDGET - worst)))
+		failed = failed or worst > BUDGET
+		if trend:
+			if name not in measured:
+				print("autosim has no healthy run of %s" % name)
+				failed = True
+			else:
+				optimistic = measured[name] - worst > CHECK_TOLERANCE
+				print("autosim %.2f s at worst: %s" % (measured[name],
+					"PREDICTION TOO OPTIMISTIC" if optimistic else "prediction agrees"))
+				failed = failed or optimistic
+		print("")
+	sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,494 @@
+/** @file autosim.c
+ * @brief Regression runs of the autonomous routines through the plant models
+ *
+ * Built and run on the development machine with "make test-sim" or "make autosim". It links the
+ * robot's own autonomous, sensing, odometry, path, lift, command, mode and power code with the
+ * host stand-ins of tools/simrobot.c and runs every routine below on every battery below, once
+ * with the sensors healthy and once with each sensor fault of simrobot.h. Each run is a child
+ * process, as the robot code keeps its state in statics.
+ *
+ * Each healthy run is checked against its routine's expectations: where the robot ends up, how
+ * long the routine takes and the peak battery current. Where the robot should end is worked out
+ * from the planned paths and the routine's constants in main.h, not taken from earlier runs, and
+ * the routine should leave AUTONOMOUS_MARGIN of the period. A faulty sensor may throw the robot
+ * off its course, so faulty runs are only held to the current, and to finishing inside the
+ * autonomous period if the routines should cope with the fault; what they did is still
+ * reported. Failures are flagged and make the tool exit with status 1.
+ *
+ * A routine kept only to compare with, such as scoreAndReturnStops, which drives scoreAndReturn
+ * with a stop to turn at each corner, runs with healthy sensors only. The routine that replaced
+ * it is reported as how much faster it is on each battery.
+ *
+ * Every run appends one line of JSON with each scenario's figures to a trend file, by default
+ * autosim-trend.json in the project root, so drift shows up across commits:
+ *
+ *     make test-sim [TREND=file]
+ *
+ * The routines are the ones in src/auto.c, picked by name.
+ *
+ * Last, the driver takes over from scoreAndReturn, with the lift controller still holding the
+ * lift, and runs the score macro through operatorControl()'s loop while turning with the drive
+ * stick. The macro should run to its end, the driver's hold should keep the lift where the
+ * macro left it, and the lift stick on the partner joystick should stop a second run at once.
+ */
+
+#include "main.h"
+#include "simrobot.h"
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//The autonomous period in seconds, and the time a routine should leave at its end for the
+//field's timing and the models' error
+#define AUTONOMOUS_TIME 15.0
+#define AUTONOMOUS_MARGIN 0.5
+//How far the robot may end from where it should, in inches and radians
+#define POSE_TOLERANCE 3.0
+#define HEADING_TOLERANCE 0.15
+//Largest battery current any routine may draw, in A; the routines below peak at 18 A on a fresh
+//battery, so this catches a change that makes them fight themselves or stall a motor
+#define CURRENT_LIMIT 24.0
+//Longest line of the trend file
+#define TREND_LINE 16384
+//Driver loop period in opcontrol.c
+#define DRIVER_PERIOD 20
+//Stick the driver turns with and moves the lift with during the macros
+#define MACRO_STICK 60
+//Longest a macro may run, in milliseconds, and how long the driver's hold is watched after it
+#define MACRO_LIMIT 5000
+#define MACRO_HOLD_TIME 1500
+//Most the lift may move in MACRO_HOLD_TIME once a macro has let go of it, in ticks
+#define MACRO_DRIFT 40
+//Driver loops the lift stick may take to stop a macro: one to see it, one for the control tick
+#define MACRO_CANCEL_LOOPS 2
+
+typedef struct {
+	//The routine's name in src/auto.c
+	const char *name;
+	//What the ultrasonics see from the field
+	SimWall wall;
+	//Where the robot should end: at the end of a path facing along its last stretch, or at the
+	//start if NULL, then driven straight on and turned left on the spot by drive ticks
+	const Path *path;
+	int driveOn;
+	int turnOn;
+	//For a routine kept only to compare with, the routine it is the old way of driving; it is run
+	//with healthy sensors only, never fails, and its times are set against that routine's
+	const char *replacedBy;
+} Routine;
+
+typedef struct {
+	const char *name;
+	double volts;
+} Battery;
+
+typedef struct {
+	//Milliseconds the first macro ran, with the drive stick over
+	unsigned long ran;
+	//Lift height when it let go and MACRO_HOLD_TIME later
+	int released;
+	int held;
+	//True if the second macro started, and the driver loops it lasted with the lift stick over
+	bool restarted;
+	unsigned int cancelLoops;
+} MacroResult;
+
+typedef struct {
+	const char *name;
+	//True if the routines should still finish in the period with the fault
+	bool tolerated;
+} Fault;
+
+static const Routine routines[] = {
+	{"turn", {false, 0, 0, 0}, NULL, 0, AUTO_TURN, NULL},
+	//The goal wall is 18 inches ahead of the end of scoreCurve, so the approach closes the last
+	//inches to AUTO_SCORE_DISTANCE from it. The robot drives on for the next object from the end
+	//of backToStart
+	{"scoreAndReturn", {true, 36, 66, M_PI / 2}, &backToStart, AUTO_PICKUP_DISTANCE, 0, NULL},
+	//The same with a stop to turn at each corner, as routines were driven before the paths
+	{"scoreAndReturnStops", {true, 36, 66, M_PI / 2}, &backToStart, AUTO_PICKUP_DISTANCE, 0,
+		"scoreAndReturn"},
+};
+
+#define ROUTINES (sizeof(routines) / sizeof(routines[0]))
+#define BATTERIES (sizeof(batteries) / sizeof(batteries[0]))
+
+static const Battery batteries[] = {
+	{"fresh", 8.4},
+	{"nominal", 7.8},
+	{"tired", 7.0},
+};
+
+//Odometry and the drive-by-distance helpers need both drive encoders and the lift controller its
+//encoder, so without one the routine stalls until the period ends. The gyro is not steered by
+//and the approach gives up without echoes, so those faults cost at most its timeout.
+static const Fault faults[SIM_FAULTS] = {
+	{"none", true}, {"leftEncoder", false}, {"liftEncoder", false}, {"gyroDrift", true},
+	{"range", true}
+};
+
+//Robot code autosim does not link, which operatorControl() only calls on the driver's request
+
+bool autotuneLift() {
+	return false;
+}
+
+bool autotuneDrive() {
+	return false;
+}
+
+void displayZero() {
+}
+
+bool selftestActive() {
+	return false;
+}
+
+void tasksReport(FILE *stream) {
+}
+
+void replayRecord(const DriverInput *input, unsigned long stepMicros) {
+}
+
+bool replayRun() {
+	return false;
+}
+
+/**
+ * run()
+ * Runs one scenario in a child process.
+ *
+ * @return true if the child ran it and filled result
+ */
+static bool run(const Routine *routine, const Battery *battery, SimFault fault,
+		SimResult *result) {
+	int pipes[2];
+	pid_t child;
+	bool ok;
+
+	if(pipe(pipes) != 0) {
+		return false;
+	}
+	child = fork();
+	if(child == 0) {
+		close(pipes[0]);
+		autonomousSelect(routine->name);
+		simStart(battery->volts, fault, &routine->wall);
+		simRun(AUTONOMOUS_TIME, result);
+		_exit(write(pipes[1], result, sizeof(SimResult)) == sizeof(SimResult) ? 0 : 1);
+	}
+	close(pipes[1]);
+	ok = child > 0 && read(pipes[0], result, sizeof(SimResult)) == sizeof(SimResult);
+	close(pipes[0]);
+	return ok;
+}
+
+/**
+ * liftTicks()
+ * @return the lift's height
+ */
+static int liftTicks() {
+	SensorSnapshot sensors;
+
+	sensorsGet(&sensors);
+	return sensors.liftTicks;
+}
+
+/**
+ * driverLoop()
+ * Runs one iteration of operatorControl()'s loop with the joysticks as set.
+ */
+static void driverLoop(DriverInput *input) {
+	delay(DRIVER_PERIOD);
+	driverInputSample(input);
+	if(liftControlActive() && driverMoving(input, 1 << DRIVER_LIFT)) {
+		liftControlRelease();
+	}
+	macroUpdate(input);
+	driverStep(input);
+}
+
+/**
+ * macroScenario()
+ * Runs a routine, then the score macro twice from driver control.
+ */
+static void macroScenario(const Routine *routine, const Battery *battery, MacroResult *result) {
+	SimJoystick driver = {true, {0, 0, 0, 0}, {0, 0, 0, 0}};
+	SimJoystick partner = {true, {0, 0, 0, 0}, {0, 0, 0, 0}};
+	SimResult ran;
+	DriverInput input;
+	unsigned long start;
+
+	autonomousSelect(routine->name);
+	simStart(battery->volts, SIM_FAULT_NONE, &routine->wall);
+	simRun(AUTONOMOUS_TIME, &ran);
+
+	//Taken back the way operatorControl() takes it
+	simDriverControl();
+	simJoystick(1, &driver);
+	simJoystick(2, &partner);
+	modeRoutineCancel();
+	commandCancelAll();
+	pathFollowStop();
+	driverInputSample(&input);
+	driverReset(&input);
+
+	//Score while turning, which leaves the macro alone
+	driver.buttons[0] = JOY_UP;
+	driver.analog[0] = MACRO_STICK;
+	simJoystick(1, &driver);
+	driverLoop(&input);
+	driver.buttons[0] = 0;
+	simJoystick(1, &driver);
+	start = millis();
+	do {
+		driverLoop(&input);
+	} while(commandRequired() != 0 && millis() - start < MACRO_LIMIT);
+	result->ran = millis() - start;
+	driver.analog[0] = 0;
+	simJoystick(1, &driver);
+	result->released = liftTicks();
+	for(start = millis(); millis() - start < MACRO_HOLD_TIME;) {
+		driverLoop(&input);
+	}
+	result->held = liftTicks();
+
+	//Score again, and take the lift on the joystick it is mapped to
+	driver.buttons[0] = JOY_UP;
+	simJoystick(1, &driver);
+	driverLoop(&input);
+	driver.buttons[0] = 0;
+	simJoystick(1, &driver);
+	partner.analog[2] = MACRO_STICK;
+	simJoystick(2, &partner);
+	driverLoop(&input);
+	result->restarted = commandRequired() != 0;
+	result->cancelLoops = 1;
+	while(commandRequired() != 0 && result->cancelLoops < MACRO_LIMIT / DRIVER_PERIOD) {
+		driverLoop(&input);
+		result->cancelLoops++;
+	}
+}
+
+/**
+ * runMacro()
+ * Runs the macro scenario in a child process.
+ *
+ * @return true if the child ran it and filled result
+ */
+static bool runMacro(const Routine *routine, const Battery *battery, MacroResult *result) {
+	int pipes[2];
+	pid_t child;
+	bool ok;
+
+	if(pipe(pipes) != 0) {
+		return false;
+	}
+	child = fork();
+	if(child == 0) {
+		close(pipes[0]);
+		macroScenario(routine, battery, result);
+		_exit(write(pipes[1], result, sizeof(MacroResult)) == sizeof(MacroResult) ? 0 : 1);
+	}
+	close(pipes[1]);
+	ok = child > 0 && read(pipes[0], result, sizeof(MacroResult)) == sizeof(MacroResult);
+	close(pipes[0]);
+	return ok;
+}
+
+/**
+ * expected()
+ * Works out where a routine should leave the robot, in inches and radians.
+ */
+static void expected(const Routine *routine, double *x, double *y, double *heading) {
+	const PathPoint *end;
+	double inchesPerTick = ODOMETRY_INCHES_PER_TICK / (double)FIXED_ONE;
+	double track = ODOMETRY_TRACK_WIDTH / (double)FIXED_ONE;
+
+	*x = *y = *heading = 0;
+	if(routine->path != NULL) {
+		end = &routine->path->points[routine->path->count - 1];
+		*x = end->x / (double)FIXED_ONE;
+		*y = end->y / (double)FIXED_ONE;
+		*heading = atan2(end->y - end[-1].y, end->x - end[-1].x);
+	}
+	*x += routine->driveOn * inchesPerTick * cos(*heading);
+	*y += routine->driveOn * inchesPerTick * sin(*heading);
+	//Each side runs the distance, in opposite directions
+	*heading += 2 * routine->turnOn * inchesPerTick / track;
+}
+
+/**
+ * check()
+ * @return the failures of a result against its routine, as a comma separated list, or an empty
+ * string if it passed
+ */
+static const char *check(const Routine *routine, SimFault fault, const SimResult *result,
+		char *reasons, size_t size) {
+	double x, y, heading;
+	double turned;
+
+	expected(routine, &x, &y, &heading);
+	turned = remainder(result->heading - heading, 2 * M_PI);
+	reasons[0] = '\0';
+	if(result->cutOff && faults[fault].tolerated) {
+		strncat(reasons, "cut off,", size - strlen(reasons) - 1);
+	}
+	if(result->peakCurrent > CURRENT_LIMIT) {
+		strncat(reasons, "current,", size - strlen(reasons) - 1);
+	}
+	if(fault == SIM_FAULT_NONE) {
+		if(result->time > AUTONOMOUS_TIME - AUTONOMOUS_MARGIN) {
+			strncat(reasons, "slow,", size - strlen(reasons) - 1);
+		}
+		if(hypot(result->x - x, result->y - y) > POSE_TOLERANCE ||
+				fabs(turned) > HEADING_TOLERANCE) {
+			strncat(reasons, "pose,", size - strlen(reasons) - 1);
+		}
+	}
+	if(reasons[0] != '\0') {
+		reasons[strlen(reasons) - 1] = '\0';
+	}
+	return reasons;
+}
+
+/**
+ * trendWrite()
+ * Appends a line to the trend file.
+ */
+static bool trendWrite(const char *path, const char *line) {
+	int file = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	size_t length = strlen(line);
+	bool ok;
+
+	if(file < 0) {
+		return false;
+	}
+	ok = write(file, line, length) == (ssize_t)length;
+	return close(file) == 0 && ok;
+}
+
+int main(int argc, char **argv) {
+	const char *trend = argc > 1 ? argv[1] : "autosim-trend.json";
+	static char line[TREND_LINE];
+	char reasons[64];
+	size_t used;
+	SimResult result;
+	MacroResult macro;
+	unsigned int r, b, f, n;
+	//Time of each healthy run, or a negative number if it did not run
+	double healthy[ROUTINES][BATTERIES];
+	bool healthyCutOff[ROUTINES][BATTERIES];
+	unsigned int failures = 0, runs = 0;
+
+	//sys/wait.h clashes with the PROS wait(), so finished children are left to the kernel to reap
+	signal(SIGCHLD, SIG_IGN);
+	used = snprintf(line, sizeof(line), "{\"time\":%ld,\"scenarios\":[", (long)time(NULL));
+	printf("%-20s %-8s %-12s %6s %7s %7s %7s %6s %6s %5s %3s\n", "routine", "battery", "fault",
+		"time", "x", "y", "heading", "odom", "peakA", "lowV", "bo");
+	for(r = 0; r < ROUTINES; r++) {
+		for(b = 0; b < BATTERIES; b++) {
+			healthy[r][b] = -1;
+			for(f = 0; f < SIM_FAULTS; f++) {
+				const Routine *routine = &routines[r];
+
+				if(routine->replacedBy != NULL && f != SIM_FAULT_NONE) {
+					continue;
+				}
+				runs++;
+				if(!run(routine, &batteries[b], f, &result)) {
+					printf("%-20s %-8s %-12s FAILED TO RUN\n", routine->name, batteries[b].name,
+						faults[f].name);
+					failures++;
+					continue;
+				}
+				check(routine, f, &result, reasons, sizeof(reasons));
+				if(routine->replacedBy != NULL) {
+					reasons[0] = '\0';
+				}
+				if(f == SIM_FAULT_NONE) {
+					healthy[r][b] = result.time;
+					healthyCutOff[r][b] = result.cutOff;
+				}
+				failures += reasons[0] != '\0';
+				printf("%-20s %-8s %-12s %6.2f %7.1f %7.1f %7.2f %6.1f %6.1f %5.2f %3u %s%s\n",
+					routine->name, batteries[b].name, faults[f].name, result.time, result.x,
+					result.y, result.heading, result.odometryError, result.peakCurrent,
+					result.lowBattery, result.brownouts, reasons[0] ? "FAIL " : "", reasons);
+				if(used < sizeof(line)) {
+					used += snprintf(line + used, sizeof(line) - used, "%s{\"routine\":\"%s\","
+						"\"battery\":\"%s\",\"fault\":\"%s\",\"time\":%.3f,\"x\":%.2f,\"y\":%.2f,"
+						"\"heading\":%.3f,\"odometryError\":%.2f,\"peakCurrent\":%.2f,"
+						"\"lowBattery\":%.3f,\"brownouts\":%u,\"pass\":%s}", runs > 1 ? "," : "",
+						routine->name, batteries[b].name, faults[f].name, result.time, result.x,
+						result.y, result.heading, result.odometryError, result.peakCurrent,
+						result.lowBattery, result.brownouts, reasons[0] ? "false" : "true");
+				}
+			}
+		}
+	}
+	//What each replaced routine would cost, on every battery
+	for(r = 0; r < ROUTINES; r++) {
+		for(n = 0; routines[r].replacedBy != NULL && n < ROUTINES; n++) {
+			if(strcmp(routines[n].name, routines[r].replacedBy) != 0) {
+				continue;
+			}
+			for(b = 0; b < BATTERIES; b++) {
+				if(healthy[r][b] >= 0 && healthy[n][b] >= 0) {
+					//A routine cut off would have taken longer still
+					printf("%s on a %s battery: %.2f s, %s%.2f s faster than %s\n",
+						routines[n].name, batteries[b].name, healthy[n][b],
+						healthyCutOff[r][b] ? "at least " : "", healthy[r][b] - healthy[n][b],
+						routines[r].name);
+				}
+			}
+		}
+	}
+	if(used < sizeof(line)) {
+		used += snprintf(line + used, sizeof(line) - used, "]");
+	}
+
+	//The score macro after scoreAndReturn, on the nominal battery
+	runs++;
+	if(!runMacro(&routines[1], &batteries[1], &macro)) {
+		printf("macro after %s FAILED TO RUN\n", routines[1].name);
+		failures++;
+	} else {
+		reasons[0] = '\0';
+		if(macro.ran < MACRO_GRAB_TIME + MACRO_RELEASE_TIME || macro.ran >= MACRO_LIMIT) {
+			strncat(reasons, "cut short,", sizeof(reasons) - strlen(reasons) - 1);
+		}
+		if(macro.released < (MACRO_CARRY_HEIGHT + MACRO_SCORE_HEIGHT) / 2 ||
+				abs(macro.held - macro.released) > MACRO_DRIFT) {
+			strncat(reasons, "lift,", sizeof(reasons) - strlen(reasons) - 1);
+		}
+		if(!macro.restarted || macro.cancelLoops > MACRO_CANCEL_LOOPS) {
+			strncat(reasons, "cancel,", sizeof(reasons) - strlen(reasons) - 1);
+		}
+		if(reasons[0] != '\0') {
+			reasons[strlen(reasons) - 1] = '\0';
+			failures++;
+		}
+		printf("macro after %s: ran %lu ms, lift %d then %d, lift stick stopped it in %u loops"
+			" %s%s\n", routines[1].name, macro.ran, macro.released, macro.held, macro.cancelLoops,
+			reasons[0] ? "FAIL " : "", reasons);
+		if(used < sizeof(line)) {
+			used += snprintf(line + used, sizeof(line) - used, ",\"macro\":{\"ran\":%lu,"
+				"\"released\":%d,\"held\":%d,\"cancelLoops\":%u,\"pass\":%s}", macro.ran,
+				macro.released, macro.held, macro.cancelLoops, reasons[0] ? "false" : "true");
+		}
+	}
+	if(used < sizeof(line)) {
+		used += snprintf(line + used, sizeof(line) - used, ",\"failures\":%u}\n", failures);
+	}
+	if(used >= sizeof(line) || !trendWrite(trend, line)) {
+		printf("could not write the trend to %s\n", trend);
+		return 1;
+	}
+	printf("%u of %u scenarios failed; trend appended to %s\n", failures, runs, trend);
+	return failures > 0 ? 1 : 0;
+}
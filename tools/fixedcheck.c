@@ -0,0 +1,285 @@
+/** @file fixedcheck.c
+ * @brief Accuracy and saturation of the Q16.16 routines against libm
+ *
+ * Built and run on the development machine with "make test-sim" or "make fixedcheck". It
+ * sweeps each routine of src/fixed.c over its range and compares it with the double precision
+ * libm result for the same, already quantized, input:
+ *
+ *  - sin and cos over eight turns either way and at large angles, to within TRIG_LIMIT;
+ *  - atan2 around the circle at lengths from one count to near FIXED_MAX, to within TRIG_LIMIT;
+ *  - sqrt from one count to FIXED_MAX, and mul, div and recip over random operands that fit,
+ *    to within a count, as they round down;
+ *  - add, sub, mul, div and recip past the ends of the range, which must saturate exactly.
+ *
+ * It also times each routine and the float operation it replaces, in nanoseconds per call. The
+ * development machine has an FPU, so these only show what the fixed-point code costs by itself;
+ * the soft-float comparison that matters comes from the robot's "fixedbench" shell command.
+ *
+ * A check out of its limit is flagged and makes the tool exit with status 1.
+ */
+
+#include "main.h"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+//Largest error allowed of sin, cos and atan2, from the step of the angle and the tables
+#define TRIG_LIMIT 1.0e-4
+//One count of a Fixed
+#define COUNT (1.0 / FIXED_ONE)
+//Random operand pairs for mul, div and recip
+#define RANDOM_PAIRS 200000
+//Calls per timing
+#define TIMED_CALLS 10000000
+
+typedef struct {
+	const char *name;
+	double limit;
+	double maxError;
+	double totalError;
+	unsigned long samples;
+} Check;
+
+typedef struct {
+	const char *name;
+	Fixed (*op)(Fixed a, Fixed b);
+	Fixed a;
+	Fixed b;
+	Fixed expected;
+} Saturation;
+
+typedef struct {
+	const char *name;
+	Fixed (*fixed)(Fixed a, Fixed b);
+	float (*soft)(float a, float b);
+} TimedOp;
+
+static volatile Fixed fixedA = FIXED(0.7);
+static volatile Fixed fixedB = FIXED(1.3);
+static volatile float floatA = 0.7;
+static volatile float floatB = 1.3;
+static volatile Fixed fixedSink;
+static volatile float floatSink;
+
+static Fixed fixedSinOp(Fixed a, Fixed b) {
+	return fixedSin(a);
+}
+
+static Fixed fixedCosOp(Fixed a, Fixed b) {
+	return fixedCos(a);
+}
+
+static Fixed fixedSqrtOp(Fixed a, Fixed b) {
+	return fixedSqrt(a);
+}
+
+static Fixed fixedRecipOp(Fixed a, Fixed b) {
+	return fixedRecip(a);
+}
+
+static float floatAdd(float a, float b) {
+	return a + b;
+}
+
+static float floatMul(float a, float b) {
+	return a * b;
+}
+
+static float floatDiv(float a, float b) {
+	return a / b;
+}
+
+static float floatSqrt(float a, float b) {
+	return sqrtf(a);
+}
+
+static float floatSin(float a, float b) {
+	return sinf(a);
+}
+
+static float floatCos(float a, float b) {
+	return cosf(a);
+}
+
+static float floatAtan2(float a, float b) {
+	return atan2f(a, b);
+}
+
+static const Saturation saturations[] = {
+	{"add", fixedAdd, FIXED_MAX, 1, FIXED_MAX},
+	{"add", fixedAdd, FIXED_MIN, -1, FIXED_MIN},
+	{"sub", fixedSub, FIXED_MIN, 1, FIXED_MIN},
+	{"sub", fixedSub, FIXED_MAX, -1, FIXED_MAX},
+	{"mul", fixedMul, FIXED(200), FIXED(200), FIXED_MAX},
+	{"mul", fixedMul, FIXED(200), FIXED(-200), FIXED_MIN},
+	{"mul", fixedMul, FIXED_MIN, FIXED_MIN, FIXED_MAX},
+	{"div", fixedDiv, FIXED(30000), FIXED(0.5), FIXED_MAX},
+	{"div", fixedDiv, FIXED(-30000), FIXED(0.5), FIXED_MIN},
+	{"div", fixedDiv, FIXED_MIN, -1, FIXED_MAX},
+	{"div", fixedDiv, FIXED(1), 0, FIXED_MAX},
+	{"div", fixedDiv, FIXED(-1), 0, FIXED_MIN},
+	{"recip", fixedRecipOp, 1, 0, FIXED_MAX},
+	{"recip", fixedRecipOp, -1, 0, FIXED_MIN},
+};
+
+static const TimedOp timedOps[] = {
+	{"add", fixedAdd, floatAdd},
+	{"mul", fixedMul, floatMul},
+	{"div", fixedDiv, floatDiv},
+	{"sqrt", fixedSqrtOp, floatSqrt},
+	{"sin", fixedSinOp, floatSin},
+	{"cos", fixedCosOp, floatCos},
+	{"atan2", fixedAtan2, floatAtan2},
+};
+
+/**
+ * toDouble()
+ * @return a Fixed as a double
+ */
+static double toDouble(Fixed x) {
+	return x / (double)FIXED_ONE;
+}
+
+/**
+ * record()
+ * Adds one comparison to a check.
+ */
+static void record(Check *check, double got, double want) {
+	double error = fabs(got - want);
+
+	check->maxError = fmax(check->maxError, error);
+	check->totalError += error;
+	check->samples++;
+}
+
+/**
+ * randomFixed()
+ * @return a Fixed whose size is spread evenly over its powers of two, from a count to limit
+ */
+static Fixed randomFixed(double limit) {
+	double size = exp(log(COUNT) + (log(limit) - log(COUNT)) * rand() / (double)RAND_MAX);
+
+	return (Fixed)((rand() & 1 ? 1 : -1) * size * FIXED_ONE);
+}
+
+/**
+ * checkTrig()
+ * Sweeps sin, cos and atan2.
+ */
+static void checkTrig(Check *sine, Check *cosine, Check *arc) {
+	static const double lengths[] = {COUNT, 0.01, 1, 100, 30000};
+	Fixed angle, x, y;
+	double a;
+	unsigned int l;
+
+	for(angle = -8 * FIXED_TWO_PI; angle <= 8 * FIXED_TWO_PI; angle += 7) {
+		record(sine, toDouble(fixedSin(angle)), sin(toDouble(angle)));
+		record(cosine, toDouble(fixedCos(angle)), cos(toDouble(angle)));
+	}
+	for(angle = FIXED(30000); angle < FIXED(30100); angle += 101) {
+		record(sine, toDouble(fixedSin(angle)), sin(toDouble(angle)));
+		record(cosine, toDouble(fixedCos(angle)), cos(toDouble(angle)));
+	}
+	for(l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+		for(a = -M_PI; a < M_PI; a += 1e-4) {
+			x = (Fixed)lround(lengths[l] * cos(a) * FIXED_ONE);
+			y = (Fixed)lround(lengths[l] * sin(a) * FIXED_ONE);
+			if(x != 0 || y != 0) {
+				record(arc, 0, remainder(toDouble(fixedAtan2(y, x)) - atan2(y, x), 2 * M_PI));
+			}
+		}
+	}
+}
+
+/**
+ * checkArithmetic()
+ * Sweeps sqrt and tries mul, div and recip on random operands whose result fits.
+ */
+static void checkArithmetic(Check *root, Check *product, Check *quotient, Check *reciprocal) {
+	double want;
+	Fixed a, b;
+	long long x;
+	int i;
+
+	for(x = 1; x <= FIXED_MAX; x += 1 + x / 4096) {
+		record(root, toDouble(fixedSqrt((Fixed)x)), sqrt(toDouble((Fixed)x)));
+	}
+	for(i = 0; i < RANDOM_PAIRS; i++) {
+		a = randomFixed(30000);
+		b = randomFixed(30000);
+		want = toDouble(a) * toDouble(b);
+		if(fabs(want) < 32767) {
+			record(product, toDouble(fixedMul(a, b)), want);
+		}
+		want = toDouble(a) / toDouble(b);
+		if(fabs(want) < 32767) {
+			record(quotient, toDouble(fixedDiv(a, b)), want);
+		}
+		if(fabs(1 / toDouble(a)) < 32767) {
+			record(reciprocal, toDouble(fixedRecip(a)), 1 / toDouble(a));
+		}
+	}
+}
+
+/**
+ * nanosPerCall()
+ * @return the nanoseconds from a start time to now, per timed call
+ */
+static double nanosPerCall(const struct timespec *start) {
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return ((end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec)) / TIMED_CALLS;
+}
+
+int main() {
+	Check checks[] = {
+		{"sin", TRIG_LIMIT}, {"cos", TRIG_LIMIT}, {"atan2", TRIG_LIMIT}, {"sqrt", COUNT},
+		{"mul", COUNT}, {"div", COUNT}, {"recip", COUNT}
+	};
+	struct timespec start;
+	double fixedTime, floatTime;
+	unsigned int failures = 0;
+	unsigned int i;
+	Fixed got;
+	long n;
+
+	srand(1);
+	checkTrig(&checks[0], &checks[1], &checks[2]);
+	checkArithmetic(&checks[3], &checks[4], &checks[5], &checks[6]);
+	printf("routine   samples   max error  mean error       limit\n");
+	for(i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+		bool failed = checks[i].maxError > checks[i].limit;
+
+		failures += failed;
+		printf("%-7s %9lu %11.3g %11.3g %11.3g%s\n", checks[i].name, checks[i].samples,
+			checks[i].maxError, checks[i].totalError / checks[i].samples, checks[i].limit,
+			failed ? " FAIL" : "");
+	}
+
+	for(i = 0; i < sizeof(saturations) / sizeof(saturations[0]); i++) {
+		got = saturations[i].op(saturations[i].a, saturations[i].b);
+		if(got != saturations[i].expected) {
+			printf("%s(%d, %d) gave %d, not %d FAIL\n", saturations[i].name, saturations[i].a,
+				saturations[i].b, got, saturations[i].expected);
+			failures++;
+		}
+	}
+	printf("%u saturation cases\n", (unsigned int)(sizeof(saturations) / sizeof(saturations[0])));
+
+	printf("routine  fixed ns  float ns (host FPU)\n");
+	for(i = 0; i < sizeof(timedOps) / sizeof(timedOps[0]); i++) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(n = 0; n < TIMED_CALLS; n++) {
+			fixedSink = timedOps[i].fixed(fixedA, fixedB);
+		}
+		fixedTime = nanosPerCall(&start);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(n = 0; n < TIMED_CALLS; n++) {
+			floatSink = timedOps[i].soft(floatA, floatB);
+		}
+		floatTime = nanosPerCall(&start);
+		printf("%-7s %9.2f %9.2f\n", timedOps[i].name, fixedTime, floatTime);
+	}
+	return failures > 0 ? 1 : 0;
+}
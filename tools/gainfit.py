@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Fits lift and drive gains from a driver recording (include/replay.h).
+
+Record a few minutes of driving with 7 LEFT + 7 UP, save the serial console output, then run
+
+    python3 tools/gainfit.py drive.rec
+
+The lift is fitted as a first order velocity model with a constant gravity term,
+v[k+1] = a v[k] + b u[k] + c, and tuned with the SIMC rules for an integrating plant. The drive
+is fitted as u = kS sign(v) + kV v. The result is printed as serial shell commands
+(include/shell.h); paste them into the console and type "save".
+"""
+
+import math
+import sys
+
+INCHES_PER_TICK = 0.0349		# matches ODOMETRY_INCHES_PER_TICK
+LIFT_PORT = 3					# leftLiftInner, direction +1 in liftLeftMotors
+DRIVE_PORT = 1					# leftBackDrive, direction +1 in driveLeftMotors
+MIN_SPEED = 1.0					# inches per second below which drive samples are ignored
+
+
+def frames(path):
+	"""Yields (time, left, right, lift, motors) for each recorded line."""
+	with open(path) as log:
+		for line in log:
+			fields = line.strip().split(",")
+			if fields[0] != "F" or len(fields) != 36:
+				continue
+			values = [int(f) for f in fields[1:]]
+			yield values[0], values[18], values[19], values[20], values[25:35]
+
+
+def solve(rows, targets):
+	"""Least squares by the normal equations."""
+	n = len(rows[0])
+	a = [[sum(r[i] * r[j] for r in rows) for j in range(n)] for i in range(n)]
+	b = [sum(r[i] * t for r, t in zip(rows, targets)) for i in range(n)]
+	for col in range(n):
+		pivot = max(range(col, n), key=lambda r: abs(a[r][col]))
+		a[col], a[pivot] = a[pivot], a[col]
+		b[col], b[pivot] = b[pivot], b[col]
+		for r in range(n):
+			if r != col and a[col][col] != 0:
+				f = a[r][col] / a[col][col]
+				a[r] = [x - f * y for x, y in zip(a[r], a[col])]
+				b[r] -= f * b[col]
+	return [b[i] / a[i][i] for i in range(n)]
+
+
+def fit_lift(samples):
+	rows = []
+	targets = []
+	for prev, cur, nxt in zip(samples, samples[1:], samples[2:]):
+		v0 = cur[3] - prev[3]
+		v1 = nxt[3] - cur[3]
+		rows.append((v0, cur[4][LIFT_PORT - 1], 1.0))
+		targets.append(v1)
+	a, b, c = solve(rows, targets)
+	dt = (samples[-1][0] - samples[0][0]) / 1000.0 / (len(samples) - 1)
+	lag = -dt / math.log(a) if 0 < a < 1 else dt
+	slope = b / (1 - a) / dt			# ticks per second per command at steady state
+	hold = -c / b
+	delay = dt / 2
+	closed = max(lag, delay)
+	kp = 1 / (slope * (closed + delay))
+	ki = kp / (4 * (closed + delay))
+	kd = kp * lag
+	return kp, ki, kd, hold
+
+
+def fit_drive(samples):
+	rows = []
+	targets = []
+	for cur, nxt in zip(samples, samples[1:]):
+		dt = (nxt[0] - cur[0]) / 1000.0
+		if dt <= 0:
+			continue
+		speed = ((nxt[1] - cur[1]) + (nxt[2] - cur[2])) / 2 * INCHES_PER_TICK / dt
+		if abs(speed) < MIN_SPEED:
+			continue
+		rows.append((math.copysign(1, speed), speed))
+		targets.append(cur[4][DRIVE_PORT - 1])
+	return solve(rows, targets)
+
+
+def main():
+	if len(sys.argv) != 2:
+		sys.exit("usage: gainfit.py <recording>")
+	samples = list(frames(sys.argv[1]))
+	if len(samples) < 10:
+		sys.exit("not enough recorded frames")
+	kp, ki, kd, hold = fit_lift(samples)
+	ks, kv = fit_drive(samples)
+	print("set liftKp %.4f" % kp)
+	print("set liftKi %.4f" % ki)
+	print("set liftKd %.4f" % kd)
+	print("set liftKg %.2f" % hold)
+	print("set driveKs %.2f" % ks)
+	print("set driveKv %.3f" % kv)
+
+
+if __name__ == "__main__":
+	main()
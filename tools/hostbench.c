@@ -0,0 +1,187 @@
+/** @file hostbench.c
+ * @brief Host timings of the control loop code paths, as JSON
+ *
+ * Built and run on the development machine with "make hostbench". It links the same robot
+ * sources and host stand-ins as autosim, sets the robot up with simStart() and times each code
+ * path the control and operator tasks run every period, in nanoseconds per call:
+ *
+ *  - pidStep, the lift position loop;
+ *  - odometryUpdate, the pose update from the drive encoders;
+ *  - tractionStep, the driver's input shaping for one side of the drive;
+ *  - pathFollowUpdate, following scoreCurve;
+ *  - motorFrameCommit, the power model, budget and port map;
+ *  - lcdFormat, the display task's two lines, with snprintf() in place of lcdPrint();
+ *  - ringPushPop, fixedSin and fixedAtan2, which the paths above are built on.
+ *
+ * Each path is called BENCH_CALLS times with inputs that change from call to call, and the
+ * best of BENCH_RUNS runs is kept. The numbers are for this machine's compiler and CPU, so
+ * they only compare one commit or build profile with another; the robot's own timings come
+ * from the profile shell command. The robot modules are built with the optimization of the
+ * build profile (common.mk), and "make bench" runs this once per profile next to its sizes.
+ *
+ * Every run prints a table and appends one line of JSON, tagged with the profile, to a trend
+ * file, by default hostbench-trend.json in the project root:
+ *
+ *     make hostbench [PROFILE=profile] [BENCHTREND=file]
+ */
+
+#include "main.h"
+#include "simrobot.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//Calls per timed run, and runs each path is timed over
+#define BENCH_CALLS 200000
+#define BENCH_RUNS 5
+//Longest line of the trend file
+#define TREND_LINE 4096
+
+typedef struct {
+	const char *name;
+	void (*body)(unsigned int call);
+} Bench;
+
+static Pid pid;
+static ProfileSection pidProfile = PROFILE_SECTION("benchPid");
+static Traction traction;
+static Ring ring;
+static volatile int sink;
+
+static void benchPid(unsigned int call) {
+	sink = pidStep(&pid, (int)(call & 255) - 128, 15, CONTROL_PERIOD);
+}
+
+static void benchOdometry(unsigned int call) {
+	odometryUpdate();
+}
+
+static void benchTraction(unsigned int call) {
+	sink = tractionStep(&traction, (call & 1) ? 127 : -127, (int)(call & 127), (int)(call & 1023),
+		CONTROL_PERIOD);
+}
+
+static void benchPath(unsigned int call) {
+	pathFollowUpdate();
+}
+
+static void benchCommit(unsigned int call) {
+	motorFrameSet(1 + call % MOTOR_PORTS, (int)(call & 255) - 128);
+	motorFrameCommit();
+}
+
+static void benchLcd(unsigned int call) {
+	char line[17];
+
+	//The two lines displayTask() writes
+	sink = snprintf(line, sizeof(line), "Lift: %d", (int)call);
+	sink += snprintf(line, sizeof(line), "L:%d R:%d", (int)call, -(int)call);
+}
+
+static void benchRing(unsigned int call) {
+	Pose pose = {(Fixed)call, 0, 0};
+
+	ringPush(&ring, &pose);
+	sink = ringPop(&ring, &pose);
+}
+
+static void benchSin(unsigned int call) {
+	sink = fixedSin((Fixed)(call * 97));
+}
+
+static void benchAtan2(unsigned int call) {
+	sink = fixedAtan2((Fixed)(call * 97) - FIXED(50), FIXED(3));
+}
+
+static const Bench benches[] = {
+	{"pidStep", benchPid},
+	{"odometryUpdate", benchOdometry},
+	{"tractionStep", benchTraction},
+	{"pathFollowUpdate", benchPath},
+	{"motorFrameCommit", benchCommit},
+	{"lcdFormat", benchLcd},
+	{"ringPushPop", benchRing},
+	{"fixedSin", benchSin},
+	{"fixedAtan2", benchAtan2},
+};
+
+/**
+ * timeBench()
+ * @return the fewest nanoseconds per call any run of a path took
+ */
+static double timeBench(const Bench *bench) {
+	struct timespec start, end;
+	double best = 1e30;
+	double nanos;
+	unsigned int run, call;
+
+	for(run = 0; run < BENCH_RUNS; run++) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(call = 0; call < BENCH_CALLS; call++) {
+			bench->body(call);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		nanos = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_CALLS;
+		if(nanos < best) {
+			best = nanos;
+		}
+	}
+	return best;
+}
+
+/**
+ * trendWrite()
+ * Appends a line to the trend file.
+ */
+static bool trendWrite(const char *path, const char *line) {
+	int file = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	size_t length = strlen(line);
+	bool ok;
+
+	if(file < 0) {
+		return false;
+	}
+	ok = write(file, line, length) == (ssize_t)length;
+	return close(file) == 0 && ok;
+}
+
+int main(int argc, char **argv) {
+	const char *trend = argc > 1 ? argv[1] : "hostbench-trend.json";
+	const char *profile = argc > 2 ? argv[2] : "host";
+	SimWall wall = {false, 0, 0, 0};
+	char line[TREND_LINE];
+	size_t used;
+	double nanos;
+	unsigned int i;
+
+	simStart(7.8, SIM_FAULT_NONE, &wall);
+	pidInit(&pid, calibration->gains.liftKp, calibration->gains.liftKi, calibration->gains.liftKd,
+		&pidProfile);
+	tractionReset(&traction, 0);
+	ringInit(&ring, "bench", sizeof(Pose), 4);
+	pathFollowStart(&scoreCurve);
+
+	used = snprintf(line, sizeof(line),
+		"{\"time\":%ld,\"profile\":\"%s\",\"calls\":%d,\"benchmarks\":[", (long)time(NULL),
+		profile, BENCH_CALLS);
+	printf("%-18s %9s (%s)\n", "path", "ns/call", profile);
+	for(i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+		nanos = timeBench(&benches[i]);
+		printf("%-18s %9.1f\n", benches[i].name, nanos);
+		if(used < sizeof(line)) {
+			used += snprintf(line + used, sizeof(line) - used, "%s{\"name\":\"%s\",\"ns\":%.2f}",
+				i == 0 ? "" : ",", benches[i].name, nanos);
+		}
+	}
+	if(used < sizeof(line)) {
+		used += snprintf(line + used, sizeof(line) - used, "]}\n");
+	}
+	if(used >= sizeof(line) || !trendWrite(trend, line)) {
+		printf("could not write the trend to %s\n", trend);
+		return 1;
+	}
+	printf("trend appended to %s\n", trend);
+	return 0;
+}
@@ -0,0 +1,265 @@
+/** @file modesim.c
+ * @brief Handover latency of the mode manager between autonomous and the driver
+ *
+ * Built and run on the development machine with "make modesim". It compiles the robot's
+ * src/mode.c and src/command.c unchanged and runs them from real threads standing in for the
+ * tasks: a control thread calling modeUpdate() and commandUpdate() every CONTROL_PERIOD, a
+ * routine thread calling modeRoutineRun(), and the main thread playing the field or the driver.
+ * The routine is a chain of helpers that wait on modeRoutineAborted() like move() and turn()
+ * do. Each scenario cuts the routine off at a random moment:
+ *
+ *  - field: the field switches from autonomous to driver control;
+ *  - disable: the field disables the robot during autonomous;
+ *  - driver: the driver moves a stick while the practice shortcut's routine runs, seen at the
+ *    next DRIVER_PERIOD loop as operatorControl() sees it.
+ *
+ * Latency is timed from the event to the routine letting go of the mechanisms. It includes
+ * the host's thread wakeups, so treat it as a rough upper figure for the robot.
+ */
+
+#include "main.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRIALS 40
+//Driver loop period in opcontrol.c
+#define DRIVER_PERIOD 20
+//Longest the routine runs before the event, in milliseconds
+#define EVENT_SPREAD 200
+//Helpers in the routine and how long each lasts, in milliseconds
+#define HELPERS 4
+#define HELPER_TIME 150
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t signal;
+	int count;
+} HostSemaphore;
+
+typedef enum {
+	SCENARIO_FIELD,
+	SCENARIO_DISABLE,
+	SCENARIO_DRIVER,
+	SCENARIOS
+} Scenario;
+
+static const char *const scenarioNames[] = {"field", "disable", "driver"};
+
+static struct timespec epoch;
+static volatile bool fieldEnabled;
+static volatile bool fieldAutonomous;
+static volatile bool stop;
+const MotorGroup clawMotors;
+
+//PROS stand-ins for the two modules under test
+
+Semaphore semaphoreCreate() {
+	HostSemaphore *semaphore = calloc(1, sizeof(HostSemaphore));
+
+	pthread_mutex_init(&semaphore->lock, NULL);
+	pthread_cond_init(&semaphore->signal, NULL);
+	semaphore->count = 1;
+	return semaphore;
+}
+
+bool semaphoreGive(Semaphore semaphore) {
+	HostSemaphore *host = semaphore;
+
+	pthread_mutex_lock(&host->lock);
+	host->count = 1;
+	pthread_cond_signal(&host->signal);
+	pthread_mutex_unlock(&host->lock);
+	return true;
+}
+
+bool semaphoreTake(Semaphore semaphore, const unsigned long blockTime) {
+	HostSemaphore *host = semaphore;
+	bool taken;
+
+	pthread_mutex_lock(&host->lock);
+	while(host->count == 0 && blockTime != 0) {
+		pthread_cond_wait(&host->signal, &host->lock);
+	}
+	taken = host->count > 0;
+	host->count = 0;
+	pthread_mutex_unlock(&host->lock);
+	return taken;
+}
+
+Mutex mutexCreate() {
+	pthread_mutex_t *mutex = calloc(1, sizeof(pthread_mutex_t));
+
+	pthread_mutex_init(mutex, NULL);
+	return mutex;
+}
+
+bool mutexTake(Mutex mutex, const unsigned long blockTime) {
+	return pthread_mutex_lock(mutex) == 0;
+}
+
+bool mutexGive(Mutex mutex) {
+	return pthread_mutex_unlock(mutex) == 0;
+}
+
+unsigned long micros() {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long)((now.tv_sec - epoch.tv_sec) * 1000000LL +
+		(now.tv_nsec - epoch.tv_nsec) / 1000);
+}
+
+unsigned long millis() {
+	return micros() / 1000;
+}
+
+void delay(const unsigned long time) {
+	struct timespec wait = {time / 1000, (time % 1000) * 1000000L};
+
+	nanosleep(&wait, NULL);
+}
+
+bool isEnabled() {
+	return fieldEnabled;
+}
+
+bool isAutonomous() {
+	return fieldAutonomous;
+}
+
+bool isOnline() {
+	return true;
+}
+
+//What the routine's cleanup and the control task's lift hold touch, which do nothing here
+
+void pathFollowStop() {
+}
+
+void motorGroupSet(const MotorGroup *group, int speed) {
+}
+
+void liftControlHold() {
+}
+
+/**
+ * autonomousRoutine()
+ * Stands in for auto.c: a chain of blocking helpers polling modeRoutineAborted().
+ */
+void autonomousRoutine() {
+	unsigned long start;
+	int i;
+
+	for(i = 0; i < HELPERS && !modeRoutineAborted(); i++) {
+		start = millis();
+		while(millis() - start < HELPER_TIME && !modeRoutineAborted()) {
+			delay(MODE_POLL);
+		}
+	}
+}
+
+static void *controlThread(void *unused) {
+	unsigned long wake = millis();
+
+	while(!stop) {
+		modeUpdate();
+		commandUpdate();
+		wake += CONTROL_PERIOD;
+		while(millis() < wake) {
+			delay(1);
+		}
+	}
+	return NULL;
+}
+
+static void *routineThread(void *unused) {
+	while(!stop) {
+		modeRoutineRun();
+	}
+	return NULL;
+}
+
+/**
+ * trial()
+ * Starts the routine as its mode would, cuts it off after a while and times the handover.
+ *
+ * @return microseconds from the event to the routine letting go
+ */
+static unsigned long trial(Scenario scenario) {
+	unsigned long event, stick, loop;
+
+	fieldEnabled = true;
+	fieldAutonomous = scenario != SCENARIO_DRIVER;
+	//Let modeUpdate() see the mode before the routine starts, as autonomous() would
+	delay(2 * CONTROL_PERIOD);
+	while(!modeRoutineStart()) {
+		delay(1);
+	}
+	stick = millis() + CONTROL_PERIOD + rand() % EVENT_SPREAD;
+	if(scenario == SCENARIO_DRIVER) {
+		//operatorControl() only sees the stick at the loop after it moves
+		loop = millis();
+		while(loop < stick) {
+			loop += DRIVER_PERIOD;
+		}
+		while(millis() < stick) {
+			delay(1);
+		}
+		event = micros();
+		while(millis() < loop) {
+			delay(1);
+		}
+		if(modeRoutineRunning()) {
+			modeRoutineCancel();
+		}
+	} else {
+		while(millis() < stick) {
+			delay(1);
+		}
+		event = micros();
+		if(scenario == SCENARIO_FIELD) {
+			fieldAutonomous = false;
+		} else {
+			fieldEnabled = false;
+		}
+	}
+	while(modeRoutineRunning()) {
+		delay(1);
+	}
+	return micros() - event;
+}
+
+int main() {
+	pthread_t control, routine;
+	unsigned long latency, total, worst;
+	int scenario, i;
+
+	clock_gettime(CLOCK_MONOTONIC, &epoch);
+	srand(1);
+	commandInit();
+	modeInit();
+	pthread_create(&control, NULL, controlThread, NULL);
+	pthread_create(&routine, NULL, routineThread, NULL);
+
+	printf("%d trials each, control every %d ms, routine polls every %d ms\n", TRIALS,
+		CONTROL_PERIOD, MODE_POLL);
+	printf("scenario   mean us  worst us\n");
+	for(scenario = 0; scenario < SCENARIOS; scenario++) {
+		total = 0;
+		worst = 0;
+		for(i = 0; i < TRIALS; i++) {
+			latency = trial(scenario);
+			total += latency;
+			if(latency > worst) {
+				worst = latency;
+			}
+		}
+		printf("%-8s %9lu %9lu\n", scenarioNames[scenario], total / TRIALS, worst);
+	}
+
+	//The routine thread stays blocked on its start signal and ends with the process
+	stop = true;
+	pthread_join(control, NULL);
+	return 0;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Offline path planner for the pure pursuit follower (include/path.h).
+
+Fits quintic Hermite splines through the waypoints below, resamples them every SPACING inches,
+assigns each point a target speed limited by curvature and acceleration, and writes the result
+to src/paths.c and include/paths.h as const tables that are linked into flash.
+
+Edit PATHS and run from the project root:
+
+    python3 tools/pathgen.py
+"""
+
+import math
+import os
+
+# Waypoints as (x, y, heading in degrees); x is forward from the robot's start pose, in inches
+PATHS = {
+	"scoreCurve": [(0, 0, 0), (36, 24, 90), (36, 48, 90)],
+	"backToStart": [(36, 48, -90), (36, 24, -90), (0, 0, 180)],
+}
+
+SPACING = 1.0			# inches between path points
+MAX_SPEED = 20.0		# inches per second, matches PATH_MAX_SPEED
+MAX_ACCEL = 30.0		# inches per second squared
+TURN_SPEED = 3.0		# slows the robot on curves: speed limit = TURN_SPEED / curvature
+TANGENT_SCALE = 1.2		# tangent length as a multiple of the segment chord
+SAMPLES = 400			# samples per segment before resampling
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+
+def hermite(p0, v0, p1, v1, t):
+	"""Quintic Hermite point with zero acceleration at both ends."""
+	t2 = t * t
+	t3 = t2 * t
+	t4 = t3 * t
+	t5 = t4 * t
+	h0 = 1 - 10 * t3 + 15 * t4 - 6 * t5
+	h1 = t - 6 * t3 + 8 * t4 - 3 * t5
+	h4 = 10 * t3 - 15 * t4 + 6 * t5
+	h5 = -4 * t3 + 7 * t4 - 3 * t5
+	return tuple(h0 * p0[i] + h1 * v0[i] + h4 * p1[i] + h5 * v1[i] for i in range(2))
+
+
+def spline(waypoints):
+	"""Densely samples the spline through the waypoints."""
+	dense = []
+	for (x0, y0, a0), (x1, y1, a1) in zip(waypoints, waypoints[1:]):
+		scale = TANGENT_SCALE * math.hypot(x1 - x0, y1 - y0)
+		v0 = (scale * math.cos(math.radians(a0)), scale * math.sin(math.radians(a0)))
+		v1 = (scale * math.cos(math.radians(a1)), scale * math.sin(math.radians(a1)))
+		start = 0 if not dense else 1
+		for i in range(start, SAMPLES + 1):
+			dense.append(hermite((x0, y0), v0, (x1, y1), v1, i / SAMPLES))
+	return dense
+
+
+def resample(dense):
+	"""Picks points every SPACING inches of arc length."""
+	points = [dense[0]]
+	travelled = 0.0
+	for a, b in zip(dense, dense[1:]):
+		travelled += math.hypot(b[0] - a[0], b[1] - a[1])
+		if travelled >= SPACING:
+			points.append(b)
+			travelled = 0.0
+	if points[-1] != dense[-1]:
+		points.append(dense[-1])
+	return points
+
+
+def curvature(a, b, c):
+	"""Curvature of the circle through three points."""
+	ab = math.hypot(b[0] - a[0], b[1] - a[1])
+	bc = math.hypot(c[0] - b[0], c[1] - b[1])
+	ca = math.hypot(a[0] - c[0], a[1] - c[1])
+	area = abs((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])) / 2
+	if ab * bc * ca == 0:
+		return 0.0
+	return 4 * area / (ab * bc * ca)
+
+
+def speeds(points):
+	"""Target speed at each point, from curvature then acceleration limits both ways."""
+	limit = [MAX_SPEED] * len(points)
+	for i in range(1, len(points) - 1):
+		k = curvature(points[i - 1], points[i], points[i + 1])
+		if k > 0:
+			limit[i] = min(MAX_SPEED, TURN_SPEED / k)
+	limit[0] = 0.0
+	limit[-1] = 0.0
+	for i in range(1, len(points)):
+		step = math.hypot(points[i][0] - points[i - 1][0], points[i][1] - points[i - 1][1])
+		limit[i] = min(limit[i], math.sqrt(limit[i - 1] ** 2 + 2 * MAX_ACCEL * step))
+	for i in range(len(points) - 2, -1, -1):
+		step = math.hypot(points[i + 1][0] - points[i][0], points[i + 1][1] - points[i][1])
+		limit[i] = min(limit[i], math.sqrt(limit[i + 1] ** 2 + 2 * MAX_ACCEL * step))
+	return limit
+
+
+def fixed(value):
+	return int(round(value * 65536))
+
+
+def main():
+	source = [
+		"/** @file paths.c",
+		" * @brief Planned paths, generated by tools/pathgen.py; do not edit",
+		" */",
+		"",
+		"#include \"main.h\"",
+	]
+	header = [
+		"/** @file paths.h",
+		" * @brief Planned paths, generated by tools/pathgen.py; do not edit",
+		" */",
+		"",
+		"#ifndef PATHS_H_",
+		"#define PATHS_H_",
+		"",
+		"#include \"path.h\"",
+		"",
+	]
+	for name, waypoints in PATHS.items():
+		points = resample(spline(waypoints))
+		limit = speeds(points)
+		source.append("")
+		source.append("static const PathPoint %sPoints[%d] = {" % (name, len(points)))
+		rows = ["\t{%d, %d, %d}" % (fixed(p[0]), fixed(p[1]), fixed(v)) for p, v in zip(points, limit)]
+		source.append(",\n".join(rows))
+		source.append("};")
+		source.append("const Path %s = {%sPoints, %d};" % (name, name, len(points)))
+		header.append("extern const Path %s;" % name)
+	header.append("")
+	header.append("#endif")
+	with open(os.path.join(ROOT, "src", "paths.c"), "w") as out:
+		out.write("\n".join(source) + "\n")
+	with open(os.path.join(ROOT, "include", "paths.h"), "w") as out:
+		out.write("\n".join(header) + "\n")
+
+
+if __name__ == "__main__":
+	main()
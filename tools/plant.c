@@ -0,0 +1,361 @@
+/** @file plant.c
+ * @brief Physics models of the drive, lift and claw for host simulation
+ *
+ * The motor is the usual linear DC model: the stall figures give the torque constant and the
+ * winding resistance, and the free speed and free current give the back EMF constant and the
+ * internal friction. Friction and the wheel-floor contact are smoothed over a small speed so
+ * the integrator never meets a step. Stiction, which a smooth curve cannot hold, is applied
+ * between steps instead: a joint that is nearly still and does not push harder than its
+ * stiction is stopped.
+ */
+
+#include "plant.h"
+#include <math.h>
+#include <string.h>
+
+//Motor output speed in rad/s over which a motor's internal friction changes sign; its gearing
+//multiplies it at the load, so it is eased over more than PLANT_SMOOTH
+#define MOTOR_SMOOTH 1.0
+
+//Joint state variables
+enum {
+	JOINT_MOTOR_ANGLE,
+	JOINT_ANGLE,
+	JOINT_MOTOR_SPEED,
+	JOINT_SPEED,
+	JOINT_STATE
+};
+
+//Drive state variables
+enum {
+	DRIVE_X,
+	DRIVE_Y,
+	DRIVE_HEADING,
+	DRIVE_SPEED,
+	DRIVE_TURN_RATE,
+	DRIVE_LEFT_ANGLE,
+	DRIVE_RIGHT_ANGLE,
+	DRIVE_LEFT_SPEED,
+	DRIVE_RIGHT_SPEED,
+	DRIVE_STATE
+};
+
+//393 motor with torque gearing: 1.67 N m and 4.8 A at stall, 100 rpm and 0.37 A free, at 7.2 V
+const PlantMotor plantMotor393 = {1.67, 10.47, 4.8, 0.37, 7.2, 0.0004};
+//393 motor with high speed gearing: 160 rpm
+const PlantMotor plantMotor393Speed = {1.04, 16.76, 4.8, 0.37, 7.2, 0.00016};
+//A charged 7.2 V pack through the Cortex, the power expander and the wiring
+const PlantBattery plantBattery = {7.8, 0.1};
+
+//Four motors on a 10:1 reduction, a 35 cm arm, level at the lift's middle height; the encoder
+//on a motor shaft, so 3600 counts per lift turn and about 600 counts per second at free speed
+const PlantJointSpec plantLiftSpec = {
+	{1.67, 10.47, 4.8, 0.37, 7.2, 0.0004}, 4,
+	{10.0, 0.8},
+	{0.02, 0.03, 0.002, 0.5},
+	{0.3, 0.5, 0.05, 0.2},
+	{0.02, 2000.0, 20.0},
+	0.15, 0.35, 1.2, 0.6,
+	0.0, 1.3, 5000.0, 50.0,
+	3600.0
+};
+
+//Two motors straight onto the claw, free to close on an object up to 1.2 radians
+const PlantJointSpec plantClawSpec = {
+	{1.67, 10.47, 4.8, 0.37, 7.2, 0.0004}, 2,
+	{1.0, 0.95},
+	{0.01, 0.02, 0.001, 0.5},
+	{0.05, 0.1, 0.01, 0.2},
+	{0.05, 50.0, 0.5},
+	0.01, 0.0, 0.0, 0.0,
+	0.0, 1.2, 200.0, 2.0,
+	360.0
+};
+
+//Two motors a side, direct to 4" wheels, on a 6.8 kg robot with a 36 cm track
+const PlantDriveSpec plantDriveSpec = {
+	{1.67, 10.47, 4.8, 0.37, 7.2, 0.0004}, 2,
+	{1.0, 0.95},
+	{0.02, 0.04, 0.002, 0.5},
+	6.8, 0.25, 0.00026, 0.0508,
+	0.36,
+	0.9, 0.7, 0.1,
+	360.0
+};
+
+/**
+ * smoothSign()
+ * @return the sign of a speed, eased through zero over PLANT_SMOOTH
+ */
+static double smoothSign(double speed) {
+	return tanh(speed / PLANT_SMOOTH);
+}
+
+void plantRk4(PlantDerivative derivative, const void *model, double *state, int size,
+		double step) {
+	double k1[PLANT_STATE_MAX], k2[PLANT_STATE_MAX], k3[PLANT_STATE_MAX], k4[PLANT_STATE_MAX];
+	double probe[PLANT_STATE_MAX];
+	int i;
+
+	derivative(model, state, k1);
+	for(i = 0; i < size; i++) {
+		probe[i] = state[i] + step / 2 * k1[i];
+	}
+	derivative(model, probe, k2);
+	for(i = 0; i < size; i++) {
+		probe[i] = state[i] + step / 2 * k2[i];
+	}
+	derivative(model, probe, k3);
+	for(i = 0; i < size; i++) {
+		probe[i] = state[i] + step * k3[i];
+	}
+	derivative(model, probe, k4);
+	for(i = 0; i < size; i++) {
+		state[i] += step / 6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+	}
+}
+
+double plantMotorCurrent(const PlantMotor *motor, double volts, double speed) {
+	double resistance = motor->nominalVolts / motor->stallCurrent;
+	double backEmf = (motor->nominalVolts - motor->freeCurrent * resistance) / motor->freeSpeed;
+
+	return (volts - backEmf * speed) / resistance;
+}
+
+double plantMotorTorque(const PlantMotor *motor, double volts, double speed) {
+	double torqueConstant = motor->stallTorque / motor->stallCurrent;
+
+	return torqueConstant * (plantMotorCurrent(motor, volts, speed) -
+		motor->freeCurrent * tanh(speed / MOTOR_SMOOTH));
+}
+
+double plantVolts(int command, double batteryVolts) {
+	if(command > 127) {
+		command = 127;
+	} else if(command < -127) {
+		command = -127;
+	}
+	return batteryVolts * command / 127.0;
+}
+
+double plantGearTorque(const PlantGear *gear, double torque) {
+	return torque * gear->ratio * gear->efficiency;
+}
+
+double plantFrictionTorque(const PlantFriction *friction, double speed) {
+	double breakaway = friction->stribeck > 0 ? speed / friction->stribeck : 0;
+
+	return (friction->coulomb + (friction->stiction - friction->coulomb) *
+		exp(-breakaway * breakaway)) * smoothSign(speed) + friction->viscous * speed;
+}
+
+bool plantFrictionHolds(const PlantFriction *friction, double speed, double torque) {
+	return fabs(speed) < PLANT_SMOOTH && fabs(torque) < friction->stiction;
+}
+
+double plantBacklashTorque(const PlantBacklash *backlash, double twist, double rate) {
+	double half = backlash->gap / 2;
+
+	if(twist > half) {
+		return backlash->stiffness * (twist - half) + backlash->damping * rate;
+	}
+	if(twist < -half) {
+		return backlash->stiffness * (twist + half) + backlash->damping * rate;
+	}
+	return 0;
+}
+
+double plantBatteryVolts(const PlantBattery *battery, double current) {
+	return battery->openVolts - battery->resistance * current;
+}
+
+/**
+ * jointMotorInertia()
+ * @return the inertia of a joint's motors at the load
+ */
+static double jointMotorInertia(const PlantJointSpec *spec) {
+	return spec->motors * spec->motor.inertia * spec->gear.ratio * spec->gear.ratio;
+}
+
+/**
+ * jointLoadTorque()
+ * @return the torque on a joint's load from the backlash, gravity and the stops, everything
+ * but its own friction
+ */
+static double jointLoadTorque(const PlantJoint *joint, const double *state) {
+	const PlantJointSpec *spec = joint->spec;
+	double angle = state[JOINT_ANGLE];
+	double speed = state[JOINT_SPEED];
+	double torque = plantBacklashTorque(&spec->backlash,
+		state[JOINT_MOTOR_ANGLE] - angle, state[JOINT_MOTOR_SPEED] - speed);
+
+	torque -= (spec->armMass * spec->armLength / 2 + joint->payload * spec->armLength) *
+		PLANT_GRAVITY * cos(angle - spec->levelAngle);
+	if(angle < spec->minAngle) {
+		torque += spec->stopStiffness * (spec->minAngle - angle) - spec->stopDamping * speed;
+	} else if(angle > spec->maxAngle) {
+		torque -= spec->stopStiffness * (angle - spec->maxAngle) + spec->stopDamping * speed;
+	}
+	return torque;
+}
+
+/**
+ * jointMotorTorque()
+ * @return the torque the motors put on a joint's motor side, at the load
+ */
+static double jointMotorTorque(const PlantJoint *joint, const double *state) {
+	const PlantJointSpec *spec = joint->spec;
+
+	return spec->motors * plantGearTorque(&spec->gear, plantMotorTorque(&spec->motor,
+		joint->volts, state[JOINT_MOTOR_SPEED] * spec->gear.ratio));
+}
+
+static void jointDerivative(const void *model, const double *state, double *rate) {
+	const PlantJoint *joint = model;
+	const PlantJointSpec *spec = joint->spec;
+	double coupling = plantBacklashTorque(&spec->backlash,
+		state[JOINT_MOTOR_ANGLE] - state[JOINT_ANGLE],
+		state[JOINT_MOTOR_SPEED] - state[JOINT_SPEED]);
+	double load = spec->inertia + joint->payload * spec->armLength * spec->armLength;
+
+	rate[JOINT_MOTOR_ANGLE] = state[JOINT_MOTOR_SPEED];
+	rate[JOINT_ANGLE] = state[JOINT_SPEED];
+	rate[JOINT_MOTOR_SPEED] = (jointMotorTorque(joint, state) - coupling -
+		plantFrictionTorque(&spec->motorFriction, state[JOINT_MOTOR_SPEED])) /
+		jointMotorInertia(spec);
+	rate[JOINT_SPEED] = (jointLoadTorque(joint, state) -
+		plantFrictionTorque(&spec->loadFriction, state[JOINT_SPEED])) / load;
+}
+
+void plantJointInit(PlantJoint *joint, const PlantJointSpec *spec, double angle) {
+	memset(joint, 0, sizeof(PlantJoint));
+	joint->spec = spec;
+	joint->motorAngle = angle;
+	joint->angle = angle;
+}
+
+void plantJointStep(PlantJoint *joint, double volts, double step) {
+	const PlantJointSpec *spec = joint->spec;
+	double state[JOINT_STATE] = {
+		joint->motorAngle, joint->angle, joint->motorSpeed, joint->speed
+	};
+	double coupling;
+
+	joint->volts = volts;
+	plantRk4(jointDerivative, joint, state, JOINT_STATE, step);
+
+	//Stiction holds each side that has all but stopped and is not pushed past it
+	coupling = plantBacklashTorque(&spec->backlash,
+		state[JOINT_MOTOR_ANGLE] - state[JOINT_ANGLE],
+		state[JOINT_MOTOR_SPEED] - state[JOINT_SPEED]);
+	if(plantFrictionHolds(&spec->motorFriction, state[JOINT_MOTOR_SPEED],
+			jointMotorTorque(joint, state) - coupling)) {
+		state[JOINT_MOTOR_SPEED] = 0;
+	}
+	if(plantFrictionHolds(&spec->loadFriction, state[JOINT_SPEED],
+			jointLoadTorque(joint, state))) {
+		state[JOINT_SPEED] = 0;
+	}
+
+	joint->motorAngle = state[JOINT_MOTOR_ANGLE];
+	joint->angle = state[JOINT_ANGLE];
+	joint->motorSpeed = state[JOINT_MOTOR_SPEED];
+	joint->speed = state[JOINT_SPEED];
+	joint->current = spec->motors * fabs(plantMotorCurrent(&spec->motor, volts,
+		joint->motorSpeed * spec->gear.ratio));
+}
+
+int plantJointTicks(const PlantJoint *joint) {
+	return (int)floor(joint->angle / (2 * M_PI) * joint->spec->ticksPerTurn);
+}
+
+/**
+ * floorForce()
+ * @return the force one side's wheels push the robot forward with, from their slip
+ */
+static double floorForce(const PlantDriveSpec *spec, double slip) {
+	double peak = (fabs(slip) - spec->slipSpeed) / (2 * spec->slipSpeed);
+	double friction = spec->kineticFriction + (spec->staticFriction - spec->kineticFriction) *
+		exp(-peak * peak);
+
+	return spec->mass * PLANT_GRAVITY / 2 * friction * tanh(2 * slip / spec->slipSpeed);
+}
+
+/**
+ * sideAcceleration()
+ * @return the angular acceleration of one side's wheels
+ */
+static double sideAcceleration(const PlantDriveSpec *spec, double volts, double speed,
+		double force) {
+	double inertia = spec->wheelInertia + spec->motors * spec->motor.inertia *
+		spec->gear.ratio * spec->gear.ratio;
+	double torque = spec->motors * plantGearTorque(&spec->gear, plantMotorTorque(&spec->motor,
+		volts, speed * spec->gear.ratio));
+
+	return (torque - plantFrictionTorque(&spec->friction, speed) -
+		force * spec->wheelRadius) / inertia;
+}
+
+static void driveDerivative(const void *model, const double *state, double *rate) {
+	const PlantDrive *drive = model;
+	const PlantDriveSpec *spec = drive->spec;
+	double leftFloor = state[DRIVE_SPEED] - state[DRIVE_TURN_RATE] * spec->track / 2;
+	double rightFloor = state[DRIVE_SPEED] + state[DRIVE_TURN_RATE] * spec->track / 2;
+	double left = floorForce(spec, state[DRIVE_LEFT_SPEED] * spec->wheelRadius - leftFloor);
+	double right = floorForce(spec, state[DRIVE_RIGHT_SPEED] * spec->wheelRadius - rightFloor);
+
+	rate[DRIVE_X] = state[DRIVE_SPEED] * cos(state[DRIVE_HEADING]);
+	rate[DRIVE_Y] = state[DRIVE_SPEED] * sin(state[DRIVE_HEADING]);
+	rate[DRIVE_HEADING] = state[DRIVE_TURN_RATE];
+	rate[DRIVE_SPEED] = (left + right) / spec->mass;
+	rate[DRIVE_TURN_RATE] = (right - left) * spec->track / 2 / spec->yawInertia;
+	rate[DRIVE_LEFT_ANGLE] = state[DRIVE_LEFT_SPEED];
+	rate[DRIVE_RIGHT_ANGLE] = state[DRIVE_RIGHT_SPEED];
+	rate[DRIVE_LEFT_SPEED] = sideAcceleration(spec, drive->leftVolts, state[DRIVE_LEFT_SPEED],
+		left);
+	rate[DRIVE_RIGHT_SPEED] = sideAcceleration(spec, drive->rightVolts,
+		state[DRIVE_RIGHT_SPEED], right);
+}
+
+void plantDriveInit(PlantDrive *drive, const PlantDriveSpec *spec, double x, double y,
+		double heading) {
+	memset(drive, 0, sizeof(PlantDrive));
+	drive->spec = spec;
+	drive->x = x;
+	drive->y = y;
+	drive->heading = heading;
+}
+
+void plantDriveStep(PlantDrive *drive, double leftVolts, double rightVolts, double step) {
+	const PlantDriveSpec *spec = drive->spec;
+	double state[DRIVE_STATE] = {
+		drive->x, drive->y, drive->heading, drive->speed, drive->turnRate,
+		drive->leftAngle, drive->rightAngle, drive->leftSpeed, drive->rightSpeed
+	};
+
+	drive->leftVolts = leftVolts;
+	drive->rightVolts = rightVolts;
+	plantRk4(driveDerivative, drive, state, DRIVE_STATE, step);
+
+	drive->x = state[DRIVE_X];
+	drive->y = state[DRIVE_Y];
+	drive->heading = state[DRIVE_HEADING];
+	drive->speed = state[DRIVE_SPEED];
+	drive->turnRate = state[DRIVE_TURN_RATE];
+	drive->leftAngle = state[DRIVE_LEFT_ANGLE];
+	drive->rightAngle = state[DRIVE_RIGHT_ANGLE];
+	drive->leftSpeed = state[DRIVE_LEFT_SPEED];
+	drive->rightSpeed = state[DRIVE_RIGHT_SPEED];
+	drive->leftSlip = drive->leftSpeed * spec->wheelRadius -
+		(drive->speed - drive->turnRate * spec->track / 2);
+	drive->rightSlip = drive->rightSpeed * spec->wheelRadius -
+		(drive->speed + drive->turnRate * spec->track / 2);
+	drive->current = spec->motors * (fabs(plantMotorCurrent(&spec->motor, leftVolts,
+		drive->leftSpeed * spec->gear.ratio)) + fabs(plantMotorCurrent(&spec->motor,
+		rightVolts, drive->rightSpeed * spec->gear.ratio)));
+}
+
+int plantDriveTicks(const PlantDrive *drive, bool right) {
+	return (int)floor((right ? drive->rightAngle : drive->leftAngle) / (2 * M_PI) *
+		drive->spec->ticksPerTurn);
+}
@@ -0,0 +1,361 @@
+/** @file plant.h
+ * @brief Physics models of the drive, lift and claw for host simulation
+ *
+ * Host tools and simulators drive these models with the motor voltages the robot would send
+ * and read back what its sensors would see. Every model is built from the same parts:
+ *
+ *  - a 393 motor, a DC motor with a linear torque-speed curve and internal friction;
+ *  - a gear train with a ratio and an efficiency;
+ *  - Coulomb, viscous and Stribeck friction, where stiction holds a joint still until the
+ *    applied torque breaks it free;
+ *  - backlash, a dead band between the gear train and the load closed by a stiff spring;
+ *  - hard stops, also stiff springs, at the ends of a joint's travel.
+ *
+ * A joint is a motor side and a load side joined through backlash. With a gravity arm and a
+ * payload it is the lift; without one it is the claw. The differential drive has one motor side
+ * per wheel pair and rigid body dynamics. Each wheel pushes on the floor with a friction force
+ * that follows its slip, peaking at static friction and falling to kinetic friction.
+ *
+ * Every model advances with a fixed step fourth order Runge-Kutta integrator, plantRk4(). Units
+ * are SI: meters, radians, seconds, newtons, volts and amps. Angles and speeds on the motor
+ * side are at the motor's output shaft. The specs at the end are rough figures for this robot;
+ * change them here if the robot changes.
+ */
+
+#ifndef PLANT_H_
+#define PLANT_H_
+
+#include <stdbool.h>
+
+/**
+ * Integration step in seconds; the stiff springs and the wheel slip need it no larger
+ */
+#define PLANT_STEP 0.001
+/**
+ * Largest number of state variables of any model
+ */
+#define PLANT_STATE_MAX 10
+/**
+ * Speed in rad/s over which friction changes sign, so the models stay smooth enough to
+ * integrate at PLANT_STEP
+ */
+#define PLANT_SMOOTH 0.1
+/**
+ * Gravity in m/s^2
+ */
+#define PLANT_GRAVITY 9.81
+
+/**
+ * A DC motor at its nominal voltage
+ */
+typedef struct {
+	//Output torque at stall in N m and speed with no load in rad/s
+	double stallTorque;
+	double freeSpeed;
+	//Current at stall and with no load in A
+	double stallCurrent;
+	double freeCurrent;
+	double nominalVolts;
+	//Rotor inertia at the output shaft in kg m^2
+	double inertia;
+} PlantMotor;
+
+/**
+ * A gear train between a motor and its load
+ */
+typedef struct {
+	//Motor turns per load turn
+	double ratio;
+	//Share of the torque that reaches the load
+	double efficiency;
+} PlantGear;
+
+/**
+ * Friction on a shaft in N m, or on a wheel in N m at the wheel
+ */
+typedef struct {
+	//Torque to keep it moving, and to break it free from rest
+	double coulomb;
+	double stiction;
+	//Torque per rad/s
+	double viscous;
+	//Speed in rad/s over which the friction falls from stiction to Coulomb
+	double stribeck;
+} PlantFriction;
+
+/**
+ * Backlash between a gear train and its load
+ */
+typedef struct {
+	//Free play at the load in radians
+	double gap;
+	//Torque per radian and per rad/s once the play is taken up
+	double stiffness;
+	double damping;
+} PlantBacklash;
+
+/**
+ * A battery with internal resistance
+ */
+typedef struct {
+	double openVolts;
+	//Internal and wiring resistance in ohms
+	double resistance;
+} PlantBattery;
+
+/**
+ * A motor-driven joint: the lift, or with no arm the claw
+ */
+typedef struct {
+	PlantMotor motor;
+	//Motors driving the joint together
+	int motors;
+	PlantGear gear;
+	//Friction on the motor side and on the load side
+	PlantFriction motorFriction;
+	PlantFriction loadFriction;
+	PlantBacklash backlash;
+	//Load inertia in kg m^2, without the payload
+	double inertia;
+	//Arm length in m and mass in kg, centered halfway out; zero for no gravity load
+	double armLength;
+	double armMass;
+	//Load angle in radians at which the arm is level
+	double levelAngle;
+	//Travel limits in radians and the stops' stiffness and damping
+	double minAngle;
+	double maxAngle;
+	double stopStiffness;
+	double stopDamping;
+	//Encoder counts per load turn
+	double ticksPerTurn;
+} PlantJointSpec;
+
+/**
+ * A joint's state; read the fields, change only the payload
+ */
+typedef struct {
+	const PlantJointSpec *spec;
+	//Mass in kg carried at the end of the arm
+	double payload;
+	//Motor side angle in load radians, load angle, and their speeds
+	double motorAngle;
+	double angle;
+	double motorSpeed;
+	double speed;
+	//Voltage on each motor over the current step
+	double volts;
+	//Total motor current in A at the end of the last step
+	double current;
+} PlantJoint;
+
+/**
+ * A differential drive
+ */
+typedef struct {
+	PlantMotor motor;
+	//Motors on each side
+	int motors;
+	PlantGear gear;
+	//Friction in the drive train of one side, at the wheels
+	PlantFriction friction;
+	//Robot mass in kg, yaw inertia in kg m^2, and the rotating inertia of one side at the
+	//wheels besides the motors
+	double mass;
+	double yawInertia;
+	double wheelInertia;
+	double wheelRadius;
+	//Distance between the left and right wheels in m
+	double track;
+	//Floor friction coefficients, and the slip in m/s at which the static peak is reached
+	double staticFriction;
+	double kineticFriction;
+	double slipSpeed;
+	//Encoder counts per wheel turn
+	double ticksPerTurn;
+} PlantDriveSpec;
+
+/**
+ * A differential drive's state; read the fields
+ */
+typedef struct {
+	const PlantDriveSpec *spec;
+	//Pose in m and radians, counterclockwise positive
+	double x;
+	double y;
+	double heading;
+	//Forward speed in m/s and turn rate in rad/s
+	double speed;
+	double turnRate;
+	//Wheel angles and speeds of each side in radians and rad/s
+	double leftAngle;
+	double rightAngle;
+	double leftSpeed;
+	double rightSpeed;
+	//Voltage on each side's motors over the current step
+	double leftVolts;
+	double rightVolts;
+	//Total motor current in A at the end of the last step
+	double current;
+	//Slip of each side in m/s at the end of the last step, wheel speed less floor speed
+	double leftSlip;
+	double rightSlip;
+} PlantDrive;
+
+/**
+ * The rates of change of a model's state
+ *
+ * @param model the model
+ * @param state the state to take the rates at
+ * @param rate filled with the rate of each state variable
+ */
+typedef void (*PlantDerivative)(const void *model, const double *state, double *rate);
+
+extern const PlantMotor plantMotor393;
+extern const PlantMotor plantMotor393Speed;
+extern const PlantBattery plantBattery;
+extern const PlantJointSpec plantLiftSpec;
+extern const PlantJointSpec plantClawSpec;
+extern const PlantDriveSpec plantDriveSpec;
+
+/**
+ * plantRk4()
+ * Advances a state by one fourth order Runge-Kutta step.
+ *
+ * @param derivative the model's rates
+ * @param model the model
+ * @param state the state, advanced in place
+ * @param size the number of state variables, at most PLANT_STATE_MAX
+ * @param step the step in seconds
+ */
+void plantRk4(PlantDerivative derivative, const void *model, double *state, int size,
+	double step);
+
+/**
+ * plantMotorTorque()
+ * @param motor the motor
+ * @param volts the voltage across it
+ * @param speed its output speed in rad/s
+ * @return the torque at its output shaft in N m
+ */
+double plantMotorTorque(const PlantMotor *motor, double volts, double speed);
+
+/**
+ * plantMotorCurrent()
+ * @param motor the motor
+ * @param volts the voltage across it
+ * @param speed its output speed in rad/s
+ * @return the current it draws in A; negative while it brakes
+ */
+double plantMotorCurrent(const PlantMotor *motor, double volts, double speed);
+
+/**
+ * plantVolts()
+ * @param command a motor command from -127 to 127
+ * @param batteryVolts the battery voltage
+ * @return the average voltage the motor controller puts across the motor
+ */
+double plantVolts(int command, double batteryVolts);
+
+/**
+ * plantGearTorque()
+ * @param gear the gear train
+ * @param torque the torque at its input
+ * @return the torque at its output
+ */
+double plantGearTorque(const PlantGear *gear, double torque);
+
+/**
+ * plantFrictionTorque()
+ * @param friction the friction
+ * @param speed the speed in rad/s
+ * @return the friction torque, opposing the speed
+ */
+double plantFrictionTorque(const PlantFriction *friction, double speed);
+
+/**
+ * plantFrictionHolds()
+ * @param friction the friction
+ * @param speed the speed in rad/s
+ * @param torque the torque applied by everything else
+ * @return true if stiction holds the shaft still
+ */
+bool plantFrictionHolds(const PlantFriction *friction, double speed, double torque);
+
+/**
+ * plantBacklashTorque()
+ * @param backlash the backlash
+ * @param twist the drive side angle less the load side angle in radians
+ * @param rate the rate of the twist in rad/s
+ * @return the torque passed to the load
+ */
+double plantBacklashTorque(const PlantBacklash *backlash, double twist, double rate);
+
+/**
+ * plantBatteryVolts()
+ * @param battery the battery
+ * @param current the current drawn from it in A
+ * @return the voltage at its terminals
+ */
+double plantBatteryVolts(const PlantBattery *battery, double current);
+
+/**
+ * plantJointInit()
+ * Starts a joint at rest.
+ *
+ * @param joint the joint
+ * @param spec what it is built from
+ * @param angle its load angle in radians
+ */
+void plantJointInit(PlantJoint *joint, const PlantJointSpec *spec, double angle);
+
+/**
+ * plantJointStep()
+ * Advances a joint by one step.
+ *
+ * @param joint the joint
+ * @param volts the voltage on each of its motors
+ * @param step the step in seconds, normally PLANT_STEP
+ */
+void plantJointStep(PlantJoint *joint, double volts, double step);
+
+/**
+ * plantJointTicks()
+ * @param joint the joint
+ * @return the count of an encoder on the load, from zero at angle zero
+ */
+int plantJointTicks(const PlantJoint *joint);
+
+/**
+ * plantDriveInit()
+ * Starts a drive at rest.
+ *
+ * @param drive the drive
+ * @param spec what it is built from
+ * @param x the starting position in m
+ * @param y the starting position in m
+ * @param heading the starting heading in radians
+ */
+void plantDriveInit(PlantDrive *drive, const PlantDriveSpec *spec, double x, double y,
+	double heading);
+
+/**
+ * plantDriveStep()
+ * Advances a drive by one step.
+ *
+ * @param drive the drive
+ * @param leftVolts the voltage on each left motor
+ * @param rightVolts the voltage on each right motor
+ * @param step the step in seconds, normally PLANT_STEP
+ */
+void plantDriveStep(PlantDrive *drive, double leftVolts, double rightVolts, double step);
+
+/**
+ * plantDriveTicks()
+ * @param drive the drive
+ * @param right true for the right side
+ * @return the count of an encoder on that side's wheels, from zero at the start
+ */
+int plantDriveTicks(const PlantDrive *drive, bool right);
+
+#endif
@@ -0,0 +1,111 @@
+/** @file plantsim.c
+ * @brief A full match through the plant models, timed
+ *
+ * Built and run on the development machine with "make plantsim". It drives the drive, lift and
+ * claw models of tools/plant.c through a scripted two minute match at PLANT_STEP: a 15 second
+ * autonomous of drives, turns and lift moves, then driver control cycling through scoring runs
+ * with the payload picked up and dropped. The battery sags with the total motor current.
+ *
+ * It reports the wall time the match took next to the match time, and checks that the models
+ * stayed finite and in their travel. The figures it prints are a sanity check of the models:
+ * top drive speed, the highest lift, the peak current and the lowest battery voltage.
+ */
+
+#include "plant.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//Match length and autonomous period in seconds
+#define MATCH_TIME 120.0
+#define AUTONOMOUS_TIME 15.0
+//Length of one driver scoring cycle in seconds
+#define CYCLE_TIME 9.0
+//Payload in kg while an object is carried
+#define OBJECT_MASS 0.4
+
+typedef struct {
+	int left;
+	int right;
+	int lift;
+	int claw;
+} Commands;
+
+/**
+ * script()
+ * @return the motor commands at a time in the match
+ */
+static Commands script(double time, bool *carrying) {
+	Commands autonomous[] = {
+		{110, 110, 127, -60}, {110, -110, 20, -60}, {0, 0, -80, 127}, {-110, -110, 0, -60}
+	};
+	Commands driver[] = {
+		//Grab an object, drive to the goal raising the lift, turn, drop it and come back down
+		{60, 60, 0, 127}, {127, 127, 127, -40}, {80, -80, 15, -40}, {0, 0, 15, 127},
+		{-127, -127, -90, 0}, {-80, 80, 0, 0}
+	};
+	double phase;
+
+	if(time < AUTONOMOUS_TIME) {
+		*carrying = time < AUTONOMOUS_TIME / 2;
+		return autonomous[(int)(time / (AUTONOMOUS_TIME / 4)) % 4];
+	}
+	phase = fmod(time - AUTONOMOUS_TIME, CYCLE_TIME) / CYCLE_TIME;
+	*carrying = phase >= 1.0 / 6 && phase < 4.0 / 6;
+	return driver[(int)(phase * 6) % 6];
+}
+
+int main() {
+	PlantDrive drive;
+	PlantJoint lift, claw;
+	Commands commands;
+	struct timespec start, end;
+	double battery = plantBattery.openVolts;
+	double time, current, wall;
+	double topSpeed = 0, topLift = 0, peakCurrent = 0, lowBattery = battery;
+	double distance = 0;
+	bool carrying;
+	bool sane = true;
+	long steps = 0;
+
+	plantDriveInit(&drive, &plantDriveSpec, 0, 0, 0);
+	plantJointInit(&lift, &plantLiftSpec, 0);
+	plantJointInit(&claw, &plantClawSpec, 0);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(time = 0; time < MATCH_TIME; time += PLANT_STEP, steps++) {
+		commands = script(time, &carrying);
+		lift.payload = carrying ? OBJECT_MASS : 0;
+		plantDriveStep(&drive, plantVolts(commands.left, battery),
+			plantVolts(commands.right, battery), PLANT_STEP);
+		plantJointStep(&lift, plantVolts(commands.lift, battery), PLANT_STEP);
+		plantJointStep(&claw, plantVolts(commands.claw, battery), PLANT_STEP);
+
+		//The battery sees the motor current for the share of each PWM period it is switched on
+		current = drive.current * (abs(commands.left) + abs(commands.right)) / 254.0 +
+			lift.current * abs(commands.lift) / 127.0 + claw.current * abs(commands.claw) / 127.0;
+		battery = plantBatteryVolts(&plantBattery, current);
+
+		distance += fabs(drive.speed) * PLANT_STEP;
+		topSpeed = fmax(topSpeed, fabs(drive.speed));
+		topLift = fmax(topLift, lift.angle);
+		peakCurrent = fmax(peakCurrent, current);
+		lowBattery = fmin(lowBattery, battery);
+		sane = sane && isfinite(drive.x) && isfinite(drive.y) && isfinite(drive.leftSpeed) &&
+			isfinite(drive.rightSpeed) && isfinite(lift.motorSpeed) && isfinite(claw.motorSpeed) &&
+			lift.angle > -0.1 && lift.angle < 1.4 && claw.angle > -0.1 && claw.angle < 1.3;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	wall = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("match %.0f s in %ld steps of %.1f ms: %.3f s wall, %.0fx real time\n", MATCH_TIME,
+		steps, PLANT_STEP * 1000, wall, MATCH_TIME / wall);
+	printf("drive %.1f m traveled, top speed %.3f m/s, ended at (%.2f, %.2f)\n", distance,
+		topSpeed, drive.x, drive.y);
+	printf("lift top %.2f rad (%d ticks), claw at %.2f rad\n", topLift,
+		(int)(topLift / (2 * M_PI) * plantLiftSpec.ticksPerTurn), claw.angle);
+	printf("peak current %.1f A, lowest battery %.2f V\n", peakCurrent, lowBattery);
+	printf("%s\n", sane ? "models stayed finite and in travel" : "MODELS WENT UNSTABLE");
+	return sane ? 0 : 1;
+}
@@ -0,0 +1,579 @@
+/** @file powersim.c
+ * @brief PTC fuse model and power budget replayed against telemetry traces
+ *
+ * Built and run on the development machine with "make test-sim" or "make powersim". It replays
+ * traces in the format of the shell's text telemetry (T lines: time, drive and lift encoders,
+ * battery and the requested command of each port) through the robot's own src/power.c and
+ * src/motors.c, twice: once through motorFrameCommit(), budget and all, and once through the
+ * model alone with the requested commands sent as they are, which is how the robot drove
+ * before the budget. Measured speeds come from the encoder counts, as src/opcontrol.c reports
+ * them; the claw has no encoder and is taken as stalled, as on the robot.
+ *
+ * The model's heat is the only fuse there is on the host. A fuse trips when its heat reaches
+ * the trip point and cuts its motors out, a bank fuse all of the bank's, until it has cooled to
+ * PTC_RESET. The motors are taken to move as the trace says they did, so a replay is only fair
+ * while the budget does not change where the robot goes.
+ *
+ * Without arguments the tool runs synthetic traces, written as T lines and read back the way a
+ * recording is, and checks each against what the budget is for:
+ *
+ *  - liftStall: the lift driven into its hard stop; unbudgeted, a motor fuse trips when the
+ *    first order model says it should, budgeted nothing trips;
+ *  - clawHold: the claw squeezing an object while the lift holds; the claw is scaled down
+ *    first and the lift keeps its output;
+ *  - remapped: the lift moved to ports 1-4 with the calibration's port map and held gently;
+ *    the heat goes to bank 0 only, which trips unbudgeted and not budgeted;
+ *  - match: two minutes of driving, pushing, lifting and holding a cone in the claw. The drive
+ *    pushing at full power heats its bank more than the budget can make up for, as it never
+ *    scales the drive, so budgeted fewer fuses trip, for less time, and the drive keeps more of
+ *    its output.
+ *
+ * Each replay reports the output each mechanism got as a share of what was requested, the time
+ * motors were cut out and the peak fuse loads. A failed check makes the tool exit with status 1.
+ *
+ *     make powersim [TRACE="run1.txt run2.txt"]
+ *
+ * replays recorded traces instead, unchecked; capture them from the shell with "telemetry 50".
+ */
+
+#include "main.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//Encoder ticks per 20 ms at motor free speed, as in src/opcontrol.c
+#define FREE_TICKS 12
+#define FREE_PERIOD 20
+//Load in percent a tripped fuse cools to before it closes again
+#define PTC_RESET 50
+//Period of the synthetic traces in milliseconds, the rate "telemetry 50" streams at
+#define TRACE_PERIOD 20
+//Battery of the synthetic traces in millivolts
+#define TRACE_BATTERY 7800
+//Longest trace, two and a half minutes at TRACE_PERIOD
+#define TRACE_SAMPLES 7500
+//Longest T line
+#define TRACE_LINE 128
+//Share the modeled motor trip time may be off the closed form by
+#define TRIP_TOLERANCE 0.05
+
+typedef struct {
+	unsigned long time;
+	int leftTicks;
+	int rightTicks;
+	int liftTicks;
+	unsigned int battery;
+	//Requested command of each port, indexed from port 1
+	int ports[MOTOR_PORTS];
+} Sample;
+
+typedef enum {
+	MECHANISM_DRIVE,
+	MECHANISM_LIFT,
+	MECHANISM_CLAW,
+	MECHANISMS
+} Mechanism;
+
+typedef struct {
+	unsigned int trips;
+	//Time of the first trip, or 0 if nothing tripped, and time any motor was cut out, in ms
+	unsigned long firstTrip;
+	unsigned long cutOut;
+	int peakMotor;
+	int peakBank[POWER_BANKS];
+	//Output each mechanism got, as a percentage of what was requested
+	double output[MECHANISMS];
+} Result;
+
+typedef enum {
+	SCENARIO_LIFT_STALL,
+	SCENARIO_CLAW_HOLD,
+	SCENARIO_REMAPPED,
+	SCENARIO_MATCH,
+	SCENARIOS
+} Scenario;
+
+//What a synthetic trace asks of each mechanism, and how fast it moves as a share of free speed
+typedef struct {
+	int drive;
+	int lift;
+	int claw;
+	double driveSpeed;
+	double liftSpeed;
+} Demand;
+
+static const char *const scenarioNames[SCENARIOS] = {
+	"liftStall", "clawHold", "remapped", "match"
+};
+static const char *const mechanismNames[MECHANISMS] = {"drive", "lift", "claw"};
+static const MotorGroup *const mechanisms[MECHANISMS] = {
+	&driveLeftMotors, &liftMotors, &clawMotors
+};
+static Sample samples[TRACE_SAMPLES];
+
+//PROS stand-ins for what src/motors.c, src/profile.c and src/calibration.c use
+static unsigned long now;
+static unsigned int batteryMillivolts;
+//Last command sent to each Cortex port
+static int sent[MOTOR_PORTS];
+
+unsigned long millis() {
+	return now;
+}
+
+unsigned long micros() {
+	return now * 1000;
+}
+
+void motorSet(unsigned char channel, int speed) {
+	sent[channel - 1] = speed;
+}
+
+unsigned int powerLevelMain() {
+	return batteryMillivolts;
+}
+
+unsigned int lcdReadButtons(FILE *lcdPort) {
+	return 0;
+}
+
+void lcdSetText(FILE *lcdPort, unsigned char line, const char *buffer) {
+}
+
+void lcdPrint(FILE *lcdPort, unsigned char line, const char *formatString, ...) {
+}
+
+void displayStatus(const char *text) {
+}
+
+/**
+ * mechanismOf()
+ * @return the mechanism driving a motor, indexed from 0
+ */
+static Mechanism mechanismOf(int motor) {
+	int m, i;
+
+	for(m = 0; m < MECHANISMS; m++) {
+		for(i = 0; i < mechanisms[m]->count; i++) {
+			if(mechanisms[m]->ports[i] == motor + 1) {
+				return m;
+			}
+		}
+	}
+	//The right side of the drive
+	return MECHANISM_DRIVE;
+}
+
+/**
+ * bankOf()
+ * @return the Cortex bank a motor is on through the calibration's port map
+ */
+static int bankOf(int motor) {
+	return (calibration->ports[motor] - 1) / 5;
+}
+
+/**
+ * traceParse()
+ * Reads a T line into a sample.
+ *
+ * @return true if the line was a whole T line
+ */
+static bool traceParse(const char *line, Sample *sample) {
+	char *end;
+	long fields[5 + MOTOR_PORTS];
+	int i;
+
+	if(strncmp(line, "T,", 2) != 0) {
+		return false;
+	}
+	line += 2;
+	for(i = 0; i < 5 + MOTOR_PORTS; i++) {
+		fields[i] = strtol(line, &end, 10);
+		if(end == line || (i < 4 + MOTOR_PORTS && *end != ',')) {
+			return false;
+		}
+		line = end + 1;
+	}
+	sample->time = (unsigned long)fields[0];
+	sample->leftTicks = (int)fields[1];
+	sample->rightTicks = (int)fields[2];
+	sample->liftTicks = (int)fields[3];
+	sample->battery = (unsigned int)fields[4];
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		sample->ports[i] = (int)fields[5 + i];
+	}
+	return true;
+}
+
+/**
+ * traceLoad()
+ * Reads every T line of a recorded trace, skipping anything else the shell printed.
+ *
+ * @return the number of samples, or -1 if the file could not be read
+ */
+static int traceLoad(const char *path) {
+	static char text[TRACE_SAMPLES * TRACE_LINE];
+	char *line, *next;
+	ssize_t length;
+	int count = 0;
+	int file = open(path, O_RDONLY);
+
+	if(file < 0) {
+		return -1;
+	}
+	length = read(file, text, sizeof(text) - 1);
+	close(file);
+	if(length < 0) {
+		return -1;
+	}
+	text[length] = '\0';
+	for(line = text; line != NULL && count < TRACE_SAMPLES; line = next) {
+		next = strchr(line, '\n');
+		if(next != NULL) {
+			*next++ = '\0';
+		}
+		count += traceParse(line, &samples[count]);
+	}
+	return count;
+}
+
+/**
+ * demandAt()
+ * @return what a synthetic scenario asks of the robot at a time, in ms from its start
+ */
+static Demand demandAt(Scenario scenario, unsigned long time) {
+	Demand demand = {0, 0, 0, 0, 0};
+	//The match is a twelve second cycle: drive to the goal, push in, lift and stack, release
+	//and drive back with the lift down, then grab the next cone
+	unsigned long cycle = time % 12000;
+
+	switch(scenario) {
+	case SCENARIO_LIFT_STALL:
+		demand.lift = 127;
+		break;
+	case SCENARIO_CLAW_HOLD:
+		demand.claw = 127;
+		demand.lift = 30;
+		break;
+	case SCENARIO_REMAPPED:
+		demand.lift = 40;
+		break;
+	default:
+		demand.claw = 127;
+		if(cycle < 3000) {
+			demand.drive = 127;
+			demand.driveSpeed = 0.85;
+			demand.lift = 20;
+		} else if(cycle < 4500) {
+			//Pushing the goal into the zone
+			demand.drive = 127;
+			demand.driveSpeed = 0.4;
+			demand.lift = 20;
+		} else if(cycle < 6000) {
+			demand.lift = 127;
+			demand.liftSpeed = 0.7;
+		} else if(cycle < 7000) {
+			//Held against the stop while the cone is lined up
+			demand.lift = 127;
+		} else if(cycle < 8000) {
+			demand.lift = 40;
+			demand.claw = cycle < 7500 ? -127 : 0;
+		} else if(cycle < 11000) {
+			demand.drive = -127;
+			demand.driveSpeed = -0.85;
+			demand.lift = -60;
+			demand.liftSpeed = cycle < 9500 ? -0.6 : 0;
+			demand.claw = 0;
+		} else {
+			demand.lift = 20;
+		}
+		break;
+	}
+	return demand;
+}
+
+/**
+ * synthesize()
+ * Writes a synthetic scenario as T lines and reads them back into the samples.
+ *
+ * @return the number of samples
+ */
+static int synthesize(Scenario scenario, unsigned long length) {
+	char line[TRACE_LINE];
+	double drive = 0, lift = 0;
+	double freeTicks = FREE_TICKS * TRACE_PERIOD / (double)FREE_PERIOD;
+	Demand demand;
+	int commands[MECHANISMS];
+	int port[MOTOR_PORTS];
+	int count = 0;
+	int used, m, i;
+	unsigned long time;
+
+	for(time = 0; time <= length && count < TRACE_SAMPLES; time += TRACE_PERIOD) {
+		demand = demandAt(scenario, time);
+		commands[MECHANISM_DRIVE] = demand.drive;
+		commands[MECHANISM_LIFT] = demand.lift;
+		commands[MECHANISM_CLAW] = demand.claw;
+		for(i = 0; i < MOTOR_PORTS; i++) {
+			port[i] = 0;
+		}
+		for(m = 0; m < MECHANISMS; m++) {
+			for(i = 0; i < mechanisms[m]->count; i++) {
+				port[mechanisms[m]->ports[i] - 1] = mechanisms[m]->direction[i] * commands[m];
+			}
+		}
+		for(i = 0; i < driveRightMotors.count; i++) {
+			port[driveRightMotors.ports[i] - 1] = driveRightMotors.direction[i] * demand.drive;
+		}
+		drive += demand.driveSpeed * freeTicks;
+		lift += demand.liftSpeed * freeTicks;
+		//The shell's telemetryLine(), less the line ending
+		used = snprintf(line, sizeof(line), "T,%lu,%d,%d,%d,%u", time, (int)lround(drive),
+			(int)lround(drive), (int)lround(lift), TRACE_BATTERY);
+		for(i = 0; i < MOTOR_PORTS; i++) {
+			used += snprintf(line + used, sizeof(line) - used, ",%d", port[i]);
+		}
+		count += traceParse(line, &samples[count]);
+	}
+	return count;
+}
+
+/**
+ * measure()
+ * Reports a mechanism's speed from its encoder's change over a frame, to motorGroupMeasured()
+ * and into the speeds of each port.
+ */
+static void measure(const MotorGroup *group, int ticks, unsigned long elapsed, int *measured) {
+	int speed = elapsed == 0 ? 0 :
+		(int)(ticks * 127L * FREE_PERIOD / (FREE_TICKS * (long)elapsed));
+	int i;
+
+	motorGroupMeasured(group, speed);
+	for(i = 0; i < group->count; i++) {
+		measured[group->ports[i] - 1] = group->direction[i] * speed;
+	}
+}
+
+/**
+ * replay()
+ * Runs samples through the power model, with or without the budget.
+ */
+static void replay(int count, bool budgeted, Result *result) {
+	bool motorOpen[MOTOR_PORTS] = {false};
+	bool bankOpen[POWER_BANKS] = {false};
+	int delivered[MOTOR_PORTS] = {0};
+	int held[MOTOR_PORTS] = {0};
+	int measured[MOTOR_PORTS];
+	double requested[MECHANISMS] = {0};
+	double got[MECHANISMS] = {0};
+	unsigned long start, elapsed;
+	bool cut;
+	int load, m, b, i, s;
+
+	memset(result, 0, sizeof(Result));
+	//The clock only runs forward, and a replay starts with the motors stopped and the fuses cold
+	start = now + TRACE_PERIOD;
+	for(i = 0; i < MOTOR_PORTS; i++) {
+		motorFrameSet(i + 1, 0);
+	}
+	now = start;
+	motorFrameCommit();
+	powerModelReset();
+	for(s = 1; s < count; s++) {
+		const Sample *sample = &samples[s];
+
+		elapsed = sample->time - samples[s - 1].time;
+		now = start + sample->time - samples[0].time;
+		batteryMillivolts = sample->battery;
+		//The speed each motor measured over the frame just held, the claw's taken as stalled
+		memset(measured, 0, sizeof(measured));
+		measure(&driveLeftMotors, sample->leftTicks - samples[s - 1].leftTicks, elapsed, measured);
+		measure(&driveRightMotors, sample->rightTicks - samples[s - 1].rightTicks, elapsed,
+			measured);
+		measure(&liftMotors, sample->liftTicks - samples[s - 1].liftTicks, elapsed, measured);
+		motorGroupMeasured(&clawMotors, 0);
+
+		//An open fuse leaves its motors without current, whatever they are sent
+		cut = false;
+		for(i = 0; i < MOTOR_PORTS; i++) {
+			bool open = motorOpen[i] || bankOpen[bankOf(i)];
+
+			cut = cut || (open && sample->ports[i] != 0);
+			if(budgeted) {
+				motorFrameSet(i + 1, open ? 0 : sample->ports[i]);
+			} else {
+				delivered[i] = open ? 0 : sample->ports[i];
+			}
+		}
+		if(budgeted) {
+			motorFrameCommit();
+			for(i = 0; i < MOTOR_PORTS; i++) {
+				delivered[i] = sent[calibration->ports[i] - 1];
+			}
+		} else {
+			//As motorFrameCommit() does, less the budget
+			powerModelUpdate(held, measured, sample->battery, elapsed);
+			memcpy(held, delivered, sizeof(held));
+		}
+		result->cutOut += cut ? elapsed : 0;
+
+		for(i = 0; i < MOTOR_PORTS; i++) {
+			requested[mechanismOf(i)] += abs(sample->ports[i]) * (double)elapsed;
+			got[mechanismOf(i)] += abs(delivered[i]) * (double)elapsed;
+			load = powerMotorLoad(i + 1);
+			result->peakMotor = load > result->peakMotor ? load : result->peakMotor;
+			if(!motorOpen[i] && load >= 100) {
+				motorOpen[i] = true;
+				result->trips++;
+				result->firstTrip = result->firstTrip ? result->firstTrip : now - start;
+			} else if(motorOpen[i] && load < PTC_RESET) {
+				motorOpen[i] = false;
+			}
+		}
+		for(b = 0; b < POWER_BANKS; b++) {
+			load = powerBankLoad(b);
+			result->peakBank[b] = load > result->peakBank[b] ? load : result->peakBank[b];
+			if(!bankOpen[b] && load >= 100) {
+				bankOpen[b] = true;
+				result->trips++;
+				result->firstTrip = result->firstTrip ? result->firstTrip : now - start;
+			} else if(bankOpen[b] && load < PTC_RESET) {
+				bankOpen[b] = false;
+			}
+		}
+	}
+	for(m = 0; m < MECHANISMS; m++) {
+		result->output[m] = requested[m] > 0 ? 100 * got[m] / requested[m] : 100;
+	}
+}
+
+/**
+ * remap()
+ * Moves the right side of the lift to ports 1 and 2 and the left side of the drive to where it
+ * was, with the calibration's port map, or puts them back.
+ */
+static void remap(bool moved) {
+	static const char *const motors[] = {
+		"leftBackDrive", "leftFrontDrive", "rightLiftOuter", "rightLiftInner"
+	};
+	static const char *const movedTo[] = {"7", "8", "1", "2"};
+	static const char *const original[] = {"1", "2", "7", "8"};
+	unsigned int i;
+
+	for(i = 0; i < sizeof(motors) / sizeof(motors[0]); i++) {
+		calibrationFieldSet(calibrationFieldFind(motors[i]), moved ? movedTo[i] : original[i]);
+	}
+}
+
+/**
+ * check()
+ * @return the failures of a synthetic scenario's replays, as a comma separated list, or an
+ * empty string if it passed
+ */
+static const char *check(Scenario scenario, const Result *unbudgeted, const Result *budgeted,
+		char *reasons, size_t size) {
+	//When the first order model says a stalled motor's fuse trips
+	double current = powerMotorCurrent(127, 0, TRACE_BATTERY);
+	double tripTime = -POWER_MOTOR_TAU_MS * log(1 - pow(POWER_MOTOR_TRIP_MA / current, 2));
+
+	reasons[0] = '\0';
+	//The budget cannot scale the drive, so over the match it only has to do better than none
+	if(scenario != SCENARIO_MATCH && budgeted->trips > 0) {
+		strncat(reasons, "tripped,", size - strlen(reasons) - 1);
+	}
+	switch(scenario) {
+	case SCENARIO_LIFT_STALL:
+		if(fabs(unbudgeted->firstTrip - tripTime) > tripTime * TRIP_TOLERANCE) {
+			strncat(reasons, "trip time,", size - strlen(reasons) - 1);
+		}
+		break;
+	case SCENARIO_CLAW_HOLD:
+		if(budgeted->output[MECHANISM_CLAW] >= budgeted->output[MECHANISM_LIFT] ||
+				budgeted->output[MECHANISM_LIFT] < 99) {
+			strncat(reasons, "order,", size - strlen(reasons) - 1);
+		}
+		break;
+	case SCENARIO_REMAPPED:
+		if(unbudgeted->trips == 0 || unbudgeted->peakMotor >= 100 ||
+				unbudgeted->peakBank[1] > 0) {
+			strncat(reasons, "banks,", size - strlen(reasons) - 1);
+		}
+		break;
+	default:
+		if(unbudgeted->trips == 0 || budgeted->trips >= unbudgeted->trips ||
+				budgeted->cutOut >= unbudgeted->cutOut ||
+				budgeted->output[MECHANISM_DRIVE] <= unbudgeted->output[MECHANISM_DRIVE]) {
+			strncat(reasons, "no gain,", size - strlen(reasons) - 1);
+		}
+		break;
+	}
+	if(reasons[0] != '\0') {
+		reasons[strlen(reasons) - 1] = '\0';
+	}
+	return reasons;
+}
+
+/**
+ * report()
+ * Prints one replay.
+ */
+static void report(const char *name, bool budgeted, const Result *result, const char *reasons) {
+	int m;
+
+	printf("%-12s %-10s %5u %7.2f %7.2f %6d %5d %5d", name, budgeted ? "budgeted" : "unbudgeted",
+		result->trips, result->firstTrip / 1000.0, result->cutOut / 1000.0, result->peakMotor,
+		result->peakBank[0], result->peakBank[1]);
+	for(m = 0; m < MECHANISMS; m++) {
+		printf(" %6.1f", result->output[m]);
+	}
+	printf("%s%s\n", reasons[0] ? " FAIL " : "", reasons);
+}
+
+int main(int argc, char **argv) {
+	//Length of each synthetic scenario in milliseconds
+	static const unsigned long lengths[SCENARIOS] = {30000, 60000, 60000, 120000};
+	Result unbudgeted, budgeted;
+	char reasons[64];
+	unsigned int failures = 0;
+	int count, scenario, m, i;
+
+	printf("%-12s %-10s %5s %7s %7s %6s %5s %5s", "trace", "replay", "trips", "firstS", "cutS",
+		"motor%", "bank0", "bank1");
+	for(m = 0; m < MECHANISMS; m++) {
+		printf(" %5s%%", mechanismNames[m]);
+	}
+	printf("\n");
+	if(argc > 1) {
+		for(i = 1; i < argc; i++) {
+			count = traceLoad(argv[i]);
+			if(count < 2) {
+				printf("%-12s no T lines read\n", argv[i]);
+				failures++;
+				continue;
+			}
+			replay(count, false, &unbudgeted);
+			replay(count, true, &budgeted);
+			report(argv[i], false, &unbudgeted, "");
+			report(argv[i], true, &budgeted, "");
+		}
+		return failures > 0 ? 1 : 0;
+	}
+
+	for(scenario = 0; scenario < SCENARIOS; scenario++) {
+		remap(scenario == SCENARIO_REMAPPED);
+		count = synthesize(scenario, lengths[scenario]);
+		replay(count, false, &unbudgeted);
+		replay(count, true, &budgeted);
+		check(scenario, &unbudgeted, &budgeted, reasons, sizeof(reasons));
+		failures += reasons[0] != '\0';
+		report(scenarioNames[scenario], false, &unbudgeted, "");
+		report(scenarioNames[scenario], true, &budgeted, reasons);
+	}
+	remap(false);
+	printf("over the match the budget keeps %.1f%% of the drive output against %.1f%% without it, "
+		"cut out for %.1f s against %.1f s\n", budgeted.output[MECHANISM_DRIVE],
+		unbudgeted.output[MECHANISM_DRIVE], budgeted.cutOut / 1000.0, unbudgeted.cutOut / 1000.0);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+/** @file queuebench.c
+ * @brief Host benchmark of the Ring and Seqlock against a mutex
+ *
+ * Built and run on the development machine with "make queuebench". It compiles the robot's
+ * src/containers.c unchanged and drives it from real threads:
+ *
+ *  - ring: one thread pushes time-stamped items and another pops them, reporting throughput,
+ *    the producer's full-queue retries and the push-to-pop latency percentiles, next to the
+ *    same queue guarded by a pthread mutex.
+ *  - seqlock: one thread writes a snapshot whose words all hold the same count while reader
+ *    threads copy it and check that no copy is torn, reporting reads per second and retries,
+ *    next to the same snapshot guarded by a mutex.
+ *
+ * The containers only use compiler barriers, which is enough on the single-core Cortex and on
+ * x86, whose stores and loads are not reordered among themselves. Do not trust the results on
+ * a weakly ordered host such as ARM64.
+ */
+
+#include "main.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RING_ITEMS 2000000
+#define RING_CAPACITY 32
+#define SEQLOCK_READERS 3
+#define SEQLOCK_TIME_NS 1000000000LL
+#define SNAPSHOT_WORDS 12
+
+typedef struct {
+	unsigned long long stamp;
+	unsigned int sequence;
+} Item;
+
+typedef struct {
+	unsigned int words[SNAPSHOT_WORDS];
+} Snapshot;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int useMutex;
+static Ring ring;
+static Seqlock cell;
+static Snapshot guarded;
+static unsigned int latency[RING_ITEMS];
+static volatile unsigned long long producerRetries;
+static volatile int stop;
+
+//The arena is only used during initialize() on the robot; the host takes the memory from libc
+void *arenaAlloc(unsigned int bytes) {
+	return calloc(1, bytes);
+}
+
+void arenaTrack(const char *name, unsigned int capacity, const volatile unsigned int *peak) {
+}
+
+static unsigned long long now() {
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+static int push(const Item *item) {
+	int pushed;
+
+	if(!useMutex) {
+		return ringPush(&ring, item);
+	}
+	pthread_mutex_lock(&lock);
+	pushed = ringPush(&ring, item);
+	pthread_mutex_unlock(&lock);
+	return pushed;
+}
+
+static int pop(Item *item) {
+	int popped;
+
+	if(!useMutex) {
+		return ringPop(&ring, item);
+	}
+	pthread_mutex_lock(&lock);
+	popped = ringPop(&ring, item);
+	pthread_mutex_unlock(&lock);
+	return popped;
+}
+
+static void *producer(void *unused) {
+	Item item;
+	unsigned int i;
+
+	for(i = 0; i < RING_ITEMS; i++) {
+		item.sequence = i;
+		item.stamp = now();
+		//Give the consumer the core, as a task would by delaying, in case there is only one
+		while(!push(&item)) {
+			producerRetries++;
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static int compareLatency(const void *a, const void *b) {
+	unsigned int x = *(const unsigned int *)a;
+	unsigned int y = *(const unsigned int *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void ringBench(const char *name) {
+	pthread_t thread;
+	Item item;
+	unsigned long long start;
+	unsigned long long elapsed;
+	unsigned int expected = 0;
+	unsigned int errors = 0;
+
+	ringInit(&ring, "bench", sizeof(Item), RING_CAPACITY);
+	producerRetries = 0;
+	start = now();
+	pthread_create(&thread, NULL, producer, NULL);
+	while(expected < RING_ITEMS) {
+		if(pop(&item)) {
+			latency[expected] = (unsigned int)(now() - item.stamp);
+			errors += item.sequence != expected;
+			expected++;
+		} else {
+			sched_yield();
+		}
+	}
+	elapsed = now() - start;
+	pthread_join(thread, NULL);
+	free(ring.data);
+
+	qsort(latency, RING_ITEMS, sizeof(latency[0]), compareLatency);
+	printf("ring %-8s %6.2f Mitems/s  full retries %llu  order errors %u  latency ns p50 %u "
+		"p99 %u p99.99 %u max %u\n", name, RING_ITEMS * 1000.0 / elapsed, producerRetries,
+		errors, latency[RING_ITEMS / 2], latency[RING_ITEMS / 100 * 99],
+		latency[RING_ITEMS / 10000 * 9999], latency[RING_ITEMS - 1]);
+}
+
+static void *writer(void *unused) {
+	Snapshot snapshot;
+	unsigned int count = 0;
+	unsigned int i;
+
+	while(!stop) {
+		count++;
+		for(i = 0; i < SNAPSHOT_WORDS; i++) {
+			snapshot.words[i] = count;
+		}
+		if(useMutex) {
+			pthread_mutex_lock(&lock);
+			guarded = snapshot;
+			pthread_mutex_unlock(&lock);
+		} else {
+			seqlockWrite(&cell, &snapshot);
+		}
+	}
+	return NULL;
+}
+
+typedef struct {
+	unsigned long long reads;
+	unsigned long long torn;
+} ReaderResult;
+
+static void *reader(void *param) {
+	ReaderResult *result = param;
+	Snapshot snapshot;
+	unsigned int i;
+
+	while(!stop) {
+		if(useMutex) {
+			pthread_mutex_lock(&lock);
+			snapshot = guarded;
+			pthread_mutex_unlock(&lock);
+		} else {
+			seqlockRead(&cell, &snapshot);
+		}
+		for(i = 1; i < SNAPSHOT_WORDS; i++) {
+			if(snapshot.words[i] != snapshot.words[0]) {
+				result->torn++;
+				break;
+			}
+		}
+		result->reads++;
+	}
+	return NULL;
+}
+
+static void seqlockBench(const char *name) {
+	pthread_t writerThread;
+	pthread_t readerThreads[SEQLOCK_READERS];
+	ReaderResult results[SEQLOCK_READERS];
+	struct timespec wait = {SEQLOCK_TIME_NS / 1000000000LL, SEQLOCK_TIME_NS % 1000000000LL};
+	unsigned long long reads = 0;
+	unsigned long long torn = 0;
+	int i;
+
+	seqlockInit(&cell, sizeof(Snapshot));
+	memset(results, 0, sizeof(results));
+	stop = 0;
+	pthread_create(&writerThread, NULL, writer, NULL);
+	for(i = 0; i < SEQLOCK_READERS; i++) {
+		pthread_create(&readerThreads[i], NULL, reader, &results[i]);
+	}
+	nanosleep(&wait, NULL);
+	stop = 1;
+	pthread_join(writerThread, NULL);
+	for(i = 0; i < SEQLOCK_READERS; i++) {
+		pthread_join(readerThreads[i], NULL);
+		reads += results[i].reads;
+		torn += results[i].torn;
+	}
+	free(cell.data);
+
+	printf("seqlock %-5s %6.2f Mreads/s over %d readers  retries %u  torn reads %llu\n", name,
+		reads * 1000.0 / SEQLOCK_TIME_NS, SEQLOCK_READERS, useMutex ? 0 : cell.retries, torn);
+}
+
+int main() {
+	useMutex = 0;
+	ringBench("lockfree");
+	useMutex = 1;
+	ringBench("mutex");
+
+	useMutex = 0;
+	seqlockBench("cell");
+	useMutex = 1;
+	seqlockBench("mutex");
+	return 0;
+}
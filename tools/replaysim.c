@@ -0,0 +1,226 @@
+/** @file replaysim.c
+ * @brief Record and replay of a driver session through the plant models
+ *
+ * Built and run on the development machine with "make test-sim" or "make replay". It links the
+ * robot's driver code and src/replay.c with the host stand-ins of tools/simrobot.c, drives a
+ * scripted session through operatorControl()'s loop and records it as the robot does: each
+ * iteration is queued with replayRecord() and the queue drained into lines as the shell task
+ * would send them. The session drives, turns, runs and holds the lift, works the claw, starts
+ * the score macro while turning and pulls the partner joystick out and back in with its stick
+ * held over.
+ *
+ * The lines are then replayed through replayLine() as the "replay" shell command does, which
+ * runs driverStep() again on each recorded input and diffs the motor frame it writes with the
+ * one recorded. A mismatch, a gap or a frame that did not come back makes the tool exit with
+ * status 1. It also reports how much of the console the recording takes at the driver loop's
+ * rate.
+ *
+ * Given a file, it replays a log captured from the robot's console instead:
+ *
+ *     make replay [REC=file]
+ */
+
+#include "main.h"
+#include "simrobot.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//Driver loop period in opcontrol.c
+#define DRIVER_PERIOD 20
+//Length of the scripted session in ms
+#define SESSION_TIME 16000
+//Lines kept of a session; the script records one a loop plus a few for gaps
+#define SESSION_LINES (SESSION_TIME / DRIVER_PERIOD + 64)
+//Console baud rate
+#define BAUD 115200
+//Bytes read from a log at a time
+#define READ_CHUNK 4096
+
+/**
+ * What the joysticks read from a time in the session on
+ */
+typedef struct {
+	unsigned long time;
+	SimJoystick driver;
+	SimJoystick partner;
+} Phase;
+
+//Joystick 1 drives and runs the macros, joystick 2 runs the lift and claw (calibration.c)
+static const Phase script[] = {
+	{0, {true, {0, -100, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{2000, {true, {70, -40, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{4000, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{5000, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 90, 0}, {0, 0, 0, 0}}},
+	{6500, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{8000, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, JOY_UP, 0, 0}}},
+	{8600, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, JOY_DOWN, 0, 0}}},
+	{9000, {true, {50, 0, 0, 0}, {JOY_UP, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{9100, {true, {50, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{12000, {true, {0, -60, -70, 0}, {0, 0, 0, 0}}, {false, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{13000, {true, {0, -60, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 80, 0}, {0, 0, 0, 0}}},
+	{13500, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+	{14000, {true, {0, 100, 0, 0}, {0, 0, 0, 0}}, {true, {0, 0, 0, 0}, {0, 0, 0, 0}}},
+};
+
+static char lines[SESSION_LINES][REPLAY_LINE];
+
+//Robot code replaysim does not link, which operatorControl() and replayRun() call
+
+bool autotuneLift() {
+	return false;
+}
+
+bool autotuneDrive() {
+	return false;
+}
+
+void displayZero() {
+}
+
+bool selftestActive() {
+	return false;
+}
+
+void tasksReport(FILE *stream) {
+}
+
+void shellSuspend(bool suspend) {
+}
+
+/**
+ * scriptAt()
+ * Sets the joysticks to the script's phase for a time in the session.
+ */
+static void scriptAt(unsigned long time) {
+	unsigned int i = 0;
+
+	while(i + 1 < sizeof(script) / sizeof(script[0]) && script[i + 1].time <= time) {
+		i++;
+	}
+	simJoystick(1, &script[i].driver);
+	simJoystick(2, &script[i].partner);
+}
+
+/**
+ * record()
+ * Drives the scripted session and records it.
+ *
+ * @return the lines recorded
+ */
+static unsigned int record() {
+	SimWall wall = {false, 0, 0, 0};
+	DriverInput input;
+	unsigned long start;
+	unsigned int count = 0;
+	bool first = true;
+
+	simStart(7.8, SIM_FAULT_NONE, &wall);
+	simDriverControl();
+	replayInit();
+	scriptAt(0);
+	driverInputSample(&input);
+	driverReset(&input);
+	for(start = millis(); millis() - start < SESSION_TIME;) {
+		scriptAt(millis() - start);
+		//operatorControl()'s loop, recording from its first iteration
+		delay(DRIVER_PERIOD);
+		driverInputSample(&input);
+		if(liftControlActive() && driverMoving(&input, 1 << DRIVER_LIFT)) {
+			liftControlRelease();
+		}
+		macroUpdate(&input);
+		if(first) {
+			driverReset(&input);
+			first = false;
+		}
+		driverStep(&input);
+		replayRecord(&input, 0);
+		//The shell task's sends
+		while(count < SESSION_LINES && replayNextLine(lines[count], REPLAY_LINE)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * load()
+ * Reads a log captured from the console into lines.
+ *
+ * @return the lines read, or -1 if the file could not be read
+ */
+static int load(const char *path) {
+	char chunk[READ_CHUNK];
+	unsigned int count = 0;
+	unsigned int used = 0;
+	ssize_t got;
+	ssize_t i;
+	int file = open(path, O_RDONLY);
+
+	if(file < 0) {
+		return -1;
+	}
+	while((got = read(file, chunk, sizeof(chunk))) > 0) {
+		for(i = 0; i < got && count < SESSION_LINES; i++) {
+			if(chunk[i] == '\n') {
+				lines[count++][used] = '\0';
+				used = 0;
+			} else if(used + 1 < REPLAY_LINE) {
+				lines[count][used++] = chunk[i];
+			}
+		}
+	}
+	if(used > 0 && count < SESSION_LINES) {
+		lines[count++][used] = '\0';
+	}
+	close(file);
+	return got < 0 ? -1 : (int)count;
+}
+
+int main(int argc, char **argv) {
+	unsigned long bytes = 0;
+	unsigned int longest = 0;
+	unsigned int length;
+	unsigned int count;
+	unsigned int recorded = 0;
+	unsigned int i;
+	double share;
+	int loaded;
+	bool ok;
+
+	if(argc > 1) {
+		loaded = load(argv[1]);
+		if(loaded < 0) {
+			printf("could not read %s\n", argv[1]);
+			return 1;
+		}
+		count = (unsigned int)loaded;
+	} else {
+		count = record();
+		for(i = 0; i < count; i++) {
+			//Sent with a carriage return and a newline
+			length = strlen(lines[i]) + 2;
+			bytes += length;
+			longest = length > longest ? length : longest;
+			recorded += lines[i][0] == 'F';
+		}
+		//Ten bits a byte on the wire, one line a loop
+		share = count > 0 ? bytes * 10 * 1000.0 / (count * DRIVER_PERIOD) / BAUD * 100 : 0;
+		printf("recorded %u lines of %lu bytes on average, %u at most, %u in full: %.0f%% of %d "
+			"baud\n", count, count > 0 ? bytes / count : 0, longest,
+			(unsigned int)strlen(lines[0]) + 2, share, BAUD);
+	}
+
+	replayBegin();
+	for(i = 0; i < count; i++) {
+		replayLine(lines[i]);
+	}
+	ok = replayEnd();
+	if(argc <= 1 && recorded != SESSION_TIME / DRIVER_PERIOD) {
+		printf("recorded %u of %d loops FAIL\n", recorded, SESSION_TIME / DRIVER_PERIOD);
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,312 @@
+/** @file simrobot.c
+ * @brief The robot code on the host, driving the plant models
+ *
+ * Motor commands reach the models the way they reach the robot: each mechanism gets the
+ * average of its group's ports, as sent by motorFrameCommit(), turned into volts at the
+ * battery's present voltage. The battery sags with the current the motors draw for the share
+ * of each PWM period they are switched on.
+ */
+
+#include "main.h"
+#include "plant.h"
+#include "simrobot.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define METERS_PER_INCH 0.0254
+//Time given to the robot to come to rest after a routine, in milliseconds
+#define SETTLE_TIME 500
+//Widest angle off square, in radians, at which an ultrasonic still hears its echo
+#define RANGE_CONE 0.5
+
+static PlantDrive drive;
+static PlantJoint liftJoint;
+static PlantJoint clawJoint;
+static PlantBattery battery;
+static double batteryVolts;
+static SimFault fault;
+static SimWall wall;
+
+static SimJoystick joysticks[2];
+static bool driverControl;
+
+static unsigned long now;
+static unsigned long deadline;
+static bool cutOff;
+static double peakCurrent;
+static double lowBattery;
+//Last command sent to each port, indexed from port 1
+static int ports[MOTOR_PORTS];
+//Handles for the encoders and ultrasonics, by their first port
+static unsigned char sensorPorts[BOARD_NR_GPIO_PINS + 1];
+
+//PROS stand-ins for what the linked robot sources use
+
+unsigned long millis() {
+	return now;
+}
+
+unsigned long micros() {
+	return now * 1000;
+}
+
+bool isEnabled() {
+	return true;
+}
+
+bool isAutonomous() {
+	return !driverControl;
+}
+
+bool isOnline() {
+	return true;
+}
+
+bool isJoystickConnected(unsigned char joystick) {
+	return joysticks[joystick - 1].connected;
+}
+
+int joystickGetAnalog(unsigned char joystick, unsigned char axis) {
+	return joysticks[joystick - 1].analog[axis - 1];
+}
+
+bool joystickGetDigital(unsigned char joystick, unsigned char buttonGroup, unsigned char button) {
+	return (joysticks[joystick - 1].buttons[buttonGroup - 5] & button) != 0;
+}
+
+void motorSet(unsigned char channel, int speed) {
+	ports[channel - 1] = speed;
+}
+
+unsigned int powerLevelMain() {
+	return (unsigned int)(batteryVolts * 1000);
+}
+
+Encoder encoderInit(unsigned char portTop, unsigned char portBottom, bool reverse) {
+	sensorPorts[portTop] = portTop;
+	return &sensorPorts[portTop];
+}
+
+int encoderGet(Encoder enc) {
+	switch(*(unsigned char *)enc) {
+	case 1:
+		return fault == SIM_FAULT_LEFT_ENCODER ? 0 : plantDriveTicks(&drive, false);
+	case 3:
+		return plantDriveTicks(&drive, true);
+	case 5:
+		return fault == SIM_FAULT_LIFT_ENCODER ? 0 : plantJointTicks(&liftJoint);
+	default:
+		return 0;
+	}
+}
+
+int analogCalibrate(unsigned char channel) {
+	return 0;
+}
+
+int analogRead(unsigned char channel) {
+	return 0;
+}
+
+int analogReadCalibratedHR(unsigned char channel) {
+	double scale = calibration->gyroScale / 65536.0;
+	int counts = (int)lround(drive.turnRate * 180 / M_PI * scale);
+
+	return fault == SIM_FAULT_GYRO_DRIFT ? counts + SIM_GYRO_DRIFT : counts;
+}
+
+Ultrasonic ultrasonicInit(unsigned char portEcho, unsigned char portPing) {
+	sensorPorts[portEcho] = portEcho;
+	return &sensorPorts[portEcho];
+}
+
+int ultrasonicGet(Ultrasonic ult) {
+	//The left sensor is half the spacing to the robot's left of center
+	double side = (*(unsigned char *)ult == RANGE_LEFT_ECHO ? 0.5 : -0.5) * RANGE_SPACING / 100.0;
+	double sensorX = drive.x - side * sin(drive.heading);
+	double sensorY = drive.y + side * cos(drive.heading);
+	double normalX = cos(wall.facing);
+	double normalY = sin(wall.facing);
+	double squareness = cos(drive.heading) * normalX + sin(drive.heading) * normalY;
+	double distance;
+
+	if(!wall.present || fault == SIM_FAULT_RANGE || squareness < cos(RANGE_CONE)) {
+		return 0;
+	}
+	distance = ((wall.x * METERS_PER_INCH - sensorX) * normalX +
+		(wall.y * METERS_PER_INCH - sensorY) * normalY) / squareness;
+	return distance > 0 ? (int)lround(distance * 100) : 0;
+}
+
+Mutex mutexCreate() {
+	return &now;
+}
+
+bool mutexTake(Mutex mutex, const unsigned long blockTime) {
+	return true;
+}
+
+bool mutexGive(Mutex mutex) {
+	return true;
+}
+
+Semaphore semaphoreCreate() {
+	return &now;
+}
+
+bool semaphoreTake(Semaphore semaphore, const unsigned long blockTime) {
+	return true;
+}
+
+bool semaphoreGive(Semaphore semaphore) {
+	return true;
+}
+
+void lcdSetText(FILE *lcdPort, unsigned char line, const char *buffer) {
+}
+
+void lcdPrint(FILE *lcdPort, unsigned char line, const char *formatString, ...) {
+}
+
+unsigned int lcdReadButtons(FILE *lcdPort) {
+	return 0;
+}
+
+void displayStatus(const char *text) {
+}
+
+void telemetrySet(unsigned int channel, int value) {
+}
+
+//The arena is only used during initialize() on the robot; the host takes the memory from libc
+void *arenaAlloc(unsigned int bytes) {
+	return calloc(1, bytes);
+}
+
+void arenaTrack(const char *name, unsigned int capacity, const volatile unsigned int *peak) {
+}
+
+/**
+ * groupCommand()
+ * @return the command a motor group was sent, the average of its ports
+ */
+static int groupCommand(const MotorGroup *group) {
+	int total = 0;
+	int i;
+
+	for(i = 0; i < group->count; i++) {
+		total += group->direction[i] * ports[calibration->ports[group->ports[i] - 1] - 1];
+	}
+	return total / group->count;
+}
+
+/**
+ * step()
+ * Runs the robot and the models for one millisecond.
+ */
+static void step() {
+	SensorSnapshot sensors;
+	int left, right, lift, claw;
+	double current;
+
+	now++;
+	//The sensing task, then the control task, as tasks.c runs them
+	if(now % SENSORS_PERIOD == 0) {
+		sensorsUpdate();
+		sensorsGet(&sensors);
+		powerMonitorUpdate(sensors.battery, SENSORS_PERIOD);
+	}
+	if(now % CONTROL_PERIOD == 0) {
+		modeUpdate();
+		odometryUpdate();
+		pathFollowUpdate();
+		liftControlUpdate();
+		commandUpdate();
+		motorFrameCommit();
+	}
+	if(now == deadline) {
+		cutOff = modeRoutineRunning();
+		modeRoutineCancel();
+	}
+
+	left = groupCommand(&driveLeftMotors);
+	right = groupCommand(&driveRightMotors);
+	lift = groupCommand(&liftMotors);
+	claw = groupCommand(&clawMotors);
+	plantDriveStep(&drive, plantVolts(left, batteryVolts), plantVolts(right, batteryVolts),
+		PLANT_STEP);
+	plantJointStep(&liftJoint, plantVolts(lift, batteryVolts), PLANT_STEP);
+	plantJointStep(&clawJoint, plantVolts(claw, batteryVolts), PLANT_STEP);
+
+	current = drive.current * (abs(left) + abs(right)) / 254.0 +
+		liftJoint.current * abs(lift) / 127.0 + clawJoint.current * abs(claw) / 127.0;
+	batteryVolts = plantBatteryVolts(&battery, current);
+	peakCurrent = fmax(peakCurrent, current);
+	lowBattery = fmin(lowBattery, batteryVolts);
+}
+
+void delay(const unsigned long time) {
+	unsigned long i;
+
+	for(i = 0; i < time; i++) {
+		step();
+	}
+}
+
+void simStart(double volts, SimFault injected, const SimWall *seen) {
+	Pose start = {0, 0, 0};
+
+	battery = plantBattery;
+	battery.openVolts = volts;
+	batteryVolts = lowBattery = volts;
+	fault = injected;
+	wall = *seen;
+	plantDriveInit(&drive, &plantDriveSpec, 0, 0, 0);
+	plantJointInit(&liftJoint, &plantLiftSpec, 0);
+	plantJointInit(&clawJoint, &plantClawSpec, 0);
+
+	//initialize(), less what the host does not have
+	sensorsInit();
+	odometryInit();
+	liftControlInit();
+	commandInit();
+	modeInit();
+	odometryReset(&start);
+	delay(CONTROL_PERIOD);
+}
+
+void simRun(double limit, SimResult *result) {
+	Pose pose;
+	unsigned long start;
+
+	//Started the way autonomous() starts it, so the mode manager can cut it off, and run the way
+	//the routine task runs it, cleanup included
+	modeRoutineStart();
+	delay(CONTROL_PERIOD);
+	start = now;
+	deadline = start + (unsigned long)(limit * 1000);
+	modeRoutineRun();
+	result->time = (now - start) / 1000.0;
+	result->cutOff = cutOff || now >= deadline;
+
+	//Let the robot come to rest
+	delay(SETTLE_TIME);
+
+	odometryGet(&pose);
+	result->x = drive.x / METERS_PER_INCH;
+	result->y = drive.y / METERS_PER_INCH;
+	result->heading = remainder(drive.heading, 2 * M_PI);
+	result->odometryError = hypot(pose.x / (double)FIXED_ONE - result->x,
+		pose.y / (double)FIXED_ONE - result->y);
+	result->peakCurrent = peakCurrent;
+	result->lowBattery = lowBattery;
+	result->brownouts = powerBrownouts();
+}
+
+void simJoystick(unsigned char joystick, const SimJoystick *state) {
+	joysticks[joystick - 1] = *state;
+}
+
+void simDriverControl() {
+	driverControl = true;
+}
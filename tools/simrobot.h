@@ -0,0 +1,120 @@
+/** @file simrobot.h
+ * @brief The robot code on the host, driving the plant models
+ *
+ * Host tools link the robot's own sources with tools/simrobot.c, which stands in for the PROS
+ * kernel and wires the motor ports and sensors to the drive, lift and claw models of
+ * tools/plant.c. Everything runs on one thread. delay() is the clock: each simulated
+ * millisecond steps the models, runs the sensing task's work every SENSORS_PERIOD and the
+ * control task's every CONTROL_PERIOD, in the same order as tasks.c. So an autonomous routine
+ * runs unchanged, and runs the same way every time.
+ *
+ * Robot code keeps its state in statics, so a tool runs one simulation per process.
+ */
+
+#ifndef SIMROBOT_H_
+#define SIMROBOT_H_
+
+#include <stdbool.h>
+
+/**
+ * Sensor faults a simulation can inject from the start
+ */
+typedef enum {
+	SIM_FAULT_NONE,
+	//The left drive encoder is unplugged and reads zero
+	SIM_FAULT_LEFT_ENCODER,
+	//The lift encoder is unplugged and reads zero
+	SIM_FAULT_LIFT_ENCODER,
+	//The gyro has picked up a bias of SIM_GYRO_DRIFT counts
+	SIM_FAULT_GYRO_DRIFT,
+	//Both ultrasonics get no echo
+	SIM_FAULT_RANGE,
+	SIM_FAULTS
+} SimFault;
+
+/**
+ * Gyro bias in analogReadCalibratedHR() counts for SIM_FAULT_GYRO_DRIFT, about 3 degrees per
+ * second
+ */
+#define SIM_GYRO_DRIFT 45
+
+/**
+ * A wall for the ultrasonics to see: a point on it in inches and the heading in radians the
+ * robot faces when square to it
+ */
+typedef struct {
+	bool present;
+	double x;
+	double y;
+	double facing;
+} SimWall;
+
+/**
+ * Sticks and buttons of a joystick, as operator control samples them
+ */
+typedef struct {
+	bool connected;
+	//Axes 1-4
+	int analog[4];
+	//Button groups 5-8 as JOY_* bitmasks
+	unsigned char buttons[4];
+} SimJoystick;
+
+/**
+ * What a routine did
+ */
+typedef struct {
+	//Seconds from the start until the routine returned
+	double time;
+	//True if the autonomous period ended before the routine did
+	bool cutOff;
+	//True pose once the robot has come to rest, in inches and radians
+	double x;
+	double y;
+	double heading;
+	//Inches between the odometry's pose and the true one
+	double odometryError;
+	//Peak battery current in A and the lowest battery voltage
+	double peakCurrent;
+	double lowBattery;
+	//Times brownout shedding started (power.h)
+	unsigned int brownouts;
+} SimResult;
+
+/**
+ * simStart()
+ * Sets up the models and runs the robot's initialize() steps, with the robot at the origin.
+ *
+ * @param volts the battery's open circuit voltage
+ * @param fault the sensor fault to inject
+ * @param wall what is in front of the ultrasonics
+ */
+void simStart(double volts, SimFault fault, const SimWall *wall);
+
+/**
+ * simRun()
+ * Runs the routine picked with autonomousSelect() as the routine task would, stopping it
+ * through the mode manager if it runs past the autonomous period, then lets the robot come to
+ * rest.
+ *
+ * @param limit the autonomous period in seconds
+ * @param result filled with what the routine did
+ */
+void simRun(double limit, SimResult *result);
+
+/**
+ * simJoystick()
+ * Sets what a joystick reads from now on. Both start disconnected.
+ *
+ * @param joystick 1 or 2
+ * @param state the sticks and buttons
+ */
+void simJoystick(unsigned char joystick, const SimJoystick *state);
+
+/**
+ * simDriverControl()
+ * Switches the field from autonomous to driver control.
+ */
+void simDriverControl();
+
+#endif
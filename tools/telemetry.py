@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Receiver for the binary telemetry stream on UART 2 (include/telemetry.h).
+
+Connect a USB serial adapter to UART 2 on the Cortex and run
+
+    python3 tools/telemetry.py /dev/ttyUSB0 > run.csv
+
+to write every sample as a CSV row, or add --plot for a live plot (needs matplotlib). Frames
+that fail the CRC and samples dropped on the robot are counted on stderr. Encoder counts are
+sent as 16 bits and unwrapped here.
+
+    python3 tools/telemetry.py --loopback
+
+checks the decoder without a robot: it sends frames encoded the way the robot does through a
+pseudo-terminal, including a corrupted frame and a dropped sample, and reads them back.
+"""
+
+import os
+import select
+import struct
+import sys
+import termios
+import tty
+
+BAUD = termios.B115200			# matches TELEMETRY_BAUD
+SAMPLE = 1						# TELEMETRY_SAMPLE
+CHANNELS = ["leftTicks", "rightTicks", "liftTicks", "liftTarget", "liftOutput",
+	"driveLeft", "driveRight", "battery", "liftTwist", "batteryPredicted", "shedLevel"]
+UNWRAP = {"leftTicks", "rightTicks", "liftTicks"}
+FRAME = struct.Struct("<BBI%dh" % len(CHANNELS))
+PLOT_SAMPLES = 500				# samples shown in the live plot
+
+
+def crc16(data):
+	"""CRC-16/CCITT, polynomial 0x1021 starting at 0xFFFF."""
+	crc = 0xFFFF
+	for byte in data:
+		crc ^= byte << 8
+		for _ in range(8):
+			crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+			crc &= 0xFFFF
+	return crc
+
+
+def cobs_encode(data):
+	out = bytearray([0])
+	code = 0
+	for byte in data:
+		if byte != 0:
+			out.append(byte)
+		if byte == 0 or len(out) - code == 255:
+			out[code] = len(out) - code
+			code = len(out)
+			out.append(0)
+	out[code] = len(out) - code
+	out.append(0)
+	return bytes(out)
+
+
+def cobs_decode(data):
+	"""Decodes one frame without its delimiter, or returns None if it is malformed."""
+	out = bytearray()
+	i = 0
+	while i < len(data):
+		code = data[i]
+		if code == 0 or i + code > len(data):
+			return None
+		out += data[i + 1:i + code]
+		i += code
+		if code < 255 and i < len(data):
+			out.append(0)
+	return bytes(out)
+
+
+def encode_sample(sequence, time, values):
+	"""Builds a frame the way src/telemetry.c does."""
+	body = FRAME.pack(SAMPLE, sequence & 0xFF, time, *values)
+	return cobs_encode(body + struct.pack("<H", crc16(body)))
+
+
+class Decoder:
+	"""Turns a byte stream into samples, tracking CRC errors, drops and counter wraps."""
+
+	def __init__(self):
+		self.buffer = bytearray()
+		self.errors = 0
+		self.dropped = 0
+		self.sequence = None
+		self.last = {}
+		self.offset = {name: 0 for name in UNWRAP}
+
+	def feed(self, data):
+		self.buffer += data
+		while 0 in self.buffer:
+			end = self.buffer.index(0)
+			sample = self.frame(bytes(self.buffer[:end]))
+			del self.buffer[:end + 1]
+			if sample is not None:
+				yield sample
+
+	def frame(self, encoded):
+		data = cobs_decode(encoded)
+		if data is None or len(data) != FRAME.size + 2:
+			self.errors += 1
+			return None
+		body, crc = data[:-2], struct.unpack("<H", data[-2:])[0]
+		if crc16(body) != crc:
+			self.errors += 1
+			return None
+		fields = FRAME.unpack(body)
+		if fields[0] != SAMPLE:
+			return None
+		sequence, time, values = fields[1], fields[2], list(fields[3:])
+		if self.sequence is not None:
+			self.dropped += (sequence - self.sequence - 1) & 0xFF
+		self.sequence = sequence
+
+		sample = {"time": time}
+		for name, value in zip(CHANNELS, values):
+			if name in UNWRAP:
+				if name in self.last:
+					step = value - self.last[name]
+					if step > 32767:
+						self.offset[name] -= 65536
+					elif step < -32768:
+						self.offset[name] += 65536
+				self.last[name] = value
+				value += self.offset[name]
+			sample[name] = value
+		return sample
+
+
+def open_port(path):
+	fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+	tty.setraw(fd)
+	attrs = termios.tcgetattr(fd)
+	attrs[4] = attrs[5] = BAUD
+	termios.tcsetattr(fd, termios.TCSANOW, attrs)
+	return fd
+
+
+def samples(fd, decoder):
+	while True:
+		data = os.read(fd, 4096)
+		if not data:
+			return
+		yield from decoder.feed(data)
+
+
+def write_csv(fd, decoder):
+	print(",".join(["time"] + CHANNELS))
+	try:
+		for sample in samples(fd, decoder):
+			print(",".join(str(sample[name]) for name in ["time"] + CHANNELS), flush=True)
+	except KeyboardInterrupt:
+		pass
+	sys.stderr.write("crc errors %d, dropped %d\n" % (decoder.errors, decoder.dropped))
+
+
+def plot(fd, decoder):
+	import matplotlib.pyplot as plt
+
+	history = {name: [] for name in ["time"] + CHANNELS}
+	figure, axes = plt.subplots(3, 1, sharex=True)
+	groups = [CHANNELS[0:2], CHANNELS[2:5], CHANNELS[5:8]]
+	plt.ion()
+	for sample in samples(fd, decoder):
+		for name in history:
+			history[name] = (history[name] + [sample[name]])[-PLOT_SAMPLES:]
+		if sample["time"] % 100 >= 10:
+			continue
+		for ax, names in zip(axes, groups):
+			ax.clear()
+			for name in names:
+				ax.plot(history["time"], history[name], label=name)
+			ax.legend(loc="upper left")
+		figure.canvas.draw_idle()
+		plt.pause(0.001)
+
+
+def loopback():
+	"""Sends known frames through a pseudo-terminal and checks they decode."""
+	master, slave = os.openpty()
+	tty.setraw(slave)
+	sent = []
+	stream = bytearray()
+	for n in range(40):
+		values = [32700 + 10 * n - (65536 if 32700 + 10 * n > 32767 else 0), -n, n * 3, 100, 0,
+			-127, 127, 7600, 0, 7500, 0]
+		sample = encode_sample(n, 1000 + 10 * n, values)
+		if n == 5:
+			continue					# dropped on the robot
+		if n == 9:
+			sample = sample[:4] + bytes([sample[4] ^ 0x40]) + sample[5:]
+		else:
+			sent.append((1000 + 10 * n, 32700 + 10 * n, n * 3))
+		stream += sample
+	os.write(master, bytes(stream))
+
+	decoder = Decoder()
+	got = []
+	while select.select([slave], [], [], 0.5)[0]:
+		for sample in decoder.feed(os.read(slave, 4096)):
+			got.append((sample["time"], sample["leftTicks"], sample["liftTicks"]))
+	os.close(master)
+	os.close(slave)
+	ok = got == sent and decoder.errors == 1 and decoder.dropped == 2
+	print("loopback %s: %d samples, %d crc errors, %d dropped" % ("pass" if ok else "FAIL",
+		len(got), decoder.errors, decoder.dropped))
+	return ok
+
+
+def main():
+	args = sys.argv[1:]
+	if args == ["--loopback"]:
+		sys.exit(0 if loopback() else 1)
+	if len(args) not in (1, 2) or (len(args) == 2 and args[1] != "--plot"):
+		sys.exit("usage: telemetry.py <port> [--plot] | --loopback")
+	fd = open_port(args[0])
+	if len(args) == 2:
+		plot(fd, Decoder())
+	else:
+		write_csv(fd, Decoder())
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,151 @@
+/** @file tractionsim.c
+ * @brief Drive traction and tipping scenarios for the traction controller
+ *
+ * Built and run on the development machine with "make tractionsim". It runs the robot's
+ * src/traction.c, unchanged, at the 20 ms driver loop rate against a model of one side of the
+ * drive, and compares it with sending the stick straight to the motors:
+ *
+ *  - the 393 motors push with a force falling linearly from stall to free speed;
+ *  - the wheels grip up to static friction, then slide on kinetic friction until wheel and
+ *    floor speeds meet again;
+ *  - the encoder counts wheel travel, so slip shows up as odometry error;
+ *  - the robot tips when its acceleration times the height of its center of gravity, which
+ *    rises with the lift, exceeds gravity times half the wheelbase.
+ *
+ * Each scenario reports the time to 90% of free speed (or to a stop), the time spent slipping,
+ * the tip events and the odometry error. The model constants are rough figures for this robot;
+ * change them here if the robot changes.
+ */
+
+#include "main.h"
+#include <math.h>
+
+//Simulation step in seconds and driver loop period in milliseconds
+#define STEP 0.0005
+#define LOOP_MS 20
+#define SCENARIO_MS 2500
+
+//One side: half the robot's mass and two 393 motors on 4" wheels
+#define MASS 3.4
+#define WHEEL_MASS 0.3
+#define STALL_FORCE 65.7
+#define FREE_SPEED 0.532
+#define STATIC_FRICTION 0.9
+#define KINETIC_FRICTION 0.7
+#define GRAVITY 9.81
+//Meters per encoder tick (ODOMETRY_INCHES_PER_TICK) and ticks per loop at free speed
+#define TICK 0.000886
+#define FREE_TICKS 12
+//Center of gravity height with the lift down and its rise at TRACTION_LIFT_TOP, half wheelbase
+#define CG_LOW 0.12
+#define CG_RISE 0.38
+#define HALF_BASE 0.16
+
+typedef struct {
+	const char *name;
+	int liftTicks;
+	//Starting speed as a command, and the stick command held through the run
+	int start;
+	int target;
+} Scenario;
+
+static const Scenario scenarios[] = {
+	{"launch, lift down", 0, 0, 127},
+	{"launch, lift up", TRACTION_LIFT_TOP, 0, 127},
+	{"stop, lift down", 0, 127, 0},
+	{"stop, lift up", TRACTION_LIFT_TOP, 127, 0},
+	{"reverse, lift down", 0, 127, -127},
+	{"reverse, lift up", TRACTION_LIFT_TOP, 127, -127}
+};
+
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static void run(const Scenario *scenario, bool traction) {
+	Traction side;
+	double robot = FREE_SPEED * scenario->start / 127;
+	double wheel = robot;
+	double robotDistance = 0;
+	double wheelDistance = 0;
+	double height = CG_LOW + CG_RISE * scenario->liftTicks / TRACTION_LIFT_TOP;
+	double tipAccel = GRAVITY * HALF_BASE / height;
+	double goal = FREE_SPEED * 0.9 * (scenario->target > 0 ? 1 : -1);
+	double slipTime = 0;
+	double force = 0;
+	double accel;
+	//As if the robot had been moving at its starting speed for the last loop
+	long lastTicks = -scenario->start * FREE_TICKS / 127;
+	long ticks;
+	int command = scenario->start;
+	int tips = 0;
+	int reached = -1;
+	bool tipping = false;
+	bool slipping = false;
+	int step;
+
+	tractionReset(&side, scenario->start);
+	for(step = 0; step * STEP * 1000 < SCENARIO_MS; step++) {
+		double time = step * STEP;
+
+		if(step % (int)(LOOP_MS / 1000.0 / STEP + 0.5) == 0) {
+			ticks = (long)floor(wheelDistance / TICK);
+			if(traction) {
+				command = tractionStep(&side, scenario->target,
+					(int)((ticks - lastTicks) * 127 / FREE_TICKS), scenario->liftTicks, LOOP_MS);
+			} else {
+				command = scenario->target;
+			}
+			lastTicks = ticks;
+		}
+
+		force = STALL_FORCE * (command / 127.0 - wheel / FREE_SPEED);
+		if(!slipping && fabs(force) > STATIC_FRICTION * MASS * GRAVITY) {
+			slipping = true;
+		}
+		if(slipping) {
+			//Friction pulls the robot along with the wheels, or with the motors as slip starts
+			double grip = KINETIC_FRICTION * MASS * GRAVITY *
+				((wheel != robot ? wheel - robot : force) > 0 ? 1 : -1);
+
+			accel = grip / MASS;
+			wheel += (force - grip) / WHEEL_MASS * STEP;
+			robot += accel * STEP;
+			slipTime += STEP;
+			//Wheel and floor speeds met
+			if((wheel - robot) * grip <= 0) {
+				wheel = robot;
+				slipping = false;
+			}
+		} else {
+			accel = force / (MASS + WHEEL_MASS);
+			robot += accel * STEP;
+			wheel = robot;
+		}
+		robotDistance += robot * STEP;
+		wheelDistance += wheel * STEP;
+
+		if(fabs(accel) > tipAccel && !tipping) {
+			tips++;
+		}
+		tipping = fabs(accel) > tipAccel;
+
+		if(reached < 0 && (scenario->target == 0 ? fabs(robot) < FREE_SPEED * 0.02 :
+				robot * goal >= goal * goal)) {
+			reached = (int)(time * 1000);
+		}
+	}
+
+	printf("%-20s %-9s %8d %8d %5d %9.1f\n", scenario->name, traction ? "traction" : "raw",
+		reached, (int)(slipTime * 1000), tips, fabs(wheelDistance - robotDistance) * 1000);
+}
+
+int main() {
+	unsigned int i;
+
+	printf("%-20s %-9s %8s %8s %5s %9s\n", "scenario", "control", "time ms", "slip ms", "tips",
+		"odo mm");
+	for(i = 0; i < SCENARIO_COUNT; i++) {
+		run(&scenarios[i], false);
+		run(&scenarios[i], true);
+	}
+	return 0;
+}
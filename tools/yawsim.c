@@ -0,0 +1,195 @@
+/** @file yawsim.c
+ * @brief Heading accuracy of the gyro service against a noisy, drifting gyro
+ *
+ * Built and run on the development machine with "make yawsim". It runs the robot's src/yaw.c,
+ * unchanged, at the sensing rate against a synthetic gyro: the true yaw rate through the
+ * calibrated scale, plus a bias that drifts as the gyro warms up, white noise and rounding to
+ * whole counts. initialize() measures the bias first, with the same noise.
+ *
+ * Each scenario lasts a match and compares the heading with the truth, once with the bias
+ * tracking of yaw.c and once integrating the readings less the bias measured at startup, which
+ * is what the service would do without it:
+ *
+ *  - still: the robot never moves;
+ *  - turns: quarter turns at 90 degrees per second either way, with a second's stop between;
+ *  - driving: drives with gentle turns, stopping for a second every ten to pick up or score.
+ *
+ * A scenario fails, and the tool exits with status 1, if the heading with tracking ends up
+ * further from the truth than its limit. The noise and drift figures are rough ones for the VEX
+ * gyro; change them here if a better measurement comes along.
+ */
+
+#include "main.h"
+#include <math.h>
+#include <stdlib.h>
+
+//Length of each scenario in milliseconds, the autonomous and driver periods
+#define MATCH_TIME 120000
+//Standard deviation of the noise and bias at startup, in analogReadCalibratedHR() counts
+#define NOISE 4.0
+#define START_BIAS 20.0
+//Bias drift as the gyro warms up, in counts, and its time constant in milliseconds; 5 counts
+//is about a third of a degree per second
+#define WARMUP_DRIFT 5.0
+#define WARMUP_TIME 60000.0
+//Samples analogCalibrate() averages
+#define CALIBRATE_SAMPLES 1024
+//Turn rate of the turns scenario in degrees per second
+#define TURN_RATE 90.0
+
+typedef enum {
+	SCENARIO_STILL,
+	SCENARIO_TURNS,
+	SCENARIO_DRIVING,
+	SCENARIOS
+} Scenario;
+
+typedef struct {
+	const char *name;
+	//Largest heading error allowed at the end, in degrees
+	double limit;
+} ScenarioSpec;
+
+static const ScenarioSpec scenarios[SCENARIOS] = {
+	{"still", 1.0},
+	{"turns", 3.0},
+	{"driving", 10.0},
+};
+
+//The synthetic gyro, in counts
+static double trueRate;
+static double bias;
+static double calibrated;
+//The sample yawUpdate() reads next
+static int sample;
+
+/**
+ * noise()
+ * @return a normally distributed sample with a standard deviation of one
+ */
+static double noise() {
+	double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+	double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/**
+ * reading()
+ * @return what the gyro reads now, before analogCalibrate() takes its average off
+ */
+static double reading() {
+	return trueRate + bias + NOISE * noise();
+}
+
+//PROS stand-ins for what src/yaw.c and the calibration defaults in src/calibration.c use
+
+unsigned long millis() {
+	return 0;
+}
+
+unsigned int lcdReadButtons(FILE *lcdPort) {
+	return 0;
+}
+
+void lcdSetText(FILE *lcdPort, unsigned char line, const char *buffer) {
+}
+
+void lcdPrint(FILE *lcdPort, unsigned char line, const char *formatString, ...) {
+}
+
+void displayStatus(const char *text) {
+}
+
+int analogCalibrate(unsigned char channel) {
+	double total = 0;
+	int i;
+
+	for(i = 0; i < CALIBRATE_SAMPLES; i++) {
+		total += reading();
+	}
+	calibrated = total / CALIBRATE_SAMPLES;
+	return (int)lround(calibrated / 16);
+}
+
+int analogReadCalibratedHR(unsigned char channel) {
+	return sample;
+}
+
+/**
+ * rateAt()
+ * @return the true yaw rate in degrees per second at a time in the scenario, and whether the
+ * drive is moving
+ */
+static double rateAt(Scenario scenario, unsigned long time, bool *moving) {
+	//Quarter turn, one second stop, alternating direction
+	unsigned long turnTime = (unsigned long)(90.0 / TURN_RATE * 1000);
+	unsigned long phase;
+
+	switch(scenario) {
+	case SCENARIO_TURNS:
+		phase = time % (2 * (turnTime + 1000));
+		*moving = phase % (turnTime + 1000) < turnTime;
+		if(!*moving) {
+			return 0;
+		}
+		return phase < turnTime + 1000 ? TURN_RATE : -TURN_RATE;
+	case SCENARIO_DRIVING:
+		//A second's stop every ten seconds, to pick up or score
+		*moving = time % 10000 >= 1000;
+		return *moving ? 25.0 * sin(2 * M_PI * time / 7000.0) : 0;
+	default:
+		*moving = false;
+		return 0;
+	}
+}
+
+/**
+ * run()
+ * Runs a scenario and returns the heading errors at the end in degrees, with and without the
+ * bias tracking.
+ */
+static void run(Scenario scenario, double *tracked, double *untracked) {
+	double scale = calibration->gyroScale / (double)FIXED_ONE;
+	double truth = 0;
+	double plain = 0;
+	double startBias = START_BIAS * noise();
+	double rate;
+	bool moving;
+	unsigned long time;
+
+	bias = startBias;
+	trueRate = 0;
+	yawInit();
+	yawReset(0);
+	for(time = SENSORS_PERIOD; time <= MATCH_TIME; time += SENSORS_PERIOD) {
+		rate = rateAt(scenario, time, &moving);
+		bias = startBias + WARMUP_DRIFT * (1 - exp(-(double)time / WARMUP_TIME));
+		trueRate = rate * scale;
+		truth += rate * SENSORS_PERIOD / 1000.0;
+		sample = (int)lround(reading() - calibrated);
+		//What the service would integrate with only the bias measured at startup
+		plain += sample / scale * SENSORS_PERIOD / 1000.0;
+		yawUpdate(SENSORS_PERIOD, !moving);
+	}
+	*tracked = yawHeading() / (double)FIXED_ONE * 180 / M_PI - truth;
+	*untracked = plain - truth;
+}
+
+int main() {
+	double tracked, untracked;
+	unsigned int failures = 0;
+	int scenario;
+
+	srand(1);
+	printf("%d s each, %.0f count noise, %.0f count warm-up drift, sampled every %d ms\n",
+		MATCH_TIME / 1000, NOISE, WARMUP_DRIFT, SENSORS_PERIOD);
+	printf("scenario  tracked deg  untracked deg  limit deg\n");
+	for(scenario = 0; scenario < SCENARIOS; scenario++) {
+		run(scenario, &tracked, &untracked);
+		failures += fabs(tracked) > scenarios[scenario].limit;
+		printf("%-8s %12.2f %14.2f %10.1f%s\n", scenarios[scenario].name, tracked, untracked,
+			scenarios[scenario].limit, fabs(tracked) > scenarios[scenario].limit ? " FAIL" : "");
+	}
+	return failures > 0 ? 1 : 0;
+}